@@ -0,0 +1,171 @@
+#include <cmath>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/abort.h"
+#include "ns3/command-line.h"
+#include "ns3/qkdcns-module.h"
+#include "ns3/adi-helper.h"
+#include "ns3/access-manager.h"
+#include "ns3/access-scheduler.h"
+#include "ns3/stage-timer.h"
+#include "ns3/fso-channel-list.h"
+#include "ns3/data-rate.h"
+#include "ns3/internet-module.h"
+#include "ns3/coordinate-geodetic.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("QkdcnsS2gBenchmark");
+
+/*
+ * Benchmark of the satellite-to-ground scheduling pipeline.
+ *
+ * A Walker delta constellation of nPlanes x nSats satellites and nStations
+ * stations spread evenly over the latitudes [-60, 60] are simulated for the
+ * given days. The wall time of each stage (link calculation, DoFindLinkData,
+ * AddAccessData, CalcScheme, Schedule, AssignTurntableTask), the number of
+ * link informations, accesses and TryInsert calls, and the peak resident set
+ * size are written as JSON or CSV, e.g.
+ *
+ *   ./waf --run "qkdcns-s2g-benchmark --nPlanes=6 --nSats=20 --nStations=100 --format=csv"
+ */
+int
+main (int argc, char** argv)
+{
+  uint32_t nPlanes = 3;
+  uint32_t nSats = 40;
+  uint32_t phasing = 1;
+  uint32_t nStations = 40;
+  double altitude = 500.0;
+  double inc = 97.406;
+  double days = 1.0;
+  std::string scheduler = "greedy";
+  std::string format = "json";
+  std::string output = "";
+  bool batchUpdate = false;
+  double keyRate = 1000.0;
+  CommandLine cmd;
+  cmd.AddValue ("nPlanes", "The number of orbital planes", nPlanes);
+  cmd.AddValue ("nSats", "The number of satellites per plane", nSats);
+  cmd.AddValue ("phasing", "The phasing factor of Walker constellation", phasing);
+  cmd.AddValue ("nStations", "The number of stations", nStations);
+  cmd.AddValue ("altitude", "The altitude of satellites, in km", altitude);
+  cmd.AddValue ("inc", "The inclination of orbits, in degree", inc);
+  cmd.AddValue ("days", "The simulated days", days);
+  cmd.AddValue ("scheduler", "The access scheduler: greedy, interval or lookahead", scheduler);
+  cmd.AddValue ("format", "The output format: json or csv", format);
+  cmd.AddValue ("output", "The output file, the standard output if empty", output);
+  cmd.AddValue ("batchUpdate", "Update all fso channels by one ticker", batchUpdate);
+  cmd.AddValue ("keyRate", "The key rate of a link at 1000 km for the lookahead scheduler, in keys per second", keyRate);
+  cmd.Parse (argc, argv);
+  FsoChannelList::SetBatchUpdate (batchUpdate);
+
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now ();
+  EnableS2G = true;
+  EnableISL = false;
+  if (scheduler == "interval")
+  {
+    AccessManager::SetScheduler (CreateObject<IntervalAccessScheduler> ());
+  }
+  else if (scheduler == "lookahead")
+  {
+    // the key rate falls off as 1/d^2, so the rate at 1 km is 1e6 times the one at 1000 km
+    Ptr<LookaheadAccessScheduler> lookahead = CreateObject<LookaheadAccessScheduler> ();
+    lookahead->SetKeyPerValue (keyRate * 1e6);
+    AccessManager::SetScheduler (lookahead);
+  }
+  else
+  {
+    NS_ABORT_MSG_UNLESS (scheduler == "greedy", "unknown scheduler " << scheduler);
+    AccessManager::SetScheduler (CreateObject<GreedyAccessScheduler> ());
+  }
+  NS_ABORT_MSG_UNLESS (format == "json" || format == "csv", "unknown format " << format);
+
+  // Walker delta constellation i:t/p/f
+  std::vector<QkdSatelliteContainer> satContainer (nPlanes);
+  for (uint32_t i = 0;i < nPlanes;++i)
+  {
+    satContainer[i].Create (nSats);
+    double raan = 360.0 * i / nPlanes;
+    for (uint32_t j = 0;j < nSats;++j)
+    {
+      double ma = 360.0 * j / nSats + 360.0 * phasing * i / (nPlanes * nSats);
+      satContainer[i][j]->SetElement (K_RE + altitude, 0.0, inc, raan, 0.0, ma);
+    }
+  }
+  // the stations on a Fibonacci lattice of latitudes [-60, 60]
+  QkdStationContainer staContainer;
+  for (uint32_t k = 0;k < nStations;++k)
+  {
+    double z = std::sin (M_PI / 3.0) * (2.0 * (k + 0.5) / nStations - 1.0);
+    double lat = std::asin (z) * 180.0 / M_PI;
+    double lon = std::fmod (k * 137.50776405, 360.0) - 180.0;
+    std::stringstream name;
+    name << "Station" << k;
+    staContainer.Create (CoordGeodetic (lat, lon, 0.0, true), name.str ());
+  }
+
+  QkdDeviceHelper qkdDeviceHelper;
+  QkdFsoDeviceHelper qkdFsoDeviceHelper;
+  QkdNetDeviceHelper qkdNetDeviceHelper;
+  Ipv4AddressHelper address;
+  QkdNetStackHelper netHelper;
+  netHelper.Initialize ();
+  for (uint32_t i = 0;i < nPlanes;++i)
+  {
+    netHelper.Install (satContainer[i]);
+  }
+  netHelper.Install (staContainer);
+  QkdDeviceContainer qkdDeviceContainerToStations;
+  qkdDeviceHelper.SetDeviceType (Tx);
+  qkdDeviceHelper.SetDeviceFace (adi::Bottom);
+  for (uint32_t i = 0;i < nPlanes;++i)
+  {
+    qkdDeviceContainerToStations.Add (qkdDeviceHelper.Install (satContainer[i]));
+  }
+  QkdDeviceContainer qkdDeviceContainerFromStations;
+  qkdDeviceHelper.SetDeviceType (Rx);
+  qkdDeviceHelper.SetDeviceFace (adi::Top);
+  qkdDeviceContainerFromStations.Add (qkdDeviceHelper.Install (staContainer));
+  qkdFsoDeviceHelper.Install (qkdDeviceContainerToStations);
+  qkdFsoDeviceHelper.Install (qkdDeviceContainerFromStations);
+  NetDeviceContainer netDeviceContainerToStations = qkdNetDeviceHelper.Install (qkdDeviceContainerToStations);
+  NetDeviceContainer netDeviceContainerFromStations = qkdNetDeviceHelper.Install (qkdDeviceContainerFromStations);
+  address.SetBase ("10.2.0.0", "255.255.0.0");
+  address.Assign (netDeviceContainerToStations);
+  address.SetBase ("10.3.0.0", "255.255.0.0");
+  address.Assign (netDeviceContainerFromStations);
+  AdiHelper::RegisterS2G (qkdDeviceContainerToStations, qkdDeviceContainerFromStations);
+  std::chrono::duration<double> setup = std::chrono::steady_clock::now () - begin;
+  StageTimer::Add ("Setup", setup.count ());
+
+  {
+    StageTimer::Scope scope ("Run");
+    AdiHelper::Update ();
+    Simulator::Stop (Days (days));
+    Simulator::Run ();
+  }
+  Simulator::Destroy ();
+  StageTimer::Count ("satellites", nPlanes * nSats);
+  StageTimer::Count ("stations", nStations);
+
+  std::ofstream file;
+  if (!output.empty ())
+  {
+    file.open (output.c_str ());
+    NS_ABORT_MSG_UNLESS (file.is_open (), "cannot open " << output);
+  }
+  std::ostream& os = output.empty () ? std::cout : file;
+  if (format == "json")
+  {
+    StageTimer::WriteJson (os);
+  }
+  else
+  {
+    StageTimer::WriteCsv (os);
+  }
+  return 0;
+}
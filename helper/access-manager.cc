@@ -19,6 +19,11 @@
  */
 
 #include <queue>
+#include <mutex>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include <type_traits>
 #include "ns3/qkd-satellite.h"
 #include "ns3/qkd-satellite-list.h"
 #include "ns3/qkd-station.h"
@@ -26,14 +31,134 @@
 #include "ns3/turntable.h"
 #include "ns3/util.h"
 #include "access-manager.h"
+#include "access-scheduler.h"
+#include "stage-timer.h"
 #include "adi-constant.h"
+#include "adi-cpu.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("AccessManager");
 
+namespace {
+
+/**
+ * \brief Order the limiters, the turntables of a type share the same one
+ */
+struct BoxLess
+{
+  bool operator() (const Box& a, const Box& b) const
+  {
+    return std::tie (a.xMin, a.xMax, a.yMin, a.yMax, a.zMin, a.zMax)
+         < std::tie (b.xMin, b.xMax, b.yMin, b.yMax, b.zMin, b.zMax);
+  }
+};
+
+/**
+ * \brief The tracking state of one turntable along an access
+ */
+class AccessTracker
+{
+public:
+  /**
+   * \brief Constructor, the turntable tracks the target at first
+   * \param[in] pointing   the pointing of turntable in link data
+   * \param[in] mask       the state bit of link data that the turntable can see the target
+   * \param[in] azLimiter  the azimuth limiter
+   * \param[in] ptLimiter  the pitch limiter
+   */
+  AccessTracker (adi::Pointing adi::LinkData::*pointing, uint8_t mask, const BangBangLimiter& azLimiter, const BangBangLimiter& ptLimiter)
+  : m_pointing  (pointing)
+  , m_mask      (mask)
+  , m_azLimiter (azLimiter)
+  , m_ptLimiter (ptLimiter)
+  , m_tracking  (true)
+  {
+  }
+
+  /**
+   * \param[in] data the link data
+   * \return true if the target is visible and its angular rates are in limiter
+   */
+  bool IsInLimiter (const adi::LinkData& data) const
+  {
+    const adi::Pointing& p = data.*m_pointing;
+    const Box& azBound = m_azLimiter.GetBound ();
+    const Box& ptBound = m_ptLimiter.GetBound ();
+    double tmp1 = (p.rate.azimuth - azBound.yMax) * (p.rate.azimuth - azBound.yMin);
+    double tmp2 = (p.rate.pitch - ptBound.yMax) * (p.rate.pitch - ptBound.yMin);
+    return tmp1 <= 0 && tmp2 <= 0 && (data.state & m_mask);
+  }
+
+  /**
+   * \brief Lose the target, the turntable starts to swing from the former link data
+   * \param[in] former  the former link data
+   * \param[in] current the current link data
+   */
+  void Lose (const adi::LinkData& former, const adi::LinkData& current)
+  {
+    if (!m_tracking)
+    {
+      return;
+    }
+    const adi::Pointing& p = former.*m_pointing;
+    m_tracking = false;
+    m_lostTime = ToTime (current.time);
+    m_azInitState = BangBangController::State (ToTime (former.time), p.angle.azimuth, p.rate.azimuth);
+    m_ptInitState = BangBangController::State (ToTime (former.time), p.angle.pitch, p.rate.pitch);
+  }
+
+  /**
+   * \brief Relink the target if the turntable has swung to it
+   * \param[in] current the current link data
+   */
+  void Relink (const adi::LinkData& current)
+  {
+    if (m_tracking)
+    {
+      return;
+    }
+    const adi::Pointing& p = current.*m_pointing;
+    double elapsed = (ToTime (current.time) - m_lostTime).GetSeconds ();
+    if (m_azLimiter.CanSwing (m_azInitState.x, m_azInitState.v, p.angle.azimuth, p.rate.azimuth, elapsed)
+        && m_ptLimiter.CanSwing (m_ptInitState.x, m_ptInitState.v, p.angle.pitch, p.rate.pitch, elapsed))
+    {
+      m_tracking = true;
+    }
+  }
+
+  /**
+   * \return true if the turntable is tracking the target
+   */
+  bool IsTracking (void) const
+  {
+    return m_tracking;
+  }
+private:
+  adi::Pointing adi::LinkData::*m_pointing;   //!< the pointing of turntable in link data
+  uint8_t                   m_mask;           //!< the visible state bit
+  BangBangLimiter           m_azLimiter;      //!< the azimuth limiter
+  BangBangLimiter           m_ptLimiter;      //!< the pitch limiter
+  bool                      m_tracking;       //!< whether tracking the target
+  Time                      m_lostTime;       //!< the time of losing target
+  BangBangController::State m_azInitState;    //!< the azimuth state when losing target
+  BangBangController::State m_ptInitState;    //!< the pitch state when losing target
+};
+
+/** The number of calls of TryInsert since the last selection */
+uint64_t g_nTryInserts = 0;
+
+} // namespace
+
+static_assert (std::is_trivially_copyable<AccessManager::AccessData>::value,
+               "the accesses are sorted in place");
+
 AccessManager::AccessList AccessManager::m_accesses = AccessList ();
+const adi::LinkInfoList* AccessManager::m_datas = 0;
+std::vector<AccessManager::TurntableRecord> AccessManager::m_turntables = std::vector<TurntableRecord> ();
+std::map<const Turntable*, uint32_t> AccessManager::m_turntableIds = std::map<const Turntable*, uint32_t> ();
 AccessManager::TurntableStateList AccessManager::m_turntableStateList = TurntableStateList ();
+Ptr<AccessScheduler> AccessManager::m_scheduler = 0;
 
 bool
 AccessManager::AccessData::operator< (const AccessData& access) const
@@ -47,116 +172,264 @@ AccessManager::TurntableState::operator< (const TurntableState& state) const
   return time < state.time;
 }
 
-AccessManager::TurntableStates::iterator
+bool
 AccessManager::TryInsert (
-  Ptr<Turntable>        turntable,
+  TurntableTimeline&    timeline,
+  uint32_t              turntable,
   const TurntableState& startState,
-  const TurntableState& stopState)
+  const TurntableState& stopState,
+  TurntableTimeline::Tasks::iterator& hint)
 {
-  TurntableStates& turntableStates = m_turntableStateList[turntable];
   Time start = startState.time;
   Time stop = stopState.time;
-  CoordTurntable formerPointing;
-  CoordTurntable latterPointing;
-  NS_ASSERT (start >= turntableStates.front ().time);
-  NS_ASSERT (stop >= turntableStates.front ().time);
-  Time formerStop;
-  Time latterStart;
-  // if start time is greater than the last state time of turntable
-  // then the latter state will not be considered
-  if (start > turntableStates.back ().time)
-  {
-    formerStop = turntableStates.back ().time;
-    formerPointing = turntableStates.back ().pointing;
-    Time timeSwingFromFormer = BangBangController::SwingTime (
-      formerPointing,
-      startState.pointing,
-      turntable->GetAzimuthLimiter (),
-      turntable->GetPitchLimiter ());
-    if (formerStop + timeSwingFromFormer <= start)
-    {
-      return turntableStates.end ();
-    }
+  NS_ASSERT (start >= timeline.initial.time);
+  NS_ASSERT (stop >= timeline.initial.time);
+  // the latter task is the first one starting not before the start time,
+  // the former state is the end of the task before it, or the initial state
+  hint = timeline.tasks.lower_bound (start);
+  const TurntableState& former = hint == timeline.tasks.begin ()
+    ? timeline.initial
+    : std::prev (hint)->second.stop;
+  if (start < former.time)
+  {
+    return false;
   }
-  else
+  const BangBangLimiter& azLimiter = m_turntables[turntable].azLimiter;
+  const BangBangLimiter& ptLimiter = m_turntables[turntable].ptLimiter;
+  if (!BangBangLimiter::CanSwing (former.pointing, startState.pointing, azLimiter, ptLimiter, start - former.time))
   {
-    NS_ASSERT (turntableStates.size () % 2 == 1);
-    for (uint32_t i = 0;i < (turntableStates.size () - 1) / 2;++i)
-    {
-      TurntableStates::iterator former = 2 * i + turntableStates.begin ();
-      TurntableStates::iterator latter = 2 * i + 1 + turntableStates.begin ();
-      formerStop = former->time;
-      formerPointing = former->pointing;
-      latterStart = latter->time;
-      latterPointing = latter->pointing;
-      if (!(start >= formerStop && start <= latterStart && stop >= formerStop && stop <= latterStart))
-      {
-        continue;
-      }
-      Time timeSwingFromFormerState = BangBangController::SwingTime (
-        formerPointing,
-        startState.pointing,
-        turntable->GetAzimuthLimiter (),
-        turntable->GetPitchLimiter ());
-      Time timeSwingToLatterState = BangBangController::SwingTime (
-        stopState.pointing,
-        latterPointing,
-        turntable->GetAzimuthLimiter (),
-        turntable->GetPitchLimiter ());
-      // bool isStartInRegion = 0 > ((formerStop + timeSwingFromFormerState - start).GetSeconds () * (latterStart- timeSwingToLatterState - start).GetSeconds ());
-      // bool isStopInRegion = 0 > ((formerStop + timeSwingFromFormerState- stop).GetSeconds () * (latterStart - timeSwingToLatterState- stop).GetSeconds ());
-      // if (isStartInRegion && isStopInRegion)
-      // {
-      //   return latter;
-      // }
-      if (formerStop + timeSwingFromFormerState <= start && stop + timeSwingToLatterState <= latterStart)
-      {
-        return latter;
-      }
-    }
+    return false;
+  }
+  // if there is no latter task, the latter state will not be considered
+  if (hint == timeline.tasks.end ())
+  {
+    return true;
   }
-  return turntableStates.begin ();
+  const TurntableState& latter = hint->second.start;
+  if (stop > latter.time)
+  {
+    return false;
+  }
+  return BangBangLimiter::CanSwing (stopState.pointing, latter.pointing, azLimiter, ptLimiter, latter.time - stop);
 }
 
 bool
-AccessManager::TryInsert (
-  Ptr<Turntable>        src,
-  const TurntableState& srcStartState,
-  const TurntableState& srcStopState,
-  Ptr<Turntable>        dst,
-  const TurntableState& dstStartState,
-  const TurntableState& dstStopState)
+AccessManager::TryInsert (TurntableStateList& timelines, const AccessData& access)
 {
-  TurntableStates::iterator srcIt;
-  TurntableStates::iterator dstIt;
-  TurntableStates& srcTurntableStates = m_turntableStateList[src];
-  TurntableStates& dstTurntableStates = m_turntableStateList[dst];
-  srcIt = TryInsert (src, srcStartState, srcStopState);
-  dstIt = TryInsert (dst, dstStartState, dstStopState);
-  if (srcIt != srcTurntableStates.begin () && dstIt != dstTurntableStates.begin ())
-  {
-    TurntableStates srcStates {srcStartState, srcStopState};
-    srcTurntableStates.insert (srcIt, srcStates.begin (), srcStates.end ());
-    TurntableStates dstStates {dstStartState, dstStopState};
-    dstTurntableStates.insert (dstIt, dstStates.begin (), dstStates.end ());
+  ++g_nTryInserts;
+  const adi::LinkDatas& linkDatas = GetLinkDatas (access);
+  const adi::LinkData& first = linkDatas[access.fsoStart];
+  const adi::LinkData& last = linkDatas[access.fsoStop];
+  Time start = ToTime (first.time);
+  Time stop = ToTime (last.time);
+  TurntableState srcStartState {start, first.fromSrc};
+  TurntableState srcStopState {stop, last.fromSrc};
+  TurntableState dstStartState {start, first.fromDst};
+  TurntableState dstStopState {stop, last.fromDst};
+  TurntableTimeline& src = timelines[access.src];
+  TurntableTimeline& dst = timelines[access.dst];
+  TurntableTimeline::Tasks::iterator srcIt;
+  TurntableTimeline::Tasks::iterator dstIt;
+  if (TryInsert (src, access.src, srcStartState, srcStopState, srcIt)
+      && TryInsert (dst, access.dst, dstStartState, dstStopState, dstIt))
+  {
+    src.tasks.emplace_hint (srcIt, start, TurntableTask {srcStartState, srcStopState});
+    dst.tasks.emplace_hint (dstIt, start, TurntableTask {dstStartState, dstStopState});
     return true;
   }
   return false;
 }
 
+void
+AccessManager::SetScheduler (Ptr<AccessScheduler> scheduler)
+{
+  m_scheduler = scheduler;
+}
+
+Ptr<AccessScheduler>
+AccessManager::GetScheduler (void)
+{
+  if (m_scheduler == 0)
+  {
+    m_scheduler = CreateObject<GreedyAccessScheduler> ();
+  }
+  return m_scheduler;
+}
+
+Ptr<Turntable>
+AccessManager::GetTurntable (uint32_t id)
+{
+  NS_ASSERT (id < m_turntables.size ());
+  return m_turntables[id].turntable;
+}
+
+const adi::LinkDatas&
+AccessManager::GetLinkDatas (const AccessData& access)
+{
+  NS_ASSERT (m_datas && access.i < m_datas->size ());
+  return (*m_datas)[access.i].linkDatas;
+}
+
+uint32_t
+AccessManager::GetTurntableId (Turntable* turntable)
+{
+  std::map<const Turntable*, uint32_t>::iterator it = m_turntableIds.find (turntable);
+  if (it != m_turntableIds.end ())
+  {
+    return it->second;
+  }
+  // the limiters are precomputed once per box, the turntables of a type share them
+  static std::map<Box, BangBangLimiter, BoxLess> cache;
+  auto limit = [] (const Box& bound) -> const BangBangLimiter& {
+    std::map<Box, BangBangLimiter, BoxLess>::iterator entry = cache.find (bound);
+    if (entry == cache.end ())
+    {
+      entry = cache.emplace (bound, BangBangLimiter (bound)).first;
+    }
+    return entry->second;
+  };
+  uint32_t id = m_turntables.size ();
+  m_turntables.push_back (TurntableRecord {
+    Ptr<Turntable> (turntable),
+    limit (turntable->GetAzimuthLimiter ()),
+    limit (turntable->GetPitchLimiter ())});
+  m_turntableIds[turntable] = id;
+  return id;
+}
+
 AccessManager::AccessList&
 AccessManager::SelectTasks (const adi::LinkInfoList& datas, const std::vector<bool>& satisfied)
 {
-  std::vector<bool> result = std::vector<bool> (datas.size (), false);
+  m_turntableStateList.clear ();
+  return SelectTasks (datas, satisfied, Time::Max ());
+}
+
+AccessManager::AccessList&
+AccessManager::SelectTasks (const adi::LinkInfoList& datas, const std::vector<bool>& satisfied, const Time& commit)
+{
   m_accesses.clear ();
+  m_datas = &datas;
+  ReleaseTasks ();
+  AddAccessData (datas, 0, satisfied);
+  return ScheduleTasks (commit);
+}
+
+void
+AccessManager::ClearTasks (const adi::LinkInfoList& datas)
+{
   m_turntableStateList.clear ();
-  AddAccessData (datas, satisfied);
-  CalcScheme ();
-  AssignTurntableTask ();
+  m_accesses.clear ();
+  m_datas = &datas;
+}
+
+void
+AccessManager::RollTasks (adi::LinkInfoList& datas)
+{
+  if (m_datas != &datas)
+  {
+    m_accesses.clear ();
+  }
+  // the committed accesses are left to their channels,
+  // and the ones already started can not be selected any more
+  Time now = Now ();
+  AccessList accesses;
+  for (uint32_t i = 0;i < m_accesses.size ();++i)
+  {
+    const AccessData& access = m_accesses[i];
+    if (!access.selected && ToTime (GetLinkDatas (access)[access.fsoStart].time) >= now)
+    {
+      accesses.push_back (access);
+    }
+  }
+  // the link informations referred by the kept accesses are moved to the front in order
+  const uint32_t NONE = std::numeric_limits<uint32_t>::max ();
+  std::vector<uint32_t> index (datas.size (), NONE);
+  for (uint32_t i = 0;i < accesses.size ();++i)
+  {
+    index[accesses[i].i] = 0;
+  }
+  uint32_t n = 0;
+  for (uint32_t i = 0;i < datas.size ();++i)
+  {
+    if (index[i] == NONE)
+    {
+      continue;
+    }
+    if (n != i)
+    {
+      datas[n].src = datas[i].src;
+      datas[n].dst = datas[i].dst;
+      datas[n].linkDatas.swap (datas[i].linkDatas);
+    }
+    index[i] = n++;
+  }
+  datas.resize (n);
+  for (uint32_t i = 0;i < accesses.size ();++i)
+  {
+    accesses[i].i = index[accesses[i].i];
+  }
+  m_accesses.swap (accesses);
+  m_datas = &datas;
+  ReleaseTasks ();
+}
+
+AccessManager::AccessList&
+AccessManager::ScheduleTasks (const Time& commit)
+{
+  StageTimer::Scope total ("SelectTasks");
+  {
+    StageTimer::Scope scope ("CalcScheme");
+    CalcScheme ();
+  }
+  CommitTasks (commit);
+  {
+    StageTimer::Scope scope ("AssignTurntableTask");
+    AssignTurntableTask ();
+  }
+  uint64_t nSelected = 0;
+  for (uint32_t i = 0;i < m_accesses.size ();++i)
+  {
+    nSelected += m_accesses[i].selected ? 1 : 0;
+  }
+  StageTimer::Count ("accesses", m_accesses.size ());
+  StageTimer::Count ("selected", nSelected);
+  StageTimer::Count ("TryInsert", g_nTryInserts);
+  g_nTryInserts = 0;
   NS_LOG_INFO (ToString ());
   return m_accesses;
 }
 
+void
+AccessManager::ReleaseTasks (void)
+{
+  Time now = Now ();
+  typedef TurntableStateList::iterator IT;
+  for (IT it = m_turntableStateList.begin ();it != m_turntableStateList.end ();++it)
+  {
+    TurntableTimeline::Tasks& tasks = it->tasks;
+    while (!tasks.empty () && tasks.begin ()->second.stop.time <= now)
+    {
+      tasks.erase (tasks.begin ());
+    }
+  }
+}
+
+void
+AccessManager::CommitTasks (const Time& commit)
+{
+  for (uint32_t i = 0;i < m_accesses.size ();++i)
+  {
+    AccessData& access = m_accesses[i];
+    Time start = ToTime (GetLinkDatas (access)[access.fsoStart].time);
+    if (access.selected && start >= commit)
+    {
+      m_turntableStateList[access.src].tasks.erase (start);
+      m_turntableStateList[access.dst].tasks.erase (start);
+      access.selected = false;
+    }
+  }
+}
+
 void
 AccessManager::CalcScheme (void)
 {
@@ -185,257 +458,211 @@ AccessManager::CalcScheme (void)
   }
   for (uint32_t i = 0;i < m_accesses.size ();++i)
   {
-    Ptr<QkdStation> _dst = m_accesses[i].dst->GetNode ()->GetObject<QkdStation> ();
+    Ptr<QkdStation> _dst = GetTurntable (m_accesses[i].dst)->GetNode ()->GetObject<QkdStation> ();
     m_accesses[i].wValue = m_accesses[i].value * m_weights[_dst];
   }
     // sort the access descending by their value
   std::sort (m_accesses.begin (), m_accesses.end ());
+  // all turntables start from their current pointings
   for (uint32_t i = 0;i < m_accesses.size ();++i)
   {
-    // for (uint32_t j = i + 1;j < m_accesses.size ();++j)
-    // {
-    //   Ptr<QkdStation> _dst = m_accesses[j].dst->GetNode ()->GetObject<QkdStation> ();
-    //   m_accesses[j].wValue = m_accesses[j].value * m_weights[_dst];
-    // }
-    // // sort the access descending by their value
-    // std::sort (m_accesses.begin () + i + 1, m_accesses.end ());
-    Ptr<ns3::Turntable> src = NULL, dst = NULL;
-    AccessData& access = m_accesses[i];
-    src = access.src;
-    dst = access.dst;
-    if (m_turntableStateList.find (src) == m_turntableStateList.end ())
-    {
-      m_turntableStateList[src].push_back (TurntableState {Now (), src->GetPointing ()});
-    }
-    if (m_turntableStateList.find (dst) == m_turntableStateList.end ())
-    {
-      m_turntableStateList[dst].push_back (TurntableState {Now (), dst->GetPointing ()});
-    }
-    Time start = ToTime (access.fsoStart->time);
-    Time stop = ToTime (access.fsoStop->time);
-    TurntableState srcStartState {start, access.fsoStart->fromSrc};
-    TurntableState srcStopState {stop, access.fsoStop->fromSrc};
-    TurntableState dstStartState {start, access.fsoStart->fromDst};
-    TurntableState dstStopState {stop, access.fsoStop->fromDst};
-    if (true == TryInsert (
-      src, srcStartState, srcStopState,
-      dst, dstStartState, dstStopState))
-    {
-      access.selected = true;
-    }
-    else
-    {
-      access.selected = false;
-    }
+    uint32_t src = m_accesses[i].src;
+    uint32_t dst = m_accesses[i].dst;
+    m_turntableStateList[src].initial = TurntableState {Now (), GetTurntable (src)->GetPointing ()};
+    m_turntableStateList[dst].initial = TurntableState {Now (), GetTurntable (dst)->GetPointing ()};
+  }
+  Ptr<AccessScheduler> scheduler = GetScheduler ();
+  double value;
+  {
+    // dominated by TryInsert, whose calls are counted
+    StageTimer::Scope scope ("Schedule");
+    value = scheduler->Schedule (m_accesses, m_turntableStateList);
   }
+  NS_LOG_INFO (scheduler->GetInstanceTypeId ().GetName () << " selects accesses of total value " << value);
 }
 
 void
 AccessManager:: AssignTurntableTask (void)
 {
-  typedef TurntableStateList::iterator IT;
-  for (IT it = m_turntableStateList.begin ();it != m_turntableStateList.end ();++it)
+  typedef TurntableTimeline::Tasks::iterator TI;
+  Time now = Now ();
+  for (uint32_t id = 0;id < m_turntableStateList.size ();++id)
   {
-    for (uint32_t i = 1;i < it->second.size ();i += 2)
+    TurntableTimeline& timeline = m_turntableStateList[id];
+    // swing to the start of each task once the former one is finished,
+    // the swings into the kept tasks are rescheduled since new tasks may be inserted before them
+    const TurntableState* former = &timeline.initial;
+    for (TI task = timeline.tasks.begin ();task != timeline.tasks.end ();++task)
     {
-      Simulator::Schedule (it->second[i - 1].time - Now (), &Turntable::SetTargetPointing, it->first, it->second[i].time, it->second[i].pointing);
+      const TurntableState& latter = task->second.start;
+      if (latter.time >= now)
+      {
+        task->second.swing.Cancel ();
+        task->second.swing = Simulator::Schedule (std::max (former->time, now) - now, &Turntable::SetTargetPointing, GetTurntable (id), latter.time, latter.pointing);
+      }
+      former = &task->second.stop;
     }
   }
 }
 
 void
-AccessManager::AddAccessData (const adi::LinkInfoList& datas, const std::vector<bool>& satisfied)
+AccessManager::AddAccessData (const adi::LinkInfoList& datas, uint32_t first, const std::vector<bool>& satisfied)
 {
-  for (uint32_t i = 0;i < datas.size ();++i)
+  StageTimer::Scope scope ("AddAccessData");
+  NS_ASSERT (m_datas == &datas);
+  NS_ASSERT (first + satisfied.size () == datas.size ());
+  // the turntables are registered serially, the workers only read the records
+  std::vector<uint32_t> indices;
+  std::vector<uint32_t> srcs;
+  std::vector<uint32_t> dsts;
+  for (uint32_t i = first;i < datas.size ();++i)
   {
-    if (satisfied[i])
+    if (!satisfied[i - first])
+    {
+      continue;
+    }
+    Turntable* src = (Turntable*) datas[i].src->GetNs3 ();
+    Turntable* dst = (Turntable*) datas[i].dst->GetNs3 ();
+    NS_ASSERT (src->GetNode ()->GetObject<QkdSatellite> ());
+    NS_ASSERT (dst->GetNode ()->GetObject<QkdStation> ());
+    indices.push_back (i);
+    srcs.push_back (GetTurntableId (src));
+    dsts.push_back (GetTurntableId (dst));
+  }
+  m_turntableStateList.resize (m_turntables.size ());
+  // each block of link informations is evaluated into its own buffer,
+  // the buffers are merged in the order of blocks
+  typedef std::vector<AccessData> Buffer;
+  std::map<size_t, Buffer> buffers;
+  std::mutex mutex;
+  // a window held open over the end of the last horizon may start before now,
+  // the accesses already started can not be taken and are dropped
+  Time now = Now ();
+  auto body = [&] (size_t begin, size_t end) {
+    Buffer buffer;
+    for (size_t k = begin;k < end;++k)
     {
-      AddAccessData (datas[i], i);
+      AccessData access;
+      const TurntableRecord& src = m_turntables[srcs[k]];
+      const TurntableRecord& dst = m_turntables[dsts[k]];
+      if (CalcAccessData (datas[indices[k]], src.azLimiter, src.ptLimiter, dst.azLimiter, dst.ptLimiter, access)
+        && ToTime (datas[indices[k]].linkDatas[access.netStart].time) >= now)
+      {
+        access.i = indices[k];
+        access.src = srcs[k];
+        access.dst = dsts[k];
+        buffer.push_back (access);
+      }
     }
+    std::lock_guard<std::mutex> lock (mutex);
+    buffers[begin].swap (buffer);
+  };
+  adi::cpu::ParallelFor (indices.size (), body);
+  for (std::map<size_t, Buffer>::iterator it = buffers.begin ();it != buffers.end ();++it)
+  {
+    m_accesses.insert (m_accesses.end (), it->second.begin (), it->second.end ());
   }
 }
 
-void
-AccessManager::AddAccessData (const adi::LinkInfo& data, uint32_t i)
+bool
+AccessManager::CalcAccessData (
+  const adi::LinkInfo&    data,
+  const BangBangLimiter&  srcAz,
+  const BangBangLimiter&  srcPt,
+  const BangBangLimiter&  dstAz,
+  const BangBangLimiter&  dstPt,
+  AccessData&             access)
 {
-  typedef adi::LinkDatas::const_iterator CI;
-  typedef adi::LinkDatas::const_reverse_iterator CRI;
-  Ptr<Turntable> src = Ptr<Turntable> ((Turntable*) data.src->GetNs3 ());
-  Ptr<Turntable> dst = Ptr<Turntable> ((Turntable*) data.dst->GetNs3 ());
-  Ptr<QkdSatellite> sat = src->GetNode ()->GetObject<QkdSatellite> ();
-  Ptr<QkdStation> sta = dst->GetNode ()->GetObject<QkdStation> ();
-  NS_ASSERT (sat);
-  NS_ASSERT (sta);
-  Box satAzBound = src->GetAzimuthLimiter ();
-  Box satPtBound = src->GetPitchLimiter ();
-  Box staAzBound = dst->GetAzimuthLimiter ();
-  Box staPtBound = dst->GetPitchLimiter ();
-  AccessData access;
-  access.i = i;
-  access.src = src;
-  access.dst = dst;
+  const adi::LinkDatas& linkDatas = data.linkDatas;
+  uint32_t n = linkDatas.size ();
+  AccessTracker src (&adi::LinkData::fromSrc, SRC2DST, srcAz, srcPt);
+  AccessTracker dst (&adi::LinkData::fromDst, DST2SRC, dstAz, dstPt);
+  // values[k] is the value accumulated from the start of access to the k-th link data
+  std::vector<double> values (n, 0.0);
+  double value = 0.0;
+  // the first and the last (except the final one) link datas
+  // that the pointings of source and destination are all in limiter
+  uint32_t first = n;
+  uint32_t last = n;
   bool srcInLimiter = false;
   bool dstInLimiter = false;
-  bool findStart = false;
-  bool findStop = false;
-  CI it_start = data.linkDatas.cbegin ();
-  access.fsoStart = data.linkDatas.cbegin ();
-  // find the first time that the pointings of source and destination are all in limiter
-  for (CI it = data.linkDatas.cbegin ();it != data.linkDatas.cend ();++it)
-  {
-    // considering the angular rate limitter
-    double tmp1 = (it->fromSrc.rate.azimuth - satAzBound.yMax) * (it->fromSrc.rate.azimuth - satAzBound.yMin);
-    double tmp2 = (it->fromSrc.rate.pitch - satPtBound.yMax) * (it->fromSrc.rate.pitch - satPtBound.yMin);
-    double tmp3 = (it->fromDst.rate.azimuth - staAzBound.yMax) * (it->fromDst.rate.azimuth - staAzBound.yMin);
-    double tmp4 = (it->fromDst.rate.pitch - staPtBound.yMax) * (it->fromDst.rate.pitch - staPtBound.yMin);
-    // considering the angle limitter
-    uint8_t state = it->state;
-    srcInLimiter = tmp1 <= 0 && tmp2 <= 0 && (state & SRC2DST);
-    dstInLimiter = tmp3 <= 0 && tmp4 <= 0 && (state & DST2SRC);
-    if (srcInLimiter && dstInLimiter && it->distance <= adi::K_MAX_DISTANCE)
-    {
-      findStart = true;
-      it_start = std::max (it - 1, data.linkDatas.cbegin ());
-      break;
-    }
-  }
-  CI it_stop = data.linkDatas.cend () - 1;
-  access.fsoStop = data.linkDatas.cend () - 1;
-  // find the last time that the pointings of source and destination are all in limiter
-  for (CRI it = data.linkDatas.crbegin () + 1;it != data.linkDatas.crend ();++it)
-  {
-    // considering the angular rate limitter
-    double tmp1 = (it->fromSrc.rate.azimuth - satAzBound.yMax) * (it->fromSrc.rate.azimuth - satAzBound.yMin);
-    double tmp2 = (it->fromSrc.rate.pitch - satPtBound.yMax) * (it->fromSrc.rate.pitch - satPtBound.yMin);
-    double tmp3 = (it->fromDst.rate.azimuth - staAzBound.yMax) * (it->fromDst.rate.azimuth - staAzBound.yMin);
-    double tmp4 = (it->fromDst.rate.pitch - staPtBound.yMax) * (it->fromDst.rate.pitch - staPtBound.yMin);
-    // considering the angle limitter
-    uint8_t state = it->state;
-    srcInLimiter = tmp1 <= 0 && tmp2 <= 0 && (state & SRC2DST);
-    dstInLimiter = tmp3 <= 0 && tmp4 <= 0 && (state & DST2SRC);
-    if (srcInLimiter && dstInLimiter && it->distance <= adi::K_MAX_DISTANCE)
-    {
-      findStop = true;
-      it_stop = it.base ();
-      break;
-    }
-  }
-  if (it_stop->time <= it_start->time || (it_stop->time - it_start->time) < adi::TimeSpan (0, 1, 0))
+  for (uint32_t k = 0;k < n;++k)
   {
-    return;
-  }
-  if (!findStart || !findStop)
-  {
-    return;
-  }
-  access.fsoStart = it_start;
-  access.netStart = it_start;
-  if (data.linkDatas.cend () - it_stop < 10)
-  {
-    it_stop = data.linkDatas.cend () - 10;
-  }
-  access.fsoStop = it_stop;
-  access.netStop = it_stop;
-  access.value = 0;
-  access.selected = false;
-  BangBangController::State srcAzInitState, srcAzLastState;
-  BangBangController::State srcPtInitState, srcPtLastState;
-  BangBangController::State dstAzInitState, dstAzLastState;
-  BangBangController::State dstPtInitState, dstPtLastState;
-  // assume the turntables always track the targets at first time
-  bool srcTracking = true;
-  bool dstTracking = true;
-  srcInLimiter = false;
-  dstInLimiter = false;
-  Time srcLostTime, dstLostTime;
-  Time srcRelinkTime, dstRelinkTime;
-  for (CI it = it_start;it != it_stop + 1;++it)
-  {
-    // considering the angular rate limitter
-    double tmp1 = (it->fromSrc.rate.azimuth - satAzBound.yMax) * (it->fromSrc.rate.azimuth - satAzBound.yMin);
-    double tmp2 = (it->fromSrc.rate.pitch - satPtBound.yMax) * (it->fromSrc.rate.pitch - satPtBound.yMin);
-    double tmp3 = (it->fromDst.rate.azimuth - staAzBound.yMax) * (it->fromDst.rate.azimuth - staAzBound.yMin);
-    double tmp4 = (it->fromDst.rate.pitch - staPtBound.yMax) * (it->fromDst.rate.pitch - staPtBound.yMin);
-    // considering the angle limitter
-    uint8_t state = it->state;
-    srcInLimiter = tmp1 <= 0 && tmp2 <= 0 && (state & SRC2DST);
-    dstInLimiter = tmp3 <= 0 && tmp4 <= 0 && (state & DST2SRC);
-    if (srcInLimiter && dstInLimiter)
+    const adi::LinkData& curr = linkDatas[k];
+    bool srcWasInLimiter = srcInLimiter;
+    bool dstWasInLimiter = dstInLimiter;
+    srcInLimiter = src.IsInLimiter (curr);
+    dstInLimiter = dst.IsInLimiter (curr);
+    if (srcInLimiter && dstInLimiter && curr.distance <= adi::K_MAX_DISTANCE)
     {
-      if (!srcTracking || !dstTracking)
+      if (first == n)
       {
-        Time now = ToTime (it->time);
-        // if source's turntable can not track the target
-        // then calculate the transition time from loss state to current state
-        if (!srcTracking)
-        {
-          srcAzLastState = BangBangController::State(ToTime (it->time), it->fromSrc.angle.azimuth, it->fromSrc.rate.azimuth);
-          srcPtLastState = BangBangController::State(ToTime (it->time), it->fromSrc.angle.pitch, it->fromSrc.rate.pitch);
-          Time t1 = BangBangController::SwingTime (srcAzInitState, srcAzLastState, satAzBound);
-          Time t2 = BangBangController::SwingTime (srcPtInitState, srcPtLastState, satPtBound);
-          Time t = std::max (t1, t2);
-          if ((now - srcLostTime) >= t)
-          {
-            srcTracking = true;
-            srcRelinkTime = now;
-          }
-        }
-        // same with source'turntable
-        if (!dstTracking)
-        {
-          dstAzLastState = BangBangController::State(ToTime (it->time), it->fromDst.angle.azimuth, it->fromDst.rate.azimuth);
-          dstPtLastState = BangBangController::State(ToTime (it->time), it->fromDst.angle.pitch, it->fromDst.rate.pitch);
-          Time t1 = BangBangController::SwingTime (dstAzInitState, dstAzLastState, staAzBound);
-          Time t2 = BangBangController::SwingTime (dstPtInitState, dstPtLastState, staPtBound);
-          Time t = std::max (t1, t2);
-          if ((now - dstLostTime) >= t)
-          {
-            dstTracking = true;
-            dstRelinkTime = now;
-          }
-        }
+        first = k;
       }
-      if (srcTracking && dstTracking && (state & BEYOND_DISTANCE) == 0)
+      if (k + 1 < n)
       {
-        double distance = it->distance;
-        double value = 1.0 / (distance * distance);
-        access.value += value;
+        last = k;
       }
     }
-    else
+    if (first == n)
+    {
+      continue;
+    }
+    // the access starts from the link data before the first one,
+    // the tracking states are evaluated from there
+    uint32_t start = k == first && k > 0 ? k - 1 : k;
+    for (uint32_t j = start;j <= k;++j)
     {
-      if (!srcInLimiter && srcTracking)
+      bool srcIn = j < k ? srcWasInLimiter : srcInLimiter;
+      bool dstIn = j < k ? dstWasInLimiter : dstInLimiter;
+      const adi::LinkData& d = linkDatas[j];
+      if (srcIn && dstIn)
       {
-        srcTracking = false;
-        CI _it = std::max (it - 1, data.linkDatas.cbegin ());
-        srcLostTime = ToTime (it->time);
-        srcAzInitState = BangBangController::State(
-          ToTime (_it->time), 
-          _it->fromSrc.angle.azimuth,
-          _it->fromSrc.rate.azimuth);
-        srcPtInitState = BangBangController::State(
-          ToTime (_it->time), 
-          _it->fromSrc.angle.pitch,
-          _it->fromSrc.rate.pitch);
+        // assume the turntables always track the targets at first time
+        src.Relink (d);
+        dst.Relink (d);
+        if (src.IsTracking () && dst.IsTracking () && (d.state & BEYOND_DISTANCE) == 0)
+        {
+          value += 1.0 / (d.distance * d.distance);
+        }
       }
-      if (!dstInLimiter && dstTracking)
+      else
       {
-        dstTracking = false;
-        CI _it = std::max (it - 1, data.linkDatas.cbegin ());
-        dstLostTime = ToTime (it->time);
-        dstAzInitState = BangBangController::State(
-          ToTime (_it->time), 
-          _it->fromDst.angle.azimuth,
-          _it->fromDst.rate.azimuth);
-        dstPtInitState = BangBangController::State(
-          ToTime (_it->time), 
-          _it->fromDst.angle.pitch,
-          _it->fromDst.rate.pitch);
+        const adi::LinkData& former = linkDatas[j > 0 ? j - 1 : 0];
+        if (!srcIn)
+        {
+          src.Lose (former, d);
+        }
+        if (!dstIn)
+        {
+          dst.Lose (former, d);
+        }
       }
+      values[j] = value;
     }
   }
+  if (first == n || last == n)
+  {
+    return false;
+  }
+  uint32_t start = first > 0 ? first - 1 : 0;
+  uint32_t stop = last + 1;
+  if (linkDatas[stop].time <= linkDatas[start].time || (linkDatas[stop].time - linkDatas[start].time) < adi::TimeSpan (0, 1, 0))
+  {
+    return false;
+  }
+  if (n - stop < 10)
+  {
+    stop = n - 10;
+  }
+  access.fsoStart = start;
+  access.netStart = start;
+  access.fsoStop = stop;
+  access.netStop = stop;
+  access.value = values[stop];
   access.wValue = access.value;
-  m_accesses.push_back (access);
+  access.selected = false;
+  return true;
 }
 
 std::string
@@ -445,15 +672,13 @@ AccessManager::ToString (void)
   ss.setf (std::ios::right);
   struct _AccessData
   {
-    Ptr<Turntable> src;
-    Ptr<Turntable> dst;
+    uint32_t src;
     Time start;
     Time stop;
     _AccessData (const AccessData& data)
     : src   (data.src)
-    , dst   (data.dst)
-    , start (ToTime (data.fsoStart->time))
-    , stop  (ToTime (data.fsoStop->time))
+    , start (ToTime (GetLinkDatas (data)[data.fsoStart].time))
+    , stop  (ToTime (GetLinkDatas (data)[data.fsoStop].time))
     {
     }
     bool operator< (const _AccessData& data)
@@ -461,7 +686,7 @@ AccessManager::ToString (void)
       return start < data.start && stop <= data.start;
     }
   };
-  typedef std::map<Ptr<Turntable>, std::vector<_AccessData>> _Task;
+  typedef std::map<uint32_t, std::vector<_AccessData>> _Task;
   _Task _task;
   for (uint32_t i = 0;i < m_accesses.size ();++i)
   {
@@ -469,21 +694,17 @@ AccessManager::ToString (void)
     {
       continue;
     }
-    _AccessData _access = _AccessData (m_accesses[i]);
-    Ptr<Turntable> src = _access.src;
-    Ptr<Turntable> dst = _access.dst;
-    _task[dst].push_back (_access);
-    
+    _task[m_accesses[i].dst].push_back (_AccessData (m_accesses[i]));
   }
   for (_Task::iterator i = _task.begin ();i != _task.end ();++i)
   {
     std::sort (i->second.begin (), i->second.end ());
     ss << std::setw (15) << "Time"   << std::setw (32) << "Destination" << std::endl
-       << std::setw (15) << "Source" << std::setw (32) << i->first->GetName () << std::endl;
+       << std::setw (15) << "Source" << std::setw (32) << GetTurntable (i->first)->GetName () << std::endl;
     for (uint32_t j = 0;j < i->second.size ();++j)
     {
       _AccessData& _access = i->second[j];
-      ss << std::setw (15) << _access.src->GetName () << std::setw (32) << ToTime (_access.start) << std::setw (32) << ToTime (_access.stop) << std::endl;
+      ss << std::setw (15) << GetTurntable (_access.src)->GetName () << std::setw (32) << ToTime (_access.start) << std::setw (32) << ToTime (_access.stop) << std::endl;
     }
   }
   return ss.str ();
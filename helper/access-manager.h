@@ -23,29 +23,39 @@
 
 #include <map>
 #include <vector>
-#include <deque>
 #include "ns3/nstime.h"
+#include "ns3/box.h"
+#include "ns3/event-id.h"
 #include "adi-type-define.h"
 #include "ns3/coordinate-turntable.h"
+#include "ns3/bang-bang-limiter.h"
 
 namespace ns3 {
 
 class QkdSatellite;
 class QkdStation;
 class Turntable;
+class AccessScheduler;
 
 class AccessManager
 {
 public:
+  /**
+   * \brief The access record, trivially copyable to be sorted in place
+   *
+   * The link datas are indices into the link information, which is kept by
+   * the caller of SelectTasks, and the turntables are the ids registered in
+   * the manager, resolved by GetLinkDatas and GetTurntable.
+   */
   struct AccessData
   {
-    uint32_t i;
-    Ptr<Turntable> src;
-    Ptr<Turntable> dst;
-    adi::LinkDatas::const_iterator fsoStart;
-    adi::LinkDatas::const_iterator fsoStop;
-    adi::LinkDatas::const_iterator netStart;
-    adi::LinkDatas::const_iterator netStop;
+    uint32_t i;         //!< the index of link information
+    uint32_t src;       //!< the id of source turntable
+    uint32_t dst;       //!< the id of destination turntable
+    uint32_t fsoStart;  //!< the index of the first link data of fso link
+    uint32_t fsoStop;   //!< the index of the link data at the end of fso link
+    uint32_t netStart;  //!< the index of the first link data of net link
+    uint32_t netStop;   //!< the index of the link data at the end of net link
     double value;
     double wValue;
     bool selected;
@@ -57,32 +67,176 @@ public:
     CoordTurntable pointing;
     bool operator< (const TurntableState& state) const;
   };
-  typedef std::deque<AccessData> AccessList;
+  struct TurntableTask
+  {
+    TurntableState start;
+    TurntableState stop;
+    EventId        swing;   //!< the event to swing into the task
+  };
+  /**
+   * \brief The ordered gap index of one turntable
+   *
+   * The tasks are disjoint and keyed by their start time, so the free gap
+   * containing a period is found and filled in O(log n).
+   */
+  struct TurntableTimeline
+  {
+    typedef std::map<Time, TurntableTask> Tasks;
+    TurntableState  initial;  //!< the state when the scheduling starts
+    Tasks           tasks;    //!< the tasks keyed by their start time
+  };
+  typedef std::vector<AccessData> AccessList;
   typedef AccessList::iterator AccessIter;
-  typedef std::vector<TurntableState> TurntableStates;
-  typedef std::map<Ptr<Turntable>, TurntableStates> TurntableStateList;
+  /** The timelines indexed by the ids of turntables */
+  typedef std::vector<TurntableTimeline> TurntableStateList;
   AccessManager (){}
   ~AccessManager (){}
+  /**
+   * \brief Select the accesses from scratch, all selected accesses are committed
+   * \param[in] datas     the link informations
+   * \param[in] satisfied whether each link information is satisfied
+   * \return the accesses, the committed ones are selected
+   */
   static AccessList& SelectTasks (const adi::LinkInfoList& datas, const std::vector<bool>& satisfied);
+  /**
+   * \brief Select the accesses incrementally, the committed tasks of turntables are kept
+   * and the new accesses are inserted around them, only the ones starting before
+   * the commit time are committed, the others are left to the next selection
+   * \param[in] datas     the link informations
+   * \param[in] satisfied whether each link information is satisfied
+   * \param[in] commit    the time before which the selected accesses are committed
+   * \return the accesses, the committed ones are selected
+   */
+  static AccessList& SelectTasks (const adi::LinkInfoList& datas, const std::vector<bool>& satisfied, const Time& commit);
+  /**
+   * \brief Start a selection from scratch whose link informations are added chunk by chunk,
+   * the timelines and accesses are cleared
+   * \param[in] datas the link informations, they are only appended to until the selection
+   *            is scheduled, so the indices of accesses into them stay valid
+   */
+  static void ClearTasks (const adi::LinkInfoList& datas);
+  /**
+   * \brief Start a selection whose link informations are added chunk by chunk, the
+   * committed tasks of turntables are kept and the finished ones are released.
+   * If the link informations are the ones of the last selection, its accesses that are
+   * neither committed nor started are kept, and the link informations not referred by
+   * them are removed, so only the accesses of new link informations have to be added
+   * \param[in,out] datas the link informations, they are only appended to until the selection
+   *            is scheduled, so the indices of accesses into them stay valid
+   */
+  static void RollTasks (adi::LinkInfoList& datas);
+  /**
+   * \brief Evaluate the accesses of the link informations appended since the last call
+   * \param[in] datas     the link informations given to ClearTasks or RollTasks
+   * \param[in] first     the index of the first appended link information
+   * \param[in] satisfied whether each appended link information is satisfied
+   */
+  static void AddAccessData (const adi::LinkInfoList& datas, uint32_t first, const std::vector<bool>& satisfied);
+  /**
+   * \brief Select among the accesses added so far, only the ones starting before the
+   * commit time are committed
+   * \param[in] commit the time before which the selected accesses are committed
+   * \return the accesses, the committed ones are selected
+   */
+  static AccessList& ScheduleTasks (const Time& commit);
+  /**
+   * \brief Set the scheduler which selects the accesses, greedy by default
+   * \param[in] scheduler the scheduler
+   */
+  static void SetScheduler (Ptr<AccessScheduler> scheduler);
+  /**
+   * \brief Get the scheduler which selects the accesses
+   * \return the scheduler
+   */
+  static Ptr<AccessScheduler> GetScheduler (void);
+  /**
+   * \brief Try to insert an access into the timelines of both turntables
+   * \param[in,out] timelines the timelines of turntables
+   * \param[in] access        the access
+   * \return true if both turntables are free and inserted, false otherwise
+   */
+  static bool TryInsert (TurntableStateList& timelines, const AccessData& access);
+  /**
+   * \brief Get the turntable of id
+   * \param[in] id the id of turntable
+   * \return the turntable
+   */
+  static Ptr<Turntable> GetTurntable (uint32_t id);
+  /**
+   * \brief Get the link datas which the indices of access refer to, they are
+   *        valid until the link informations given to SelectTasks are released
+   * \param[in] access the access
+   * \return the link datas of the link information of access
+   */
+  static const adi::LinkDatas& GetLinkDatas (const AccessData& access);
+  /**
+   * \brief Find the access period and its value in a single pass over the link datas,
+   * the link information and turntables of access are not set, so it is safe to call
+   * from worker threads
+   * \param[in] data      the link information
+   * \param[in] srcAz     the azimuth limiter of source turntable
+   * \param[in] srcPt     the pitch limiter of source turntable
+   * \param[in] dstAz     the azimuth limiter of destination turntable
+   * \param[in] dstPt     the pitch limiter of destination turntable
+   * \param[out] access   the access
+   * \return true if the access is usable, false otherwise
+   */
+  static bool CalcAccessData (
+    const adi::LinkInfo&    data,
+    const BangBangLimiter&  srcAz,
+    const BangBangLimiter&  srcPt,
+    const BangBangLimiter&  dstAz,
+    const BangBangLimiter&  dstPt,
+    AccessData&             access);
 private:
   static void CalcScheme (void);
+  /**
+   * \brief Remove the tasks finished before now from the timelines
+   */
+  static void ReleaseTasks (void);
+  /**
+   * \brief Remove the selected accesses starting not before the commit time from the timelines
+   * \param[in] commit the commit time
+   */
+  static void CommitTasks (const Time& commit);
   static void AssignTurntableTask (void);
   static std::string ToString (void);
-  static void AddAccessData (const adi::LinkInfoList& datas, const std::vector<bool>& satisfied);
-  static void AddAccessData (const adi::LinkInfo& data, uint32_t i);
+  /**
+   * \brief The registered turntable with its precomputed limiters
+   */
+  struct TurntableRecord
+  {
+    Ptr<Turntable>  turntable;  //!< the turntable
+    BangBangLimiter azLimiter;  //!< the azimuth limiter
+    BangBangLimiter ptLimiter;  //!< the pitch limiter
+  };
+  /**
+   * \brief Get the id of turntable, it is registered at the first time
+   * \param[in] turntable the turntable
+   * \return the id of turntable
+   */
+  static uint32_t GetTurntableId (Turntable* turntable);
 private:
-  static TurntableStates::iterator TryInsert (
-    Ptr<Turntable>        turntable,
-    const TurntableState& startState,
-    const TurntableState& stopState);
+  /**
+   * \brief Find the free gap of turntable which can hold the task
+   * \param[in] timeline    the timeline of turntable
+   * \param[in] turntable   the id of turntable
+   * \param[in] startState  the state at the start of task
+   * \param[in] stopState   the state at the end of task
+   * \param[out] hint       the task after the gap, the hint of insertion
+   * \return true if the turntable can swing into and out of the task in time
+   */
   static bool TryInsert (
-    Ptr<Turntable>        src,
-    const TurntableState& srcStartState,
-    const TurntableState& srcStopState,
-    Ptr<Turntable>        dst,
-    const TurntableState& dstStartState,
-    const TurntableState& dstStopState);
+    TurntableTimeline&    timeline,
+    uint32_t              turntable,
+    const TurntableState& startState,
+    const TurntableState& stopState,
+    TurntableTimeline::Tasks::iterator& hint);
   static AccessList m_accesses;
+  static const adi::LinkInfoList* m_datas;
+  static std::vector<TurntableRecord> m_turntables;
+  static std::map<const Turntable*, uint32_t> m_turntableIds;
+  static Ptr<AccessScheduler> m_scheduler;
   static TurntableStateList m_turntableStateList;
 };
 
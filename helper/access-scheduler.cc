@@ -0,0 +1,474 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <algorithm>
+#include <set>
+#include <map>
+#include <limits>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "ns3/turntable.h"
+#include "ns3/qkd-station.h"
+#include "ns3/qkd-satellite-list.h"
+#include "ns3/bang-bang-controller.h"
+#include "ns3/util.h"
+#include "access-scheduler.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AccessScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (AccessScheduler);
+NS_OBJECT_ENSURE_REGISTERED (GreedyAccessScheduler);
+NS_OBJECT_ENSURE_REGISTERED (IntervalAccessScheduler);
+NS_OBJECT_ENSURE_REGISTERED (LookaheadAccessScheduler);
+
+TypeId
+AccessScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AccessScheduler")
+    .SetParent<Object> ()
+    .SetGroupName ("Qkd")
+  ;
+  return tid;
+}
+
+AccessScheduler::AccessScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+AccessScheduler::~AccessScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+double
+AccessScheduler::Fill (
+  AccessManager::AccessList& accesses,
+  AccessManager::TurntableStateList& timelines)
+{
+  double value = 0.0;
+  for (uint32_t i = 0;i < accesses.size ();++i)
+  {
+    AccessManager::AccessData& access = accesses[i];
+    if (!access.selected)
+    {
+      access.selected = AccessManager::TryInsert (timelines, access);
+    }
+    if (access.selected)
+    {
+      value += access.wValue;
+    }
+  }
+  return value;
+}
+
+TypeId
+GreedyAccessScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::GreedyAccessScheduler")
+    .SetParent<AccessScheduler> ()
+    .SetGroupName ("Qkd")
+    .AddConstructor<GreedyAccessScheduler> ()
+  ;
+  return tid;
+}
+
+GreedyAccessScheduler::GreedyAccessScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+GreedyAccessScheduler::~GreedyAccessScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+double
+GreedyAccessScheduler::Schedule (
+  AccessManager::AccessList& accesses,
+  AccessManager::TurntableStateList& timelines)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0;i < accesses.size ();++i)
+  {
+    accesses[i].selected = false;
+  }
+  return Fill (accesses, timelines);
+}
+
+TypeId
+IntervalAccessScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::IntervalAccessScheduler")
+    .SetParent<AccessScheduler> ()
+    .SetGroupName ("Qkd")
+    .AddConstructor<IntervalAccessScheduler> ()
+    .AddAttribute ("MaxPredecessors",
+                   "The maximum latest predecessors considered for each access, "
+                   "which bounds the time of dynamic programming",
+                   UintegerValue (256),
+                   MakeUintegerAccessor (&IntervalAccessScheduler::m_maxPredecessors),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+IntervalAccessScheduler::IntervalAccessScheduler ()
+: m_maxPredecessors (256)
+, m_greedyValue     (0.0)
+, m_value           (0.0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+IntervalAccessScheduler::~IntervalAccessScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+double
+IntervalAccessScheduler::GetGreedyValue (void) const
+{
+  return m_greedyValue;
+}
+
+double
+IntervalAccessScheduler::GetValue (void) const
+{
+  return m_value;
+}
+
+std::vector<uint32_t>
+IntervalAccessScheduler::CalcChain (
+  const std::vector<adi::DateTime>& starts,
+  const std::vector<adi::DateTime>& stops,
+  const std::vector<double>& values,
+  const std::function<bool (uint32_t)>& isReachable,
+  const std::function<bool (uint32_t, uint32_t)>& isChainable,
+  uint32_t maxPredecessors)
+{
+  uint32_t n = values.size ();
+  // best[j] is the maximum value of the chains ending with the j-th access
+  std::vector<double> best (n, 0.0);
+  std::vector<bool> reached (n, false);
+  std::vector<uint32_t> prev (n, n);
+  uint32_t last = n;
+  for (uint32_t j = 0;j < n;++j)
+  {
+    reached[j] = isReachable (j);
+    double base = 0.0;
+    // the predecessors stop before the start, they are all before j
+    uint32_t end = std::upper_bound (stops.begin (), stops.begin () + j, starts[j]) - stops.begin ();
+    for (uint32_t k = end, count = 0;k > 0 && count < maxPredecessors;--k, ++count)
+    {
+      uint32_t i = k - 1;
+      // only the better predecessors are worth the swing time
+      if (!reached[i] || (reached[j] && best[i] <= base))
+      {
+        continue;
+      }
+      if (isChainable (i, j))
+      {
+        reached[j] = true;
+        base = best[i];
+        prev[j] = i;
+      }
+    }
+    if (!reached[j])
+    {
+      continue;
+    }
+    best[j] = base + values[j];
+    if (last == n || best[j] > best[last])
+    {
+      last = j;
+    }
+  }
+  std::vector<uint32_t> chain;
+  for (uint32_t j = last;j < n;j = prev[j])
+  {
+    chain.push_back (j);
+  }
+  return chain;
+}
+
+std::vector<bool>
+IntervalAccessScheduler::CalcChains (
+  const AccessManager::AccessList& accesses,
+  AccessManager::TurntableStateList& timelines) const
+{
+  std::vector<bool> chained (accesses.size (), false);
+  std::map<uint32_t, std::vector<uint32_t>> stations;
+  // the start and stop link datas of accesses
+  std::vector<const adi::LinkData*> starts (accesses.size ());
+  std::vector<const adi::LinkData*> stops (accesses.size ());
+  for (uint32_t i = 0;i < accesses.size ();++i)
+  {
+    stations[accesses[i].dst].push_back (i);
+    const adi::LinkDatas& linkDatas = AccessManager::GetLinkDatas (accesses[i]);
+    starts[i] = &linkDatas[accesses[i].fsoStart];
+    stops[i] = &linkDatas[accesses[i].fsoStop];
+  }
+  for (std::map<uint32_t, std::vector<uint32_t>>::iterator it = stations.begin ();it != stations.end ();++it)
+  {
+    Ptr<Turntable> turntable = AccessManager::GetTurntable (it->first);
+    std::vector<uint32_t>& ids = it->second;
+    std::sort (ids.begin (), ids.end (), [&stops] (uint32_t a, uint32_t b) {
+      return stops[a]->time < stops[b]->time;
+    });
+    const AccessManager::TurntableState& initial = timelines[it->first].initial;
+    BangBangLimiter azLimiter (turntable->GetAzimuthLimiter ());
+    BangBangLimiter ptLimiter (turntable->GetPitchLimiter ());
+    std::vector<adi::DateTime> startTimes, stopTimes;
+    std::vector<double> values;
+    for (uint32_t id : ids)
+    {
+      startTimes.push_back (starts[id]->time);
+      stopTimes.push_back (stops[id]->time);
+      values.push_back (accesses[id].wValue);
+    }
+    std::vector<uint32_t> chain = CalcChain (startTimes, stopTimes, values,
+      [&] (uint32_t j) {
+        const adi::LinkData& first = *starts[ids[j]];
+        CoordTurntable pointing = first.fromDst;
+        return BangBangLimiter::CanSwing (initial.pointing, pointing, azLimiter, ptLimiter, ToTime (first.time) - initial.time);
+      },
+      [&] (uint32_t i, uint32_t j) {
+        const adi::LinkData& former = *stops[ids[i]];
+        const adi::LinkData& latter = *starts[ids[j]];
+        CoordTurntable formerPointing = former.fromDst;
+        CoordTurntable latterPointing = latter.fromDst;
+        return BangBangLimiter::CanSwing (formerPointing, latterPointing, azLimiter, ptLimiter, ToTime (latter.time) - ToTime (former.time));
+      },
+      m_maxPredecessors);
+    for (uint32_t j : chain)
+    {
+      chained[ids[j]] = true;
+    }
+  }
+  return chained;
+}
+
+double
+IntervalAccessScheduler::Schedule (
+  AccessManager::AccessList& accesses,
+  AccessManager::TurntableStateList& timelines)
+{
+  NS_LOG_FUNCTION (this);
+  // the greedy scheme as the reference
+  AccessManager::TurntableStateList greedyTimelines = timelines;
+  for (uint32_t i = 0;i < accesses.size ();++i)
+  {
+    accesses[i].selected = false;
+  }
+  m_greedyValue = Fill (accesses, greedyTimelines);
+  std::vector<bool> greedySelected (accesses.size ());
+  for (uint32_t i = 0;i < accesses.size ();++i)
+  {
+    greedySelected[i] = accesses[i].selected;
+  }
+  // the chains of stations first, conflicts on satellites are resolved by value,
+  // then the rest accesses fill the gaps
+  std::vector<bool> chained = CalcChains (accesses, timelines);
+  AccessManager::TurntableStateList chainTimelines = timelines;
+  for (uint32_t i = 0;i < accesses.size ();++i)
+  {
+    accesses[i].selected = chained[i] && AccessManager::TryInsert (chainTimelines, accesses[i]);
+  }
+  m_value = Fill (accesses, chainTimelines);
+  NS_LOG_INFO ("greedy value: " << m_greedyValue << " interval value: " << m_value);
+  if (m_value < m_greedyValue)
+  {
+    for (uint32_t i = 0;i < accesses.size ();++i)
+    {
+      accesses[i].selected = greedySelected[i];
+    }
+    m_value = m_greedyValue;
+    timelines.swap (greedyTimelines);
+  }
+  else
+  {
+    timelines.swap (chainTimelines);
+  }
+  return m_value;
+}
+
+TypeId
+LookaheadAccessScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LookaheadAccessScheduler")
+    .SetParent<AccessScheduler> ()
+    .SetGroupName ("Qkd")
+    .AddConstructor<LookaheadAccessScheduler> ()
+    .AddAttribute ("ConsumptionRate",
+                   "The forecast key consumption of the stations not set, "
+                   "in keys of the key gap per second",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&LookaheadAccessScheduler::m_consumptionRate),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("KeyPerValue",
+                   "The keys of the key gap generated per value of access, "
+                   "that is the key rate of a link at 1 km in keys per second, "
+                   "since the value sums 1/d^2 of samples of one second with d in km. "
+                   "It must be set",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&LookaheadAccessScheduler::m_keyPerValue),
+                   MakeDoubleChecker<double> (0.0))
+  ;
+  return tid;
+}
+
+LookaheadAccessScheduler::LookaheadAccessScheduler ()
+: m_consumptionRate (0.0)
+, m_keyPerValue     (0.0)
+, m_minReserve      (0.0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LookaheadAccessScheduler::~LookaheadAccessScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+LookaheadAccessScheduler::SetConsumptionRate (Ptr<QkdStation> station, double rate)
+{
+  NS_LOG_FUNCTION (this << station << rate);
+  NS_ASSERT (rate >= 0);
+  m_consumptionRates[station] = rate;
+}
+
+double
+LookaheadAccessScheduler::GetConsumptionRate (Ptr<QkdStation> station) const
+{
+  std::map<Ptr<QkdStation>, double>::const_iterator it = m_consumptionRates.find (station);
+  return it == m_consumptionRates.end () ? m_consumptionRate : it->second;
+}
+
+void
+LookaheadAccessScheduler::SetKeyPerValue (double keyPerValue)
+{
+  NS_LOG_FUNCTION (this << keyPerValue);
+  NS_ASSERT (keyPerValue > 0);
+  m_keyPerValue = keyPerValue;
+}
+
+double
+LookaheadAccessScheduler::GetMinReserve (void) const
+{
+  return m_minReserve;
+}
+
+double
+LookaheadAccessScheduler::Schedule (
+  AccessManager::AccessList& accesses,
+  AccessManager::TurntableStateList& timelines)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_keyPerValue <= 0 && !accesses.empty (),
+                   "LookaheadAccessScheduler::Schedule (): KeyPerValue is not set");
+  // the pass database: the accesses of each station over all of its turntables,
+  // descending by value since they are sorted by weighted value,
+  // the lists are reused by the next roll
+  for (uint32_t s = 0;s < m_stations.size ();++s)
+  {
+    m_passes[s].clear ();
+  }
+  m_stations.clear ();
+  const uint32_t NONE = std::numeric_limits<uint32_t>::max ();
+  std::map<Ptr<QkdStation>, uint32_t> slots;  // the index of each station in m_stations
+  std::vector<uint32_t> owners;               // the index of the station owning each turntable
+  Time horizon = Seconds (0.0);
+  for (uint32_t i = 0;i < accesses.size ();++i)
+  {
+    accesses[i].selected = false;
+    uint32_t dst = accesses[i].dst;
+    if (dst >= owners.size ())
+    {
+      owners.resize (dst + 1, NONE);
+    }
+    if (owners[dst] == NONE)
+    {
+      Ptr<QkdStation> station = AccessManager::GetTurntable (dst)->GetNode ()->GetObject<QkdStation> ();
+      NS_ASSERT (station);
+      std::pair<std::map<Ptr<QkdStation>, uint32_t>::iterator, bool> slot = slots.emplace (station, m_stations.size ());
+      if (slot.second)
+      {
+        m_stations.push_back (station);
+        if (m_passes.size () < m_stations.size ())
+        {
+          m_passes.resize (m_stations.size ());
+        }
+      }
+      owners[dst] = slot.first->second;
+    }
+    m_passes[owners[dst]].push_back (i);
+    const adi::LinkDatas& linkDatas = AccessManager::GetLinkDatas (accesses[i]);
+    horizon = std::max (horizon, ToTime (linkDatas[accesses[i].fsoStop].time) - Now ());
+  }
+  // the forecast reserves at the end of horizon
+  std::vector<double> reserves (m_stations.size ());
+  std::set<std::pair<double, uint32_t>> lowest;
+  for (uint32_t s = 0;s < m_stations.size ();++s)
+  {
+    double gap = QkdSatelliteList::GetKeyGap (m_stations[s]);
+    reserves[s] = -gap - GetConsumptionRate (m_stations[s]) * horizon.GetSeconds ();
+    lowest.emplace (reserves[s], s);
+  }
+  // the station with the lowest reserve takes its next best access
+  std::vector<uint32_t> next (m_stations.size (), 0);
+  double value = 0.0;
+  m_minReserve = 0.0;
+  while (!lowest.empty ())
+  {
+    uint32_t s = lowest.begin ()->second;
+    const std::vector<uint32_t>& passes = m_passes[s];
+    lowest.erase (lowest.begin ());
+    while (next[s] < passes.size ())
+    {
+      AccessManager::AccessData& access = accesses[passes[next[s]++]];
+      if (AccessManager::TryInsert (timelines, access))
+      {
+        access.selected = true;
+        value += access.wValue;
+        reserves[s] += access.value * m_keyPerValue;
+        break;
+      }
+    }
+    if (next[s] < passes.size ())
+    {
+      lowest.emplace (reserves[s], s);
+    }
+  }
+  if (!reserves.empty ())
+  {
+    m_minReserve = *std::min_element (reserves.begin (), reserves.end ());
+  }
+  NS_LOG_INFO ("lookahead " << horizon.As (Time::H) << " value: " << value << " minimum reserve: " << m_minReserve);
+  return value;
+}
+
+} // namespace ns3
@@ -0,0 +1,227 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#ifndef ACCESS_SCHEDULER_H
+#define ACCESS_SCHEDULER_H
+
+#include <functional>
+#include "ns3/object.h"
+#include "access-manager.h"
+
+namespace ns3 {
+
+/**
+ * \brief The base class of the schedulers which select the satellite-to-ground
+ *        accesses that the turntables can serve
+ */
+class AccessScheduler : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  AccessScheduler ();
+  virtual ~AccessScheduler ();
+
+  /**
+   * \brief Select the accesses and fill the timelines of turntables
+   * \param[in,out] accesses  the accesses sorted descending by weighted value,
+   *                          their selected flags are set
+   * \param[in,out] timelines the timelines holding the initial states of turntables
+   * \return the total weighted value of the selected accesses
+   */
+  virtual double Schedule (
+    AccessManager::AccessList& accesses,
+    AccessManager::TurntableStateList& timelines) = 0;
+protected:
+  /**
+   * \brief Try to insert the unselected accesses one by one in the given order
+   * \param[in,out] accesses  the accesses
+   * \param[in,out] timelines the timelines of turntables
+   * \return the total weighted value of all selected accesses
+   */
+  static double Fill (
+    AccessManager::AccessList& accesses,
+    AccessManager::TurntableStateList& timelines);
+};
+
+/**
+ * \brief Insert the accesses greedily by their weighted values, without backtracking
+ */
+class GreedyAccessScheduler : public AccessScheduler
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  GreedyAccessScheduler ();
+  virtual ~GreedyAccessScheduler ();
+
+  virtual double Schedule (
+    AccessManager::AccessList& accesses,
+    AccessManager::TurntableStateList& timelines);
+};
+
+/**
+ * \brief Select the accesses by weighted interval scheduling
+ *
+ * For each station turntable, the chain of accesses with the maximum total
+ * weighted value is found by dynamic programming, where two accesses can be
+ * chained if the turntable can swing from the end of the former to the start
+ * of the latter. The chains are inserted first, resolving the conflicts on
+ * the satellite turntables by value, then the rest accesses are inserted
+ * greedily. The greedy scheme is also calculated and kept if it is better,
+ * so the result is never worse than greedy.
+ */
+class IntervalAccessScheduler : public AccessScheduler
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  IntervalAccessScheduler ();
+  virtual ~IntervalAccessScheduler ();
+
+  virtual double Schedule (
+    AccessManager::AccessList& accesses,
+    AccessManager::TurntableStateList& timelines);
+
+  /**
+   * \return the total weighted value of the greedy scheme in last scheduling
+   */
+  double GetGreedyValue (void) const;
+
+  /**
+   * \return the total weighted value of the selected scheme in last scheduling
+   */
+  double GetValue (void) const;
+
+  /**
+   * \brief Find the chain of accesses of one turntable with the maximum total value
+   * \param[in] starts          the start times of accesses, the accesses are sorted ascending by stop
+   * \param[in] stops           the stop times of accesses
+   * \param[in] values          the values of accesses
+   * \param[in] isReachable     whether the turntable can swing from its initial state to an access
+   * \param[in] isChainable     whether the turntable can swing from the former access to the latter one
+   * \param[in] maxPredecessors the maximum latest predecessors considered for each access
+   * \return the indices of the chained accesses, descending
+   */
+  static std::vector<uint32_t> CalcChain (
+    const std::vector<adi::DateTime>& starts,
+    const std::vector<adi::DateTime>& stops,
+    const std::vector<double>& values,
+    const std::function<bool (uint32_t)>& isReachable,
+    const std::function<bool (uint32_t, uint32_t)>& isChainable,
+    uint32_t maxPredecessors);
+private:
+  /**
+   * \brief Find the chains of accesses with maximum value for each station turntable
+   * \param[in] accesses  the accesses
+   * \param[in] timelines the timelines holding the initial states of turntables
+   * \return whether each access is in the chains
+   */
+  std::vector<bool> CalcChains (
+    const AccessManager::AccessList& accesses,
+    AccessManager::TurntableStateList& timelines) const;
+
+  uint32_t  m_maxPredecessors;  //!< the maximum predecessors considered for each access
+  double    m_greedyValue;      //!< the value of greedy scheme in last scheduling
+  double    m_value;            //!< the value of selected scheme in last scheduling
+};
+
+/**
+ * \brief Select the accesses over a multi-day horizon to keep the minimum
+ *        key reserve of stations as high as possible
+ *
+ * The reserve of each station at the end of the horizon is forecast as the
+ * negative of its current key gap, less its key consumption over the
+ * horizon, plus the keys of its selected accesses. The station with the
+ * lowest reserve always takes its next best access the turntables can still
+ * serve, until no access is left, so each access is tried once and a week
+ * of passes is scheduled in O(n log n). It is meant for the rolling
+ * scheduling with a horizon of several days, see AdiHelper::SetS2GHorizon,
+ * whose rolls keep the passes and only evaluate the ones of the new windows.
+ *
+ * The value of an access sums 1/d^2 of its samples of one second, with the
+ * distance d in km, so the keys of an access are its value times the key
+ * rate of a link at 1 km. This conversion factor has no sensible default,
+ * it must be set by SetKeyPerValue or the attribute KeyPerValue.
+ */
+class LookaheadAccessScheduler : public AccessScheduler
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  LookaheadAccessScheduler ();
+  virtual ~LookaheadAccessScheduler ();
+
+  virtual double Schedule (
+    AccessManager::AccessList& accesses,
+    AccessManager::TurntableStateList& timelines);
+
+  /**
+   * \brief Set the forecast key consumption of a station
+   * \param[in] station  the station
+   * \param[in] rate     the consumption, in keys of the key gap per second
+   */
+  void SetConsumptionRate (Ptr<QkdStation> station, double rate);
+
+  /**
+   * \brief Get the forecast key consumption of a station
+   * \param[in] station  the station
+   * \return the consumption, the default one if the station is not set
+   */
+  double GetConsumptionRate (Ptr<QkdStation> station) const;
+
+  /**
+   * \brief Set the keys generated per value of access
+   * \param[in] keyPerValue the key rate of a link at 1 km, in keys of the key gap per second
+   */
+  void SetKeyPerValue (double keyPerValue);
+
+  /**
+   * \return the minimum forecast reserve of stations in last scheduling
+   */
+  double GetMinReserve (void) const;
+private:
+  double  m_consumptionRate;  //!< the default consumption of stations
+  double  m_keyPerValue;      //!< the keys generated per value of access
+  double  m_minReserve;       //!< the minimum reserve in last scheduling
+  std::map<Ptr<QkdStation>, double> m_consumptionRates; //!< the consumptions of stations
+  std::vector<std::vector<uint32_t>> m_passes;          //!< the accesses of the stations below, in the same order
+  std::vector<Ptr<QkdStation>> m_stations;              //!< the stations with accesses
+};
+
+} // namespace ns3
+
+#endif /* ACCESS_SCHEDULER_H */
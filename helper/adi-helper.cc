@@ -19,6 +19,7 @@
  */
 
 #include "ns3/simulator.h"
+#include "ns3/global-value.h"
 #include "ns3/assert.h"
 #include "ns3/node.h"
 #include "ns3/output-stream-wrapper.h"
@@ -34,6 +35,8 @@
 #include "ns3/space-point-to-point-channel.h"
 #include "ns3/space-point-to-point-net-device.h"
 #include "adi-helper.h"
+#include "link-data-stream.h"
+#include "stage-timer.h"
 #include "adi-constant.h"
 #include "adi-satellite-list.h"
 #include "adi-station-list.h"
@@ -50,13 +53,27 @@ SatelliteContainer  AdiHelper::m_satelliteContainer  = SatelliteContainer ();
 StationContainer    AdiHelper::m_stationContainer    = StationContainer ();
 LinkHelper          AdiHelper::m_accessHelper        = LinkHelper ();
 LinkInfoList        AdiHelper::m_accessDatas         = LinkInfoList ();
-std::map<AdiHelper::ISL, adi::LinkHelper>   AdiHelper::m_linkHelper = std::map<ISL, adi::LinkHelper> ();
-std::map<AdiHelper::ISL, adi::LinkInfoList> AdiHelper::m_linkDatas  = std::map<ISL, adi::LinkInfoList> ();
+LinkDataStream*     AdiHelper::m_s2gStream           = NULL;
+LinkHelper          AdiHelper::m_islHelper           = LinkHelper ();
+std::map<AdiHelper::ISL, adi::DateTime>     AdiHelper::m_islResumes = std::map<ISL, adi::DateTime> ();
 AdiHelper::TurntableMapFromAdiToNs3 AdiHelper::m_turntableMaps = TurntableMapFromAdiToNs3 ();
 AdiHelper::ISLs AdiHelper::m_ISLs = ISLs ();
 // AdiHelper::QkdWorkingList AdiHelper::m_qkdWorkingList = QkdWorkingList ();
 AdiHelper::ScheduleOfISLList AdiHelper::m_scheduleOfISLList = ScheduleOfISLList ();
 
+static GlobalValue g_s2gHorizon (
+  "S2GHorizon",
+  "The horizon of satellite-to-ground scheduling",
+  TimeValue (Days (1.0)),
+  MakeTimeChecker ());
+
+static GlobalValue g_s2gCommitWindow (
+  "S2GCommitWindow",
+  "The commit window of satellite-to-ground scheduling, "
+  "the scheduling is rolling if it is shorter than the horizon",
+  TimeValue (Days (1.0)),
+  MakeTimeChecker ());
+
 AdiHelper::AdiHelper ()
 {
 }
@@ -181,7 +198,7 @@ AdiHelper::RegisterISL (Ptr<QkdDevice> qkdTx, Ptr<QkdDevice> qkdRx)
   || (txFace == Left && rxFace == Right)
   || (txFace == Right && rxFace == Left))
   {
-    m_linkHelper[isl].AddLink (
+    m_islHelper.AddLink (
       Link (
         _src_,
         _dst_,
@@ -192,33 +209,59 @@ AdiHelper::RegisterISL (Ptr<QkdDevice> qkdTx, Ptr<QkdDevice> qkdRx)
   }
 }
 
+void
+AdiHelper::SetS2GHorizon (const Time& horizon, const Time& commit)
+{
+  NS_ASSERT (commit.IsStrictlyPositive ());
+  g_s2gHorizon.SetValue (TimeValue (horizon));
+  g_s2gCommitWindow.SetValue (TimeValue (commit));
+}
+
 void
 AdiHelper::Update ()
 {
-  DoUpdateS2G ();
-  if (EnableISL)
+  TimeValue horizon, commit;
+  g_s2gHorizon.GetValue (horizon);
+  g_s2gCommitWindow.GetValue (commit);
+  if (commit.Get () < horizon.Get ())
   {
-    for (uint32_t i = 0;i < m_ISLs.size ();++i)
-    {
-      DoUpdateISL (m_ISLs[i]);
-    }
+    DoDisposeS2G ();
+    Simulator::ScheduleDestroy (&AdiHelper::DoDisposeS2G);
+    DoRollS2G ();
+  }
+  else
+  {
+    DoUpdateS2G ();
+  }
+  if (EnableISL && !m_ISLs.empty ())
+  {
+    DoUpdateISL ();
   }
 }
 
 void
 AdiHelper::CreateS2GChannel (const AccessManager::AccessData& access)
 {
-  NS_ASSERT (access.src);
-  NS_ASSERT (access.dst);
+  adi::LinkDatas::const_iterator begin = AccessManager::GetLinkDatas (access).cbegin ();
+  adi::LinkDatas netLinkDatas {begin + access.netStart, begin + access.netStop};
+  adi::LinkDatas fsoLinkDatas {begin + access.fsoStart, begin + access.fsoStop};
+  DoCreateS2GChannel (access.src, access.dst, netLinkDatas, fsoLinkDatas);
+}
+
+void
+AdiHelper::DoCreateS2GChannel (uint32_t src, uint32_t dst, const adi::LinkDatas& netLinkDatas, const adi::LinkDatas& fsoLinkDatas)
+{
+  Ptr<Turntable> srcTurntable = AccessManager::GetTurntable (src);
+  Ptr<Turntable> dstTurntable = AccessManager::GetTurntable (dst);
+  NS_ASSERT (srcTurntable);
+  NS_ASSERT (dstTurntable);
   Ptr<SpacePointToPointChannel> netChannel = CreateObject<SpacePointToPointChannel> ();
-  Ptr<NetDevice> netTx = access.src->GetFsoDevice ()->GetNetDevice ();
-  Ptr<NetDevice> netRx = access.dst->GetFsoDevice ()->GetNetDevice ();
-  adi::LinkDatas netLinkDatas {access.netStart, access.netStop};
+  Ptr<NetDevice> netTx = srcTurntable->GetFsoDevice ()->GetNetDevice ();
+  Ptr<NetDevice> netRx = dstTurntable->GetFsoDevice ()->GetNetDevice ();
   netChannel->Attach (netTx, netRx, netLinkDatas);
   Ptr<FsoChannel> fsoChannel = CreateObject<FsoChannel> ();
-  Ptr<FsoDevice> fsoTx = access.src->GetFsoDevice ();
-  Ptr<FsoDevice> fsoRx = access.dst->GetFsoDevice ();
-  adi::LinkDatas fsoLinkDatas {access.fsoStart, access.fsoStop};
+  Ptr<FsoDevice> fsoTx = srcTurntable->GetFsoDevice ();
+  Ptr<FsoDevice> fsoRx = dstTurntable->GetFsoDevice ();
   fsoChannel->Attach (fsoTx, fsoRx, fsoLinkDatas);
   fsoChannel->AggregateObject (netChannel);
 }
@@ -246,26 +289,26 @@ AdiHelper::CreateISLChannel (const adi::LinkInfo& link)
 void
 AdiHelper::DoUpdateS2G ()
 {
-  Time now = Now ();
   // calculate the new link datas by adi
   // the interval to be calculated
   static adi::DateTime simStart = SimulationStart;
   static adi::DateTime simStop = SimulationStart + Day;
   Interval simInterval (simStart, simStop);
-  adi::LinkInfoList tmpLinkInfoList;
   if (EnableS2G)
   {
-    m_accessHelper.SetInterval (simInterval);
-    m_accessDatas = m_accessHelper.CalcLink ();
-    // find the access as net access that both in fov and both in shadow
-    std::vector<bool> selected = DoFindLinkData (m_accessDatas, SRC2DST | DST2SRC, DST_DAY | BEYOND_DISTANCE);
-    AccessManager::AccessList& access = AccessManager::SelectTasks (m_accessDatas, selected);
+    // the windows are streamed hour by hour into the accesses,
+    // so the link datas of the unsatisfied windows are never held for the whole day
+    m_accessDatas.clear ();
+    AccessManager::ClearTasks (m_accessDatas);
+    LinkDataStream stream (m_accessHelper, simInterval, Hour);
+    DoAddAccessDatas (stream);
+    AccessManager::AccessList& access = AccessManager::ScheduleTasks (Time::Max ());
     for (uint32_t i = 0;i < access.size ();++i)
     {
       if (access[i].selected)
       {
         // Create the net and fso channels after link available
-        Time start = ToTime (access[i].netStart->time);
+        Time start = ToTime (AccessManager::GetLinkDatas (access[i])[access[i].netStart].time);
         Time delay = start - Now ();
         Simulator::Schedule (delay, &CreateS2GChannel, access[i]);
       }
@@ -278,47 +321,157 @@ AdiHelper::DoUpdateS2G ()
 }
 
 void
-AdiHelper::DoUpdateISL (ISL& isl)
+AdiHelper::DoRollS2G ()
+{
+  TimeValue horizon, commit;
+  g_s2gHorizon.GetValue (horizon);
+  g_s2gCommitWindow.GetValue (commit);
+  if (EnableS2G)
+  {
+    DateTime start = ToTime (Now ());
+    DateTime stop = start + TimeSpan (horizon.Get ().GetMicroSeconds ());
+    // the stream goes on from the end of last horizon, the windows open at
+    // the end of horizon are held until they are closed in a later roll
+    if (m_s2gStream == NULL)
+    {
+      m_s2gStream = new LinkDataStream (m_accessHelper, Interval (start, stop), Hour, true);
+    }
+    m_s2gStream->Extend (stop);
+    // the committed tasks of turntables and the accesses left to this roll are kept,
+    // only the accesses of the new windows are added, and the accesses
+    // starting in the commit window are committed this time
+    AccessManager::RollTasks (m_accessDatas);
+    DoAddAccessDatas (*m_s2gStream);
+    AccessManager::AccessList& access = AccessManager::ScheduleTasks (Now () + commit.Get ());
+    for (uint32_t i = 0;i < access.size ();++i)
+    {
+      if (access[i].selected)
+      {
+        // the link datas are copied since the link informations are compacted by the next roll
+        const adi::LinkDatas& linkDatas = AccessManager::GetLinkDatas (access[i]);
+        adi::LinkDatas netLinkDatas {linkDatas.begin () + access[i].netStart, linkDatas.begin () + access[i].netStop};
+        adi::LinkDatas fsoLinkDatas {linkDatas.begin () + access[i].fsoStart, linkDatas.begin () + access[i].fsoStop};
+        Time delay = ToTime (netLinkDatas.front ().time) - Now ();
+        NS_ASSERT (!delay.IsStrictlyNegative ());
+        Simulator::Schedule (delay, &AdiHelper::DoCreateS2GChannel, access[i].src, access[i].dst, netLinkDatas, fsoLinkDatas);
+      }
+    }
+  }
+  Simulator::Schedule (commit.Get (), &AdiHelper::DoRollS2G);
+}
+
+void
+AdiHelper::DoDisposeS2G ()
+{
+  delete m_s2gStream;
+  m_s2gStream = NULL;
+  m_accessDatas.clear ();
+  AccessManager::ClearTasks (m_accessDatas);
+}
+
+void
+AdiHelper::DoAddAccessDatas (LinkDataStream& stream)
+{
+  LinkInfoList windows;
+  uint64_t nWindows = 0;
+  while (true)
+  {
+    {
+      StageTimer::Scope scope ("CalcLink");
+      if (!stream.Next (windows))
+      {
+        break;
+      }
+    }
+    // find the access as net access that both in fov and both in shadow
+    std::vector<bool> selected;
+    {
+      StageTimer::Scope scope ("DoFindLinkData");
+      selected = DoFindLinkData (windows, SRC2DST | DST2SRC, DST_DAY | BEYOND_DISTANCE);
+    }
+    nWindows += windows.size ();
+    // only the satisfied windows are kept, their accesses are evaluated right away
+    uint32_t first = m_accessDatas.size ();
+    for (uint32_t i = 0;i < windows.size ();++i)
+    {
+      if (selected[i])
+      {
+        m_accessDatas.push_back (adi::LinkInfo ());
+        m_accessDatas.back ().src = windows[i].src;
+        m_accessDatas.back ().dst = windows[i].dst;
+        m_accessDatas.back ().linkDatas.swap (windows[i].linkDatas);
+      }
+    }
+    AccessManager::AddAccessData (m_accessDatas, first, std::vector<bool> (m_accessDatas.size () - first, true));
+  }
+  StageTimer::Count ("linkInfos", nWindows);
+}
+
+void
+AdiHelper::DoUpdateISL ()
 {
-  Ptr<Turntable> src = isl.first;
-  Ptr<Turntable> dst = isl.second;
-  LinkHelper& linkHelper = m_linkHelper[isl];
-  LinkInfoList& linkInfoList = m_linkDatas[isl];
   DateTime simStart = ToTime (Now ());
   DateTime simStop = ToTime (Now ()) + Day;
-  linkHelper.SetInterval (Interval (simStart, simStop));
-  linkInfoList = linkHelper.CalcLink ();
-  // std::vector<bool> selected = std::vector<bool> (linkInfoList.size (), true);
-  if (linkInfoList.back ().linkDatas.back ().time == simStop)
+  // every inter-satellite link resumes from the start of its window still open at the end of day
+  std::map<ISL, DateTime> resumes;
+  for (const ISL& isl : m_ISLs)
   {
-    linkInfoList.pop_back ();
+    resumes[isl] = simStop;
   }
-  simStop = linkInfoList.back ().linkDatas.back ().time + Second;
-  for (LinkInfoList::const_iterator it = linkInfoList.cbegin ();it != linkInfoList.cend ();++it)
+  LinkDataStream stream (m_islHelper, Interval (simStart, simStop), Hour);
+  LinkInfoList linkInfoList;
+  while (stream.Next (linkInfoList))
   {
-    Time start = ToTime (it->linkDatas.front ().time);
-    Time stop  = ToTime (it->linkDatas.back ().time);
-    Time delay = stop - Now ();
-    Simulator::Schedule (start - Now (), &CreateISLChannel, *it);
-    Simulator::Schedule (
-      delay,
-      &Turntable::SetTargetPointing,
-      src,
-      start,
-      it->linkDatas.front ().fromSrc
-    );
-    Simulator::Schedule (
-      delay,
-      &Turntable::SetTargetPointing,
-      dst,
-      start,
-      it->linkDatas.front ().fromDst
-    );
+    for (LinkInfoList::const_iterator it = linkInfoList.cbegin ();it != linkInfoList.cend ();++it)
+    {
+      Ptr<Turntable> src = Ptr<Turntable> ((Turntable*) it->src->GetNs3 ());
+      Ptr<Turntable> dst = Ptr<Turntable> ((Turntable*) it->dst->GetNs3 ());
+      ISL isl = std::make_pair (src, dst);
+      if (it->linkDatas.back ().time == simStop)
+      {
+        resumes[isl] = it->linkDatas.front ().time;
+        continue;
+      }
+      std::map<ISL, DateTime>::const_iterator resume = m_islResumes.find (isl);
+      if (resume != m_islResumes.end () && it->linkDatas.front ().time < resume->second)
+      {
+        // it has been scheduled by the last update
+        continue;
+      }
+      Time start = ToTime (it->linkDatas.front ().time);
+      Time stop  = ToTime (it->linkDatas.back ().time);
+      Time delay = stop - Now ();
+      Simulator::Schedule (start - Now (), &CreateISLChannel, *it);
+      Simulator::Schedule (
+        delay,
+        &Turntable::SetTargetPointing,
+        src,
+        start,
+        it->linkDatas.front ().fromSrc
+      );
+      Simulator::Schedule (
+        delay,
+        &Turntable::SetTargetPointing,
+        dst,
+        start,
+        it->linkDatas.front ().fromDst
+      );
+    }
+  }
+  DateTime next = simStop;
+  for (std::map<ISL, DateTime>::const_iterator it = resumes.cbegin ();it != resumes.cend ();++it)
+  {
+    next = std::min (next, it->second);
+  }
+  if (next <= simStart)
+  {
+    NS_LOG_WARN ("The window of an inter-satellite link is longer than a day");
+    next = simStop;
   }
+  m_islResumes.swap (resumes);
   Simulator::Schedule (
-    ToTime (simStop) - Now (),
-    &AdiHelper::DoUpdateISL,
-    isl
+    ToTime (next) - Now (),
+    &AdiHelper::DoUpdateISL
   );
 }
 
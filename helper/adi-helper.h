@@ -41,6 +41,7 @@ class SpacePointToPointChannel;
 class QkdSatellite;
 class QkdStation;
 class QkdDevice;
+class LinkDataStream;
 
 
 class AdiHelper
@@ -59,11 +60,51 @@ public:
   static void RegisterISL (QkdDeviceContainer qkdTxs, QkdDeviceContainer qkdRxs);
   static void RegisterISL (Ptr<QkdDevice> qkdTx, Ptr<QkdDevice> qkdRx);
   static void Update ();
+  /**
+   * \brief Set the rolling horizon of satellite-to-ground scheduling,
+   * the accesses in the horizon are selected every commit window, and only
+   * the ones starting in the commit window are committed. If the commit window
+   * is not shorter than the horizon, the accesses of each day are selected
+   * from scratch once a day.
+   * \param[in] horizon the horizon
+   * \param[in] commit  the commit window
+   */
+  static void SetS2GHorizon (const Time& horizon, const Time& commit);
 private:
   static void CreateS2GChannel (const AccessManager::AccessData& access);
+  /**
+   * \brief Create the net and fso channels between the turntables
+   * \param[in] src          the id of source turntable
+   * \param[in] dst          the id of destination turntable
+   * \param[in] netLinkDatas the link datas of net link
+   * \param[in] fsoLinkDatas the link datas of fso link
+   */
+  static void DoCreateS2GChannel (uint32_t src, uint32_t dst, const adi::LinkDatas& netLinkDatas, const adi::LinkDatas& fsoLinkDatas);
   static void CreateISLChannel (const adi::LinkInfo& link);
   static void DoUpdateS2G ();
-  static void DoUpdateISL (ISL& isl);
+  /**
+   * \brief Select the satellite-to-ground accesses in the rolling horizon from now,
+   * and schedule the channels of the accesses committed in the commit window.
+   * The windows and accesses of the last roll are kept, only the windows from the
+   * end of the last horizon to the end of this one are calculated
+   */
+  static void DoRollS2G ();
+  /**
+   * \brief Release the stream and the access datas of the rolling horizon,
+   * so that the next scenario starts the rolls from scratch
+   */
+  static void DoDisposeS2G ();
+  /**
+   * \brief Pull the windows from the stream chunk by chunk, append the satisfied ones
+   * to the access datas and evaluate their accesses
+   * \param[in] stream the stream of satellite-to-ground windows
+   */
+  static void DoAddAccessDatas (LinkDataStream& stream);
+  /**
+   * \brief Calculate all inter-satellite links of the next day in one pass,
+   * and schedule the channels of the windows
+   */
+  static void DoUpdateISL ();
   /**
    * \brief Find the link data with given allowed state and forbidden state,
    * besides, the distance should be also less than maxDistance,
@@ -105,6 +146,7 @@ private:
   static adi::StationContainer    m_stationContainer;
   static adi::LinkHelper          m_accessHelper;
   static adi::LinkInfoList        m_accessDatas;
+  static LinkDataStream*          m_s2gStream;    //!< the stream of rolling horizon, created by the first roll
   static TurntableMapFromAdiToNs3 m_turntableMaps;
   struct ScheduleOfISL
   {
@@ -119,8 +161,8 @@ private:
   };
 
   static ISLs m_ISLs;
-  static std::map<ISL, adi::LinkHelper> m_linkHelper;
-  static std::map<ISL, adi::LinkInfoList> m_linkDatas;
+  static adi::LinkHelper m_islHelper;                 //!< the link helper of all inter-satellite links
+  static std::map<ISL, adi::DateTime> m_islResumes;   //!< the time from which the windows are not scheduled
   typedef std::map<ISL, std::vector<ScheduleOfISL>> ScheduleOfISLList;
   static ScheduleOfISLList m_scheduleOfISLList;
 };
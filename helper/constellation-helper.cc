@@ -18,10 +18,18 @@
  * Author: Wang Junyong (wangjunyong@microsate.com)
  */
 
+#include <fstream>
+#include "ns3/log.h"
 #include "constellation-helper.h"
+#include "adi-satellite.h"
+#ifdef ADI_CPU
+#include "adi-cpu-kernel.h"
+#endif
 
 namespace ns3 {
 
+NS_LOG_COMPONENT_DEFINE ("ConstellationHelper");
+
 uint32_t
 ConstellationHelper::GetPlanes (void) const
 {
@@ -77,4 +85,60 @@ ConstellationHelper::GetPlane (uint32_t plane) const
   }
 }
 
-}
\ No newline at end of file
+#ifdef ADI_CPU
+QkdSatelliteContainer
+ConstellationHelper::LoadTle (const std::string& filename)
+{
+  QkdSatelliteContainer c;
+  std::ifstream file (filename.c_str ());
+  if (!file)
+  {
+    NS_LOG_WARN ("Failed to open " << filename);
+    return c;
+  }
+  std::vector<adi::Tle> tles;
+  std::string title, line, last;
+  while (std::getline (file, line))
+  {
+    if (!line.empty () && line[line.size () - 1] == '\r')
+    {
+      line.erase (line.size () - 1);
+    }
+    if (line.compare (0, 2, "2 ") == 0 && last.compare (0, 2, "1 ") == 0)
+    {
+      adi::Tle tle;
+      adi::cpu::sgp4::Parameter param;
+      if (!adi::Tle::Parse (last, line, tle))
+      {
+        NS_LOG_WARN ("Invalid two-line element set " << title);
+      }
+      else if (!adi::cpu::sgp4::Initialize (param, tle))
+      {
+        NS_LOG_WARN ("The deep space orbit of " << title << " is not supported");
+      }
+      else
+      {
+        tle.name = title;
+        tles.push_back (tle);
+      }
+      title.clear ();
+    }
+    else if (line.compare (0, 2, "1 ") != 0)
+    {
+      title = line.compare (0, 2, "0 ") == 0 ? line.substr (2) : line;
+      title.erase (title.find_last_not_of (' ') + 1);
+    }
+    last = line;
+  }
+  c.Create (tles.size ());
+  for (uint32_t i = 0;i < tles.size ();++i)
+  {
+    c[i]->GetAdiSat ()->SetTle (tles[i]);
+  }
+  NS_LOG_INFO ("Loaded " << c.GetN () << " satellites from " << filename);
+  m_plane.push_back (c);
+  return c;
+}
+#endif
+
+}
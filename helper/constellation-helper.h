@@ -21,6 +21,7 @@
 #ifndef CONSTELLATION_HELPER_H
 #define CONSTELLATION_HELPER_H
 
+#include <string>
 #include "ns3/qkd-satellite-container.h"
 
 
@@ -40,6 +41,15 @@ public:
     uint32_t num, bool isDegree = true
   );
   QkdSatelliteContainer GetPlane (uint32_t plane) const;
+#ifdef ADI_CPU
+  /**
+   * \brief Create the satellites from a file of two-line element sets, the title lines are optional,
+   * the satellites are propagated with the SGP4 model and added as a plane
+   * \param[in] filename the name of file
+   * \return the satellites, the element sets that are invalid or need the deep space model are skipped
+   */
+  QkdSatelliteContainer LoadTle (const std::string& filename);
+#endif
 private:
   std::vector<QkdSatelliteContainer> m_plane;
 };
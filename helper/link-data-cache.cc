@@ -0,0 +1,406 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "link-data-cache.h"
+#include "adi-link.h"
+#include "adi-turntable.h"
+#include "adi-satellite.h"
+#include "adi-station.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LinkDataCache");
+
+namespace {
+
+const char     K_MAGIC[8] = {'Q', 'K', 'D', 'L', 'I', 'N', 'K', 'S'};
+const uint32_t K_VERSION  = 2;
+
+/**
+ * \brief The header of cache file, it is followed by the key, the info records
+ * and the data records, every part is aligned to 8 bytes
+ */
+struct FileHeader
+{
+  char      magic[8];
+  uint32_t  version;
+  uint32_t  keySize;
+  uint64_t  infoCount;
+  uint64_t  dataCount;
+};
+
+/**
+ * \brief The record of adi::LinkInfo, its datas are the next count data records
+ */
+struct InfoRecord
+{
+  uint32_t  link;     //!< the index of link in the link list of helper
+  uint32_t  reserved;
+  uint64_t  count;
+};
+
+/**
+ * \brief The record of adi::LinkData
+ */
+struct DataRecord
+{
+  int64_t   ticks;
+  double    fromSrc[4]; //!< azimuth, pitch, azimuth rate, pitch rate
+  double    fromDst[4];
+  double    distance;
+  uint8_t   state;
+  uint8_t   reserved[7];
+};
+
+size_t
+Align (size_t n)
+{
+  return (n + 7) & ~(size_t)7;
+}
+
+template<class T>
+void
+Put (std::vector<uint8_t>& key, const T& value)
+{
+  const uint8_t* p = reinterpret_cast<const uint8_t*> (&value);
+  key.insert (key.end (), p, p + sizeof (T));
+}
+
+void
+PutTurntable (std::vector<uint8_t>& key, adi::Turntable* turntable)
+{
+  const adi::PointingBound& bound = turntable->GetPointingBound ();
+  adi::Object* obj = turntable->GetObject ();
+  Put (key, (uint32_t)turntable->GetFace ());
+  Put (key, bound.azimuth.min);
+  Put (key, bound.azimuth.max);
+  Put (key, bound.pitch.min);
+  Put (key, bound.pitch.max);
+  Put (key, (uint32_t)obj->GetType ());
+  if (obj->GetType () == adi::Object::SATELLITE)
+  {
+    const adi::Satellite::Ele& ele = static_cast<adi::Satellite*> (obj)->GetElement ();
+    Put (key, ele.sma);
+    Put (key, ele.ecc);
+    Put (key, ele.inc);
+    Put (key, ele.raan);
+    Put (key, ele.aop);
+    Put (key, ele.ma);
+#ifdef ADI_CPU
+    // the satellites propagated with the SGP4 model are keyed by their element sets
+    const adi::Tle* tle = static_cast<adi::Satellite*> (obj)->GetTle ();
+    if (tle)
+    {
+      key.insert (key.end (), tle->line1.begin (), tle->line1.end ());
+      key.insert (key.end (), tle->line2.begin (), tle->line2.end ());
+    }
+#endif
+  }
+  else
+  {
+    const adi::Station::Ele& ele = static_cast<adi::Station*> (obj)->GetElement ();
+    Put (key, ele.alt);
+    Put (key, ele.lat);
+    Put (key, ele.lon);
+  }
+}
+
+void
+ToRecord (const adi::Pointing& p, double r[4])
+{
+  r[0] = p.angle.azimuth;
+  r[1] = p.angle.pitch;
+  r[2] = p.rate.azimuth;
+  r[3] = p.rate.pitch;
+}
+
+adi::Pointing
+FromRecord (const double r[4])
+{
+  return adi::Pointing {adi::Direction {r[0], r[1]}, adi::Direction {r[2], r[3]}};
+}
+
+/**
+ * \return the FNV-1a hash of key
+ */
+uint64_t
+Hash (const std::vector<uint8_t>& key)
+{
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0;i < key.size ();++i)
+  {
+    hash ^= key[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+} // namespace
+
+static GlobalValue g_linkDataCacheDirectory (
+  "LinkDataCacheDirectory",
+  "The directory of the link data cache files, the cache is disabled if it is empty",
+  StringValue (""),
+  MakeStringChecker ());
+
+void
+LinkDataCache::SetDirectory (const std::string& dir)
+{
+  g_linkDataCacheDirectory.SetValue (StringValue (dir));
+}
+
+std::string
+LinkDataCache::GetDirectory (void)
+{
+  StringValue dir;
+  g_linkDataCacheDirectory.GetValue (dir);
+  return dir.Get ();
+}
+
+LinkDataCache::Key
+LinkDataCache::MakeKey (const adi::LinkHelper& helper)
+{
+  Key key;
+  Put (key, K_VERSION);
+#ifdef ADI_CPU
+  // the backends do not agree to the last bit
+  Put (key, (uint8_t)1);
+#else
+  Put (key, (uint8_t)0);
+#endif
+  const adi::Intervals& intervals = helper.GetIntervalList ();
+  Put (key, (uint64_t)intervals.size ());
+  for (const adi::Interval& interval : intervals)
+  {
+    Put (key, interval.GetStart ().Ticks ());
+    Put (key, interval.GetStop ().Ticks ());
+  }
+  const adi::Links& links = helper.GetLinkList ();
+  Put (key, (uint64_t)links.size ());
+  for (adi::Link link : links)
+  {
+    Put (key, link.GetEpoch ().Ticks ());
+    Put (key, link.GetStep ().Ticks ());
+    Put (key, link.GetMaxDistance ());
+    Put (key, link.GetIncludedState ());
+    Put (key, link.GetExcludedState ());
+    PutTurntable (key, link.GetTurntable (0));
+    PutTurntable (key, link.GetTurntable (1));
+  }
+  return key;
+}
+
+std::string
+LinkDataCache::GetPath (const adi::LinkHelper& helper)
+{
+  std::string dir = GetDirectory ();
+  if (dir.empty ())
+  {
+    return "";
+  }
+  char name[32];
+  snprintf (name, sizeof (name), "%016llx.links", (unsigned long long)Hash (MakeKey (helper)));
+  return dir + "/" + name;
+}
+
+adi::LinkInfoList
+LinkDataCache::CalcLink (adi::LinkHelper& helper)
+{
+  std::string path = GetPath (helper);
+  if (path.empty ())
+  {
+    return helper.CalcLink ();
+  }
+  Key key = MakeKey (helper);
+  adi::LinkInfoList datas;
+  if (Load (path, key, helper.GetLinkList (), datas))
+  {
+    NS_LOG_INFO ("Load link datas from " << path);
+    return datas;
+  }
+  datas = helper.CalcLink ();
+  if (Store (path, key, helper.GetLinkList (), datas))
+  {
+    NS_LOG_INFO ("Store link datas into " << path);
+  }
+  else
+  {
+    NS_LOG_WARN ("Failed to store link datas into " << path);
+  }
+  return datas;
+}
+
+bool
+LinkDataCache::Load (
+  const std::string&    path,
+  const Key&            key,
+  const adi::Links&     links,
+  adi::LinkInfoList&    datas)
+{
+  int fd = open (path.c_str (), O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+  struct stat st;
+  if (fstat (fd, &st) != 0 || (size_t)st.st_size < sizeof (FileHeader))
+  {
+    close (fd);
+    return false;
+  }
+  size_t size = st.st_size;
+  void* map = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+  {
+    return false;
+  }
+  const uint8_t* base = static_cast<const uint8_t*> (map);
+  const FileHeader* header = reinterpret_cast<const FileHeader*> (base);
+  // the counts are checked against the file size before any offset is derived
+  // from them, so a truncated or corrupted file can not overflow the offsets
+  size_t keyOffset = sizeof (FileHeader);
+  bool valid = memcmp (header->magic, K_MAGIC, sizeof (K_MAGIC)) == 0
+    && header->version == K_VERSION
+    && header->keySize == key.size ()
+    && Align (header->keySize) <= size - keyOffset
+    && memcmp (base + keyOffset, key.data (), key.size ()) == 0;
+  size_t infoOffset = valid ? keyOffset + Align (header->keySize) : size;
+  valid = valid && header->infoCount <= (size - infoOffset) / sizeof (InfoRecord);
+  size_t dataOffset = valid ? infoOffset + header->infoCount * sizeof (InfoRecord) : size;
+  valid = valid && header->dataCount <= (size - dataOffset) / sizeof (DataRecord)
+    && dataOffset + header->dataCount * sizeof (DataRecord) == size;
+  if (valid)
+  {
+    const InfoRecord* infos = reinterpret_cast<const InfoRecord*> (base + infoOffset);
+    const DataRecord* records = reinterpret_cast<const DataRecord*> (base + dataOffset);
+    uint64_t total = 0;
+    for (uint64_t i = 0;i < header->infoCount && valid;++i)
+    {
+      valid = infos[i].link < links.size () && infos[i].count <= header->dataCount - total;
+      total += infos[i].count;
+    }
+    valid = valid && total == header->dataCount;
+    datas.clear ();
+    datas.reserve (header->infoCount);
+    for (uint64_t i = 0;i < header->infoCount && valid;++i)
+    {
+      adi::Link link = links[infos[i].link];
+      adi::LinkInfo info {link.GetTurntable (0), link.GetTurntable (1), adi::LinkDatas ()};
+      info.linkDatas.reserve (infos[i].count);
+      for (uint64_t j = 0;j < infos[i].count;++j, ++records)
+      {
+        info.linkDatas.push_back (adi::LinkData {
+          records->state,
+          adi::DateTime (records->ticks),
+          FromRecord (records->fromSrc),
+          FromRecord (records->fromDst),
+          records->distance});
+      }
+      datas.push_back (info);
+    }
+  }
+  munmap (map, size);
+  return valid;
+}
+
+bool
+LinkDataCache::Store (
+  const std::string&        path,
+  const Key&                key,
+  const adi::Links&         links,
+  const adi::LinkInfoList&  datas)
+{
+  // the index of the first link of each pair of turntables
+  typedef std::pair<adi::Turntable*, adi::Turntable*> LinkKey;
+  std::map<LinkKey, uint32_t> index;
+  for (uint32_t i = 0;i < links.size ();++i)
+  {
+    adi::Link link = links[i];
+    index.emplace (LinkKey (link.GetTurntable (0), link.GetTurntable (1)), i);
+  }
+  std::vector<InfoRecord> infos;
+  uint64_t dataCount = 0;
+  for (const adi::LinkInfo& info : datas)
+  {
+    std::map<LinkKey, uint32_t>::const_iterator it = index.find (LinkKey (info.src, info.dst));
+    if (it == index.end ())
+    {
+      return false;
+    }
+    InfoRecord record = {it->second, 0, info.linkDatas.size ()};
+    infos.push_back (record);
+    dataCount += record.count;
+  }
+  FileHeader header;
+  memcpy (header.magic, K_MAGIC, sizeof (K_MAGIC));
+  header.version = K_VERSION;
+  header.keySize = key.size ();
+  header.infoCount = infos.size ();
+  header.dataCount = dataCount;
+  // write to a temporary file first, so a concurrent run never maps a partial file
+  std::string tmp = path + ".tmp" + std::to_string (getpid ());
+  FILE* file = fopen (tmp.c_str (), "wb");
+  if (file == NULL)
+  {
+    return false;
+  }
+  const char padding[8] = {0};
+  bool ok = fwrite (&header, sizeof (header), 1, file) == 1;
+  ok = ok && fwrite (key.data (), 1, key.size (), file) == key.size ();
+  ok = ok && fwrite (padding, 1, Align (key.size ()) - key.size (), file) == Align (key.size ()) - key.size ();
+  ok = ok && (infos.empty () || fwrite (infos.data (), sizeof (InfoRecord), infos.size (), file) == infos.size ());
+  for (const adi::LinkInfo& info : datas)
+  {
+    for (const adi::LinkData& data : info.linkDatas)
+    {
+      DataRecord record;
+      memset (&record, 0, sizeof (record));
+      record.ticks = data.time.Ticks ();
+      ToRecord (data.fromSrc, record.fromSrc);
+      ToRecord (data.fromDst, record.fromDst);
+      record.distance = data.distance;
+      record.state = data.state;
+      ok = ok && fwrite (&record, sizeof (record), 1, file) == 1;
+    }
+  }
+  ok = (fclose (file) == 0) && ok;
+  if (ok)
+  {
+    ok = rename (tmp.c_str (), path.c_str ()) == 0;
+  }
+  if (!ok)
+  {
+    remove (tmp.c_str ());
+  }
+  return ok;
+}
+
+}
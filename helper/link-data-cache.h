@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#ifndef LINK_DATA_CACHE_H
+#define LINK_DATA_CACHE_H
+
+#include <string>
+#include <vector>
+#include "adi-link-helper.h"
+#include "adi-type-define.h"
+
+namespace ns3 {
+
+/**
+ * \brief The on-disk store of link datas calculated by adi::LinkHelper.
+ *
+ * A file is keyed by the elements of the satellites, the coordinates of the
+ * stations, the faces and bounds of the turntables, the states, epoch, step and
+ * intervals of the links, so a repeated run with the same geometry maps the
+ * file instead of propagating the orbits again.
+ */
+class LinkDataCache
+{
+public:
+  /**
+   * \brief Set the directory of the cache files, the cache is disabled if it is empty.
+   * It is the global value "LinkDataCacheDirectory", so it can also be set by
+   * NS_GLOBAL_VALUE or the command line.
+   * \param[in] dir the directory, it must exist
+   */
+  static void SetDirectory (const std::string& dir);
+
+  /**
+   * \return the directory of the cache files
+   */
+  static std::string GetDirectory (void);
+
+  /**
+   * \brief Get the link datas of the helper, they are loaded from the cache
+   * if the cache has been built by the same geometry, otherwise they are
+   * calculated by the helper and stored into the cache
+   * \param[in] helper the link helper with the links and interval list
+   * \return the link datas
+   */
+  static adi::LinkInfoList CalcLink (adi::LinkHelper& helper);
+
+  /**
+   * \brief Get the path of the cache file of the helper
+   * \param[in] helper the link helper
+   * \return the path of the file, empty if the cache is disabled
+   */
+  static std::string GetPath (const adi::LinkHelper& helper);
+private:
+  typedef std::vector<uint8_t> Key;
+
+  /**
+   * \brief Serialize everything that the link datas depend on
+   * \param[in] helper the link helper
+   * \return the key
+   */
+  static Key MakeKey (const adi::LinkHelper& helper);
+
+  /**
+   * \brief Load the link datas from the file
+   * \param[in]   path  the path of file
+   * \param[in]   key   the key that the file must be built by
+   * \param[in]   links the link list which the link datas belong to
+   * \param[out]  datas the link datas
+   * \return true if loaded
+   */
+  static bool Load (
+    const std::string&    path,
+    const Key&            key,
+    const adi::Links&     links,
+    adi::LinkInfoList&    datas);
+
+  /**
+   * \brief Store the link datas into the file
+   * \param[in] path  the path of file
+   * \param[in] key   the key
+   * \param[in] links the link list which the link datas belong to
+   * \param[in] datas the link datas
+   * \return true if stored
+   */
+  static bool Store (
+    const std::string&        path,
+    const Key&                key,
+    const adi::Links&         links,
+    const adi::LinkInfoList&  datas);
+};
+
+}
+
+#endif /* LINK_DATA_CACHE_H */
@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "link-data-stream.h"
+#include "link-data-cache.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LinkDataStream");
+
+namespace {
+
+bool
+IsEarlier (const adi::LinkInfo& a, const adi::LinkInfo& b)
+{
+  return a.linkDatas.front ().time < b.linkDatas.front ().time;
+}
+
+} // namespace
+
+LinkDataStream::LinkDataStream (adi::LinkHelper& helper, const adi::Interval& interval, const adi::TimeSpan& chunk, bool isExtensible)
+: m_helper  (helper)
+, m_time    (interval.GetStart ())
+, m_stop    (interval.GetStop ())
+, m_chunk   (chunk)
+, m_done    (false)
+, m_isExtensible (isExtensible)
+{
+  NS_ASSERT (chunk.Ticks () > 0);
+}
+
+LinkDataStream::~LinkDataStream ()
+{
+}
+
+bool
+LinkDataStream::Next (adi::LinkInfoList& windows)
+{
+  windows.clear ();
+  if (m_done)
+  {
+    return false;
+  }
+  adi::DateTime start = m_time;
+  adi::DateTime stop = std::min (m_time + m_chunk, m_stop);
+  m_helper.SetInterval (adi::Interval (start, stop));
+  adi::LinkInfoList chunk = LinkDataCache::CalcLink (m_helper);
+  NS_LOG_INFO ("Calculate " << chunk.size () << " windows in [" << start << ", " << stop << "]");
+  std::map<LinkKey, adi::LinkInfo> open;
+  for (adi::LinkInfo& info : chunk)
+  {
+    LinkKey key (info.src, info.dst);
+    std::map<LinkKey, adi::LinkInfo>::iterator it = m_open.find (key);
+    if (it != m_open.end () && info.linkDatas.front ().time == start)
+    {
+      // the first data is the same time as the last data of the open window
+      adi::LinkDatas& datas = it->second.linkDatas;
+      datas.insert (datas.end (), info.linkDatas.begin () + 1, info.linkDatas.end ());
+      info.linkDatas.swap (datas);
+      m_open.erase (it);
+    }
+    if (info.linkDatas.back ().time == stop && (stop < m_stop || m_isExtensible))
+    {
+      open[key].src = info.src;
+      open[key].dst = info.dst;
+      open[key].linkDatas.swap (info.linkDatas);
+    }
+    else
+    {
+      windows.push_back (adi::LinkInfo ());
+      windows.back ().src = info.src;
+      windows.back ().dst = info.dst;
+      windows.back ().linkDatas.swap (info.linkDatas);
+    }
+  }
+  // the open windows that are not continued in this chunk are closed at its start
+  for (std::map<LinkKey, adi::LinkInfo>::iterator it = m_open.begin ();it != m_open.end ();++it)
+  {
+    windows.push_back (it->second);
+  }
+  m_open.swap (open);
+  std::stable_sort (windows.begin (), windows.end (), IsEarlier);
+  m_time = stop;
+  m_done = stop >= m_stop;
+  return true;
+}
+
+void
+LinkDataStream::Extend (const adi::DateTime& stop)
+{
+  NS_ASSERT (m_isExtensible);
+  NS_ASSERT (stop >= m_stop);
+  m_stop = stop;
+  m_done = m_time >= m_stop;
+}
+
+}
@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#ifndef LINK_DATA_STREAM_H
+#define LINK_DATA_STREAM_H
+
+#include <map>
+#include "adi-link-helper.h"
+#include "adi-type-define.h"
+
+namespace ns3 {
+
+/**
+ * \brief The stream of link windows calculated chunk by chunk.
+ *
+ * The interval is split into chunks and the link helper is run on one chunk
+ * at a time, so only the windows of one chunk and the windows still open at
+ * its end are kept in memory. The windows crossing a chunk boundary are
+ * stitched together, a window is yielded once it is closed.
+ */
+class LinkDataStream
+{
+public:
+  /**
+   * \brief Constructor
+   * \param[in] helper    the link helper with the links to be calculated
+   * \param[in] interval  the interval to be calculated
+   * \param[in] chunk     the length of chunk
+   * \param[in] isExtensible whether the stream may be extended, the windows
+   *            open at the stop are held until it is extended then
+   */
+  LinkDataStream (adi::LinkHelper& helper, const adi::Interval& interval, const adi::TimeSpan& chunk, bool isExtensible = false);
+
+  /**
+   * \brief Deconstructor
+   */
+  ~LinkDataStream ();
+
+  /**
+   * \brief Calculate the next chunk
+   * \param[out] windows the windows closed in this chunk, ordered by their start
+   * \return false if the whole interval has been calculated, the windows are empty then
+   */
+  bool Next (adi::LinkInfoList& windows);
+
+  /**
+   * \brief Extend the stop of an extensible stream, the chunks after the former
+   * stop are calculated by the following calls of Next
+   * \param[in] stop the new stop, not earlier than the former one
+   */
+  void Extend (const adi::DateTime& stop);
+private:
+  typedef std::pair<adi::Turntable*, adi::Turntable*> LinkKey;
+  adi::LinkHelper&                  m_helper;   //!< the link helper
+  adi::DateTime                     m_time;     //!< the start of next chunk
+  adi::DateTime                     m_stop;     //!< the stop of interval
+  adi::TimeSpan                     m_chunk;    //!< the length of chunk
+  bool                              m_done;     //!< whether the whole interval has been calculated
+  bool                              m_isExtensible; //!< whether the windows open at the stop are held
+  std::map<LinkKey, adi::LinkInfo>  m_open;     //!< the windows open at the end of last chunk
+};
+
+}
+
+#endif /* LINK_DATA_STREAM_H */
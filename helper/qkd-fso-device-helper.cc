@@ -21,6 +21,7 @@
 #include "qkd-fso-device-helper.h"
 #include "ns3/fso-tx-device.h"
 #include "ns3/fso-rx-device.h"
+#include "ns3/fso-atmosphere-model.h"
 
 namespace ns3 {
 
@@ -29,6 +30,7 @@ QkdFsoDeviceHelper::QkdFsoDeviceHelper ()
   m_txDeviceFactory.SetTypeId ("ns3::FsoTxDevice");
   m_rxDeviceFactory.SetTypeId ("ns3::FsoRxDevice");
   m_turntableFactory.SetTypeId ("ns3::Turntable");
+  m_atmosphereFactory.SetTypeId ("ns3::FsoAtmosphereModel");
 }
 
 QkdFsoDeviceHelper::~QkdFsoDeviceHelper ()
@@ -53,6 +55,21 @@ QkdFsoDeviceHelper::SetTurntableAttribute (std::string name, const AttributeValu
   m_turntableFactory.Set (name, value);
 }
 
+void
+QkdFsoDeviceHelper::SetAtmosphereAttribute (std::string name, const AttributeValue &value)
+{
+  m_atmosphereFactory.Set (name, value);
+}
+
+void
+QkdFsoDeviceHelper::InstallAtmosphere (FsoDeviceContainer fsoDevices)
+{
+  for (size_t i = 0;i < fsoDevices.GetN ();++i)
+  {
+    fsoDevices.Get (i)->SetAtmosphere (m_atmosphereFactory.Create<FsoAtmosphereModel> ());
+  }
+}
+
 FsoDeviceContainer
 QkdFsoDeviceHelper::Install (QkdDeviceContainer qkdDevices)
 {
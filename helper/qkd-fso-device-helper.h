@@ -71,12 +71,31 @@ public:
    */
   void SetTurntableAttribute (std::string name, const AttributeValue &value);
 
+  /**
+   * Set an attribute value to be propagated to each FsoAtmosphereModel created
+   * by QkdFsoDeviceHelper::InstallAtmosphere, i.e. the atmospheric profile of
+   * the stations installed next.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAtmosphereAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Install one atmospheric profile on each fso device of the ground stations,
+   * the channel loss of their links then depends on the elevation
+   *
+   * \param fsoDevices the fso devices of ground stations
+   */
+  void InstallAtmosphere (FsoDeviceContainer fsoDevices);
+
   FsoDeviceContainer Install (QkdDeviceContainer qkdDevices);
   FsoDeviceContainer Install (Ptr<QkdDevice> qkdDevice);
 private:
   ObjectFactory m_txDeviceFactory;  //!< Factory for FsoTxDevice
   ObjectFactory m_rxDeviceFactory;  //!< Factory for FsoRxDevice
   ObjectFactory m_turntableFactory; //!< Factory for Turntable
+  ObjectFactory m_atmosphereFactory;//!< Factory for FsoAtmosphereModel
 };
 
 } // namespace ns3
@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <sys/resource.h>
+#include "stage-timer.h"
+
+namespace ns3 {
+
+std::vector<StageTimer::Stage> StageTimer::m_stages = std::vector<Stage> ();
+std::vector<std::pair<std::string, uint64_t>> StageTimer::m_counters = std::vector<std::pair<std::string, uint64_t>> ();
+
+StageTimer::Scope::Scope (const std::string& name)
+: m_name  (name)
+, m_start (std::chrono::steady_clock::now ())
+{
+}
+
+StageTimer::Scope::~Scope ()
+{
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - m_start;
+  Add (m_name, elapsed.count ());
+}
+
+void
+StageTimer::Add (const std::string& name, double seconds)
+{
+  for (uint32_t i = 0;i < m_stages.size ();++i)
+  {
+    if (m_stages[i].name == name)
+    {
+      m_stages[i].calls += 1;
+      m_stages[i].seconds += seconds;
+      return;
+    }
+  }
+  m_stages.push_back (Stage {name, 1, seconds});
+}
+
+void
+StageTimer::Count (const std::string& name, uint64_t n)
+{
+  for (uint32_t i = 0;i < m_counters.size ();++i)
+  {
+    if (m_counters[i].first == name)
+    {
+      m_counters[i].second += n;
+      return;
+    }
+  }
+  m_counters.push_back (std::make_pair (name, n));
+}
+
+const std::vector<StageTimer::Stage>&
+StageTimer::GetStages (void)
+{
+  return m_stages;
+}
+
+const std::vector<std::pair<std::string, uint64_t>>&
+StageTimer::GetCounters (void)
+{
+  return m_counters;
+}
+
+uint64_t
+StageTimer::GetPeakRss (void)
+{
+  struct rusage usage;
+  if (getrusage (RUSAGE_SELF, &usage) != 0)
+  {
+    return 0;
+  }
+#ifdef __APPLE__
+  // in byte on macOS
+  return usage.ru_maxrss;
+#else
+  // in kilobyte on Linux
+  return uint64_t (usage.ru_maxrss) * 1024;
+#endif
+}
+
+void
+StageTimer::Reset (void)
+{
+  m_stages.clear ();
+  m_counters.clear ();
+}
+
+void
+StageTimer::WriteJson (std::ostream& os)
+{
+  // the names are identifiers chosen in the code, they need no escaping
+  os << "{" << std::endl << "  \"stages\": [";
+  for (uint32_t i = 0;i < m_stages.size ();++i)
+  {
+    os << (i > 0 ? "," : "") << std::endl
+       << "    {\"name\": \"" << m_stages[i].name << "\", \"calls\": " << m_stages[i].calls
+       << ", \"seconds\": " << m_stages[i].seconds << "}";
+  }
+  os << std::endl << "  ]," << std::endl << "  \"counters\": {";
+  for (uint32_t i = 0;i < m_counters.size ();++i)
+  {
+    os << (i > 0 ? "," : "") << std::endl
+       << "    \"" << m_counters[i].first << "\": " << m_counters[i].second;
+  }
+  os << std::endl << "  }," << std::endl
+     << "  \"peakRssBytes\": " << GetPeakRss () << std::endl
+     << "}" << std::endl;
+}
+
+void
+StageTimer::WriteCsv (std::ostream& os)
+{
+  os << "kind,name,calls,value" << std::endl;
+  for (uint32_t i = 0;i < m_stages.size ();++i)
+  {
+    os << "stage," << m_stages[i].name << "," << m_stages[i].calls << "," << m_stages[i].seconds << std::endl;
+  }
+  for (uint32_t i = 0;i < m_counters.size ();++i)
+  {
+    os << "counter," << m_counters[i].first << ",," << m_counters[i].second << std::endl;
+  }
+  os << "memory,peakRssBytes,," << GetPeakRss () << std::endl;
+}
+
+} // namespace ns3
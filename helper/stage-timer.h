@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#ifndef STAGE_TIMER_H
+#define STAGE_TIMER_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \brief The wall time and counters of the stages of the satellite-to-ground
+ * scheduling pipeline, for benchmarking.
+ *
+ * The stages are timed by StageTimer::Scope around coarse steps such as the
+ * link calculation and the access selection, so the overhead is negligible.
+ * It is not thread safe, the stages are only timed from the simulation thread.
+ */
+class StageTimer
+{
+public:
+  /**
+   * \brief The accumulated wall time of a stage
+   */
+  struct Stage
+  {
+    std::string name;     //!< the name of stage
+    uint64_t    calls;    //!< the number of calls
+    double      seconds;  //!< the total wall time, in second
+  };
+
+  /**
+   * \brief Time the stage from construction to destruction
+   */
+  class Scope
+  {
+  public:
+    /**
+     * \param[in] name the name of stage
+     */
+    Scope (const std::string& name);
+    ~Scope ();
+  private:
+    std::string                           m_name;   //!< the name of stage
+    std::chrono::steady_clock::time_point m_start;  //!< the start time
+  };
+
+  /**
+   * \brief Add the wall time of a call of stage
+   * \param[in] name    the name of stage
+   * \param[in] seconds the wall time, in second
+   */
+  static void Add (const std::string& name, double seconds);
+
+  /**
+   * \brief Add to a counter, e.g. the number of accesses
+   * \param[in] name  the name of counter
+   * \param[in] n     the number to add
+   */
+  static void Count (const std::string& name, uint64_t n);
+
+  /**
+   * \return the stages in the order they are first timed
+   */
+  static const std::vector<Stage>& GetStages (void);
+
+  /**
+   * \return the counters in the order they are first counted
+   */
+  static const std::vector<std::pair<std::string, uint64_t>>& GetCounters (void);
+
+  /**
+   * \return the peak resident set size of the process, in byte
+   */
+  static uint64_t GetPeakRss (void);
+
+  /**
+   * \brief Clear the stages and counters
+   */
+  static void Reset (void);
+
+  /**
+   * \brief Write the stages, counters and peak resident set size as a JSON object
+   * \param[in] os the output stream
+   */
+  static void WriteJson (std::ostream& os);
+
+  /**
+   * \brief Write the stages, counters and peak resident set size as CSV,
+   * with the columns kind, name, calls and value
+   * \param[in] os the output stream
+   */
+  static void WriteCsv (std::ostream& os);
+private:
+  static std::vector<Stage> m_stages;                                 //!< the stages
+  static std::vector<std::pair<std::string, uint64_t>> m_counters;   //!< the counters
+};
+
+} // namespace ns3
+
+#endif /* STAGE_TIMER_H */
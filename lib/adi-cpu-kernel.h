@@ -0,0 +1,549 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#ifndef ADI_CPU_KERNEL_H
+#define ADI_CPU_KERNEL_H
+
+#include <vector>
+#include "adi-type-define.h"
+#include "adi-interval.h"
+#include "adi-satellite.h"
+#include "adi-station.h"
+#include "adi-tle.h"
+
+/*
+ * The host implementations of the kernels in adi-satellite-kernel.h,
+ * adi-station-kernel.h, adi-sun-kernel.h, adi-link-kernel.h and adi-util.h.
+ * They take the same arguments as the cuda kernels, the element (i, j) is
+ * stored in array[i * cols + j], and the rows x cols loops are shared by
+ * the worker threads of adi-cpu.h.
+ */
+
+namespace adi {
+
+/**
+ * \brief The read-only view of a trajectory, it does not own the memory
+ */
+struct TrajectoryView
+{
+  const Vector* pos;
+  const Vector* vel;
+  const Matrix* mat;
+  const Matrix* dmat;
+};
+
+/**
+ * \brief The host buffers of a trajectory, the memory is owned by the buffer
+ */
+struct TrajectoryBuffer
+{
+  std::vector<Vector> pos;
+  std::vector<Vector> vel;
+  std::vector<Matrix> mat;
+  std::vector<Matrix> dmat;
+
+  /**
+   * \brief Resize all buffers
+   * \param[in] n the number of times
+   */
+  void Resize (size_t n);
+
+  /**
+   * \return the trajectory that points to the buffers
+   */
+  Trajectory Get ();
+
+  /**
+   * \param[in] offset the index of the first time
+   * \return the read-only view of the buffers from the time on
+   */
+  TrajectoryView GetView (size_t offset = 0) const;
+};
+
+/**
+ * \brief The access of the host backend to the satellite's parameters
+ */
+class SatelliteHelper
+{
+public:
+  /**
+   * \return the orbital parameter of satellite, the rates are calculated
+   */
+  static Satellite::Par GetParameter (const Satellite& sat);
+
+  /**
+   * \brief Calculate the trajectory of satellite at given elapsed seconds from the epoch
+   * \param[in]   sat     the satellite
+   * \param[in]   epoch   the epoch of the seconds
+   * \param[in]   seconds the elapsed seconds from the epoch
+   * \param[in]   n       the number of seconds
+   * \param[out]  buffer  the trajectory
+   */
+  static void CalcTrajectory (
+    const Satellite&  sat,
+    const DateTime&   epoch,
+    const double*     seconds,
+    size_t            n,
+    TrajectoryBuffer& buffer);
+};
+
+/**
+ * \brief The access of the host backend to the station's element
+ */
+class StationHelper
+{
+public:
+  /**
+   * \return the element of station
+   */
+  static const Station::Ele& GetElement (const Station& sta);
+
+  /**
+   * \brief Calculate the trajectory of station at given ticks
+   * \param[in]   sta     the station
+   * \param[in]   ticks   the ticks of times
+   * \param[in]   n       the number of ticks
+   * \param[out]  buffer  the trajectory
+   */
+  static void CalcTrajectory (
+    const Station&    sta,
+    const int64_t*    ticks,
+    size_t            n,
+    TrajectoryBuffer& buffer);
+};
+
+namespace cpu {
+
+/**
+ * \brief Calculate the trajectory of any object without touching its own buffers,
+ * so that the trajectories of an object can be calculated by several threads
+ * \param[in]   obj       the object
+ * \param[in]   intervals the interval list
+ * \param[in]   epoch     the epoch
+ * \param[in]   step      the time step
+ * \param[out]  buffer    the trajectory
+ */
+void CalcTrajectory (
+  const Object*     obj,
+  const Intervals&  intervals,
+  const DateTime&   epoch,
+  const TimeSpan&   step,
+  TrajectoryBuffer& buffer);
+
+/**
+ * \brief b[i] = A[i] * b[i]
+ */
+void CalcMatsMulVecs (
+  Matrix* A,
+  Vector* b,
+  size_t  rows,
+  size_t  cols);
+
+/**
+ * \brief c[i] = A[i] * b[i]
+ */
+void CalcVecsEqMatsMulVecs (
+  Vector* c,
+  Matrix* A,
+  Vector* b,
+  size_t  rows,
+  size_t  cols);
+
+/**
+ * \brief The array of doubles aligned to the width of the widest vector register,
+ * so that the loops over it can be vectorized with aligned full-width loads
+ */
+class AlignedArray
+{
+public:
+  static const size_t ALIGNMENT = 64;
+  AlignedArray ();
+  ~AlignedArray ();
+
+  /**
+   * \brief Resize the array, the content is not kept
+   * \param[in] n the number of doubles
+   */
+  void Resize (size_t n);
+  size_t GetN () const { return m_n; }
+  double* Data () { return m_data; }
+  const double* Data () const { return m_data; }
+  double& operator[] (size_t i) { return m_data[i]; }
+  const double& operator[] (size_t i) const { return m_data[i]; }
+private:
+  AlignedArray (const AlignedArray&);
+  AlignedArray& operator= (const AlignedArray&);
+  double* m_data;
+  size_t  m_n;
+};
+
+namespace satellite {
+
+/**
+ * \brief The orbital states of satellites in structure-of-arrays layout,
+ * the state of satellite i at time j is element i * cols + j of every array
+ */
+struct StateArrays
+{
+  AlignedArray raan;
+  AlignedArray aop;
+  AlignedArray ma;
+  AlignedArray ea;      //!< eccentric anomaly, updated in place by Newton's iterations
+  AlignedArray cosTa;   //!< cosine of true anomaly, kept for the rotation to eci
+  AlignedArray sinTa;   //!< sine of true anomaly, kept for the rotation to eci
+  AlignedArray radius;
+
+  /**
+   * \brief Resize all arrays
+   * \param[in] n the number of states
+   */
+  void Resize (size_t n);
+};
+
+/**
+ * \brief Calculate the orbital states with the secular J2 rates
+ * \param[out]  state the orbital states
+ * \param[in]   param the 1-dim array of satellite's orbital parameters
+ * \param[in]   times the elapsed seconds from the epoch
+ * \param[in]   rows  the number of satellites
+ * \param[in]   cols  the number of times
+ */
+void CalcState (
+  StateArrays&          state,
+  const Satellite::Par* param,
+  const double*         times,
+  size_t                rows,
+  size_t                cols);
+
+/**
+ * \brief Calculate the sine and cosine of true anomaly and the radius,
+ * Kepler's equation is solved with a number of Newton's iterations fixed per
+ * satellite so that the loop over times has no data dependent branch
+ */
+void CalcTureAnomaly (
+  StateArrays&          state,
+  const Satellite::Par* param,
+  size_t                rows,
+  size_t                cols);
+
+/**
+ * \brief Calculate the eci position and velocity, the position and velocity in
+ * orbital coordinate are rotated to eci without storing the matrices
+ * \param[out]  position  the eci position
+ * \param[out]  velocity  the eci velocity
+ * \param[in]   param     the 1-dim array of satellite's orbital parameters
+ * \param[in]   state     the orbital states
+ */
+void CalcEciState (
+  Vector*               position,
+  Vector*               velocity,
+  const Satellite::Par* param,
+  const StateArrays&    state,
+  size_t                rows,
+  size_t                cols);
+
+/**
+ * \brief Calculate the trajectories of satellites at given times
+ * \param[out]  position    the eci position
+ * \param[out]  velocity    the eci velocity
+ * \param[out]  matrix      the transform matrix from eci to body
+ * \param[out]  derivMatrix the derivative of transform matrix, NULL if not needed
+ * \param[in]   param       the 1-dim array of satellite's orbital parameters
+ * \param[in]   times       the elapsed seconds from the epoch
+ * \param[in]   rows        the number of satellites
+ * \param[in]   cols        the number of times
+ */
+void CalcTrajectory (
+  Vector*               position,
+  Vector*               velocity,
+  Matrix*               matrix,
+  Matrix*               derivMatrix,
+  const Satellite::Par* param,
+  const double*         times,
+  size_t                rows,
+  size_t                cols);
+
+/**
+ * \brief Calculate the rates of orbital parameters caused by J2 perturbation
+ * \param[inout]  param the 1-dim array of satellite's orbital parameters
+ * \param[in]     rows  the number of satellites
+ */
+void CalcParam (
+  Satellite::Par* param,
+  size_t          rows);
+
+/**
+ * \brief Calculate the transform matrix from eci to body coordinate,
+ * x is along the velocity, z points to the nadir
+ * \param[out]  matrix    the transform matrix
+ * \param[in]   position  the eci position
+ * \param[in]   velocity  the eci velocity
+ */
+void CalcMatrixFromEciToBody (
+  Matrix*         matrix,
+  Vector*         position,
+  Vector*         velocity,
+  size_t          rows,
+  size_t          cols);
+
+/**
+ * \brief Calculate the derivative of transform matrix from eci to body coordinate
+ */
+void CalcDerivMatrixFromEciToBody (
+  Matrix*         derivMatrix,
+  Matrix*         matrix,
+  Vector*         position,
+  Vector*         velocity,
+  size_t          rows,
+  size_t          cols);
+
+} // namespace satellite
+
+namespace sgp4 {
+
+/**
+ * \brief The constants of the near earth SGP4 model initialized from a two-line element set,
+ * the names follow the Spacetrack Report No. 3
+ */
+struct Parameter
+{
+  Tle     tle;
+  double  epoch;      //!< the epoch of elements, in minutes from J2000
+  bool    isSimple;   //!< whether the perigee is too low for the higher order drag terms
+  double  aodp, xnodp, cosio, sinio, eta, x3thm1, x1mth2, x7thm1;
+  double  c1, c4, c5, xmdot, omgdot, xnodot, xnodcf, t2cof, xlcof, aycof;
+  double  omgcof, xmcof, delmo, sinmo, d2, d3, d4, t3cof, t4cof, t5cof;
+};
+
+/**
+ * \brief Initialize the constants of the near earth SGP4 model
+ * \param[out]  param the constants
+ * \param[in]   tle   the two-line element set
+ * \return false if the period is not less than 225 minutes, which needs the deep space model
+ */
+bool Initialize (
+  Parameter&  param,
+  const Tle&  tle);
+
+/**
+ * \brief Calculate the eci (TEME) state of satellites with the SGP4 model
+ * \param[out]  position  the 2-dim array of eci position
+ * \param[out]  velocity  the 2-dim array of eci velocity
+ * \param[in]   param     the 1-dim array of the constants of satellites
+ * \param[in]   epoch     the epoch of the seconds, in minutes from J2000
+ * \param[in]   seconds   the 1-dim array of elapsed seconds from the epoch
+ * \param[in]   rows      the number of satellites
+ * \param[in]   cols      the number of times
+ */
+void CalcEciState (
+  Vector*           position,
+  Vector*           velocity,
+  const Parameter*  param,
+  double            epoch,
+  const double*     seconds,
+  size_t            rows,
+  size_t            cols);
+
+/**
+ * \brief Calculate the trajectory of satellites with the SGP4 model,
+ * the attitude is the same as the satellites propagated with their elements
+ * \param[out]  position    the 2-dim array of eci position
+ * \param[out]  velocity    the 2-dim array of eci velocity
+ * \param[out]  matrix      the 2-dim array of transform matrix from eci to body
+ * \param[out]  derivMatrix the 2-dim array of the derivative of matrix, it is skipped if NULL
+ * \param[in]   param       the 1-dim array of the constants of satellites
+ * \param[in]   epoch       the epoch of the seconds, in minutes from J2000
+ * \param[in]   seconds     the 1-dim array of elapsed seconds from the epoch
+ * \param[in]   rows        the number of satellites
+ * \param[in]   cols        the number of times
+ */
+void CalcTrajectory (
+  Vector*           position,
+  Vector*           velocity,
+  Matrix*           matrix,
+  Matrix*           derivMatrix,
+  const Parameter*  param,
+  double            epoch,
+  const double*     seconds,
+  size_t            rows,
+  size_t            cols);
+
+} // namespace sgp4
+
+namespace station {
+
+/**
+ * \brief Calculate the local sidereal time of given stations and ticks
+ */
+void CalcLocalGreenwichSiderealTime (
+  Gst*            gst,
+  Station::Ele*   element,
+  const int64_t*  ticks,
+  size_t          rows,
+  size_t          cols);
+
+/**
+ * \brief Calculate the eci position of stations
+ */
+void CalcEciPosition (
+  Vector*         position,
+  Station::Ele*   element,
+  Gst*            gst,
+  size_t          rows,
+  size_t          cols);
+
+/**
+ * \brief Calculate the eci velocity of stations caused by the earth spin
+ */
+void CalcEciVelocity (
+  Vector*         velocity,
+  Vector*         position,
+  size_t          rows,
+  size_t          cols);
+
+/**
+ * \brief Calculate the transform matrix from eci to body (north-east-down) coordinate
+ */
+void CalcMatrixFromEciToBody (
+  Matrix*         matrix,
+  Station::Ele*   element,
+  Gst*            gst,
+  size_t          rows,
+  size_t          cols);
+
+/**
+ * \brief Calculate the derivative of transform matrix from eci to body coordinate
+ */
+void CalcDerivMatrixFromEciToBody (
+  Matrix*         derivMatrix,
+  Matrix*         matrix,
+  Station::Ele*   element,
+  Gst*            gst,
+  size_t          rows,
+  size_t          cols);
+
+} // namespace station
+
+namespace sun {
+
+/**
+ * \brief Calculate the eci position of the sun
+ * \param[out]  position  the 1-dim array of eci position
+ * \param[in]   ticks     the 1-dim array of ticks
+ * \param[in]   N         the number of ticks
+ */
+void CalcEciPosition (
+  Vector*         position,
+  const int64_t*  ticks,
+  size_t          N);
+
+/**
+ * \brief Get the eci position of the sun at the evenly spaced times from the shared table,
+ * the table is filled lazily in blocks and is shared by all links of all link helpers
+ * \param[out]  position  the 1-dim array of eci position
+ * \param[in]   start     the ticks of the first time
+ * \param[in]   step      the ticks between two times
+ * \param[in]   N         the number of times
+ */
+void GetEciPosition (
+  Vector*         position,
+  int64_t         start,
+  int64_t         step,
+  size_t          N);
+
+} // namespace sun
+
+namespace link {
+
+/**
+ * \brief Calculate the link state between two objects at the same times,
+ * it serves both the inter-satellite links and the satellite-station accesses
+ * \param[out]  state       the 1-dim array of link states
+ * \param[in]   srcPos      the eci position of source
+ * \param[in]   srcMat      the transform matrix from eci to body of source
+ * \param[in]   srcOp       the transform from body to source's face
+ * \param[in]   srcBound    the bound of source's turntable
+ * \param[in]   srcEarth    whether the source is a station on the earth's surface
+ * \param[in]   dstPos      the eci position of destination
+ * \param[in]   dstMat      the transform matrix from eci to body of destination
+ * \param[in]   dstOp       the transform from body to destination's face
+ * \param[in]   dstBound    the bound of destination's turntable
+ * \param[in]   dstEarth    whether the destination is a station on the earth's surface
+ * \param[in]   sunPos      the eci position of the sun
+ * \param[in]   maxDistance the maximum distance
+ * \param[in]   FOV         the field of view
+ * \param[in]   depth       the number of times
+ */
+void CalcLink (
+  uint8_t*      state,
+  const Vector* srcPos,
+  const Matrix* srcMat,
+  Vec2Vec       srcOp,
+  PointingBound srcBound,
+  bool          srcEarth,
+  const Vector* dstPos,
+  const Matrix* dstMat,
+  Vec2Vec       dstOp,
+  PointingBound dstBound,
+  bool          dstEarth,
+  const Vector* sunPos,
+  double        maxDistance,
+  PointingBound FOV,
+  size_t        depth);
+
+/**
+ * \brief Calculate the link state, pointings and range between two objects
+ * \param[in]   srcVel      the eci velocity of source
+ * \param[in]   srcDMat     the derivative of transform matrix of source
+ * \param[out]  srcView     the pointing from source to destination
+ * \param[in]   dstVel      the eci velocity of destination
+ * \param[in]   dstDMat     the derivative of transform matrix of destination
+ * \param[out]  dstView     the pointing from destination to source
+ * \param[out]  range       the distance between source and destination
+ */
+void CalcLinkData (
+  uint8_t*      state,
+  const Vector* srcPos,
+  const Vector* srcVel,
+  const Matrix* srcMat,
+  const Matrix* srcDMat,
+  Vec2Vec       srcOp,
+  PointingBound srcBound,
+  bool          srcEarth,
+  Pointing*     srcView,
+  const Vector* dstPos,
+  const Vector* dstVel,
+  const Matrix* dstMat,
+  const Matrix* dstDMat,
+  Vec2Vec       dstOp,
+  PointingBound dstBound,
+  bool          dstEarth,
+  Pointing*     dstView,
+  double*       range,
+  const Vector* sunPos,
+  double        maxDistance,
+  PointingBound FOV,
+  size_t        depth);
+
+} // namespace link
+} // namespace cpu
+} // namespace adi
+
+#endif /* ADI_CPU_KERNEL_H */
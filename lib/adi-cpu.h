@@ -0,0 +1,70 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#ifndef ADI_CPU_H
+#define ADI_CPU_H
+
+#include <cstddef>
+#include <functional>
+
+namespace adi {
+namespace cpu {
+
+/**
+ * \brief The body of a parallel loop, it processes the indices in [begin, end)
+ */
+typedef std::function<void (size_t begin, size_t end)> LoopBody;
+
+/**
+ * \brief Set the number of worker threads used by the host backend
+ * \param[in] n the number of threads, 0 means one thread per hardware core
+ */
+void SetThreadCount (size_t n);
+
+/**
+ * \return the number of worker threads used by the host backend,
+ * the default value is taken from the environment variable ADI_CPU_THREADS,
+ * or the number of hardware cores if it is not set
+ */
+size_t GetThreadCount ();
+
+/**
+ * \brief Run the body over the indices [0, n) on all worker threads,
+ * the indices are split into contiguous blocks, one block per thread.
+ * If it is called inside a worker thread, the body is run serially.
+ * \param[in] n     the number of indices
+ * \param[in] body  the body of loop
+ * \param[in] grain the minimum number of indices processed by one block
+ */
+void ParallelFor (size_t n, const LoopBody& body, size_t grain = 1);
+
+/**
+ * \brief Run the body over the 2-dim indices rows x cols,
+ * the index (i, j) is flattened as i * cols + j
+ * \param[in] rows  the rows of indices
+ * \param[in] cols  the columns of indices
+ * \param[in] body  the body of loop, it is called with flattened indices
+ */
+void ParallelFor (size_t rows, size_t cols, const LoopBody& body);
+
+} // namespace cpu
+} // namespace adi
+
+#endif /* ADI_CPU_H */
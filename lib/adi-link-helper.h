@@ -69,6 +69,12 @@ public:
    * \return the link data
    */
   LinkInfoList& CalcLink ();
+
+  /**
+   * \brief Get the link list
+   * \return the link list
+   */
+  const Links& GetLinkList () const { return m_links; }
 private:
 
   /**
@@ -28,6 +28,9 @@
 namespace adi {
 
 class Turntable;
+#ifdef ADI_CPU
+struct TrajectoryView;
+#endif
 
 class Link 
 {
@@ -113,12 +116,32 @@ public:
    */
   Intervals CalcLinkInterval ();
   LinkInfoList CalcLinkData ();
+#ifdef ADI_CPU
+  /**
+   * \brief Calculate the link data from the trajectories of both ends calculated
+   * beforehand, so that the trajectory of an object is shared by its links
+   * \param[in] src the trajectory of source at the times of the interval list
+   * \param[in] dst the trajectory of destination at the same times
+   * \return the link data
+   */
+  LinkInfoList CalcLinkData (const TrajectoryView& src, const TrajectoryView& dst);
+#endif
   Satellite* GetSatellite (size_t i);
   Turntable* GetTurntable (size_t i);
   Face GetFace (size_t i) const;
   bool operator== (const Link& link);
   void SetIncludedState (uint8_t included);
   void SetExcludedState (uint8_t excluded);
+
+  /**
+   * \return the state that must be included
+   */
+  uint8_t GetIncludedState () const { return m_includedState; }
+
+  /**
+   * \return the state that must be excluded
+   */
+  uint8_t GetExcludedState () const { return m_excludedState; }
 private:
   void FaceTransform (Vec2Vec& host, Face face);
   bool IsAcceptedState (const uint8_t& state) const;
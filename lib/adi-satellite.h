@@ -27,10 +27,18 @@
 #include "adi-type-define.h"
 #include "adi-object.h"
 #include "adi-turntable.h"
+#include "adi-tle.h"
 
 namespace adi {
 
 class SatelliteHelper;
+#ifdef ADI_CPU
+namespace cpu {
+namespace sgp4 {
+struct Parameter;
+}
+}
+#endif
 
 class Satellite : public Object
 {
@@ -114,6 +122,27 @@ public:
     double ma,
     bool   isDegree = true);
 
+  /**
+   * \return the element of satellite
+   */
+  const Ele& GetElement () const { return m_par.elem; }
+
+#ifdef ADI_CPU
+  /**
+   * \brief Set the two-line element set, the satellite is then propagated with the SGP4 model
+   * instead of its element until the element is set again, the element is set to the mean
+   * element at the epoch of the two-line element set
+   * \param[in] tle the two-line element set
+   * \return false if the orbit needs the deep space model, which is not supported
+   */
+  bool SetTle (const Tle& tle);
+
+  /**
+   * \return the two-line element set, NULL if the satellite is propagated with its element
+   */
+  const Tle* GetTle () const;
+#endif
+
   virtual std::string GetName () const;
 
   /**
@@ -147,6 +176,9 @@ private:
   //datas in device
   Par*  d_par;
   Sta*  d_sta;
+#ifdef ADI_CPU
+  std::shared_ptr<const cpu::sgp4::Parameter> m_sgp4;  //!< the SGP4 model, NULL if the element is used
+#endif
 };
 
 std::ostream& operator<< (std::ostream& os, const Satellite::Ele& ele);
@@ -85,6 +85,11 @@ public:
   //   double alt,
   //   bool isDegree = true);
 
+  /**
+   * \return the element of station
+   */
+  const Ele& GetElement () const { return m_ele; }
+
   virtual std::string GetName () const;
 
   /**
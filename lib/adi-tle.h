@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#ifndef ADI_TLE_H
+#define ADI_TLE_H
+
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include "adi-date-time.h"
+
+namespace adi {
+
+/**
+ * \brief The two-line element set of a satellite,
+ * the angles are in radian and the mean motion is in revolution per day
+ */
+struct Tle
+{
+  std::string name;         //!< the name of satellite, from the title line if any
+  uint32_t    number;       //!< the catalog number
+  DateTime    epoch;        //!< the epoch of elements
+  double      bstar;        //!< the drag term, in 1 / earth radii
+  double      inc;          //!< the inclination
+  double      raan;         //!< the right ascension of ascending node
+  double      ecc;          //!< the eccentricity
+  double      aop;          //!< the argument of perigee
+  double      ma;           //!< the mean anomaly
+  double      mm;           //!< the mean motion
+  std::string line1;        //!< the first line
+  std::string line2;        //!< the second line
+
+  /**
+   * \brief Parse the two lines of elements
+   * \param[in]   line1 the first line
+   * \param[in]   line2 the second line
+   * \param[out]  tle   the element set
+   * \return false if the lines are not a valid element set
+   */
+  static bool Parse (const std::string& line1, const std::string& line2, Tle& tle);
+private:
+  static bool ToDouble (const std::string& line, size_t pos, size_t len, double& value);
+  static bool IsValid (const std::string& line, char id);
+};
+
+inline bool
+Tle::ToDouble (const std::string& line, size_t pos, size_t len, double& value)
+{
+  std::string s = line.substr (pos, len);
+  char* end = NULL;
+  value = std::strtod (s.c_str (), &end);
+  return end != s.c_str ();
+}
+
+inline bool
+Tle::IsValid (const std::string& line, char id)
+{
+  if (line.size () < 69 || line[0] != id || line[1] != ' ')
+  {
+    return false;
+  }
+  // the last digit is the sum of digits modulo 10, a minus sign counts as 1
+  int sum = 0;
+  for (size_t i = 0;i < 68;++i)
+  {
+    if (line[i] >= '0' && line[i] <= '9')
+    {
+      sum += line[i] - '0';
+    }
+    else if (line[i] == '-')
+    {
+      sum += 1;
+    }
+  }
+  return line[68] - '0' == sum % 10;
+}
+
+inline bool
+Tle::Parse (const std::string& line1, const std::string& line2, Tle& tle)
+{
+  if (!IsValid (line1, '1') || !IsValid (line2, '2') || line1.substr (2, 5) != line2.substr (2, 5))
+  {
+    return false;
+  }
+  double number, year, day, mantissa, exponent;
+  double inc, raan, ecc, aop, ma, mm;
+  if (!ToDouble (line1, 2, 5, number) || !ToDouble (line1, 18, 2, year) || !ToDouble (line1, 20, 12, day)
+   || !ToDouble (line1, 54, 5, mantissa) || !ToDouble (line1, 59, 2, exponent)
+   || !ToDouble (line2, 8, 8, inc) || !ToDouble (line2, 17, 8, raan) || !ToDouble (line2, 26, 7, ecc)
+   || !ToDouble (line2, 34, 8, aop) || !ToDouble (line2, 43, 8, ma) || !ToDouble (line2, 52, 11, mm))
+  {
+    return false;
+  }
+  // the years from 57 to 99 are in the 20th century
+  int y = (int)year < 57 ? 2000 + (int)year : 1900 + (int)year;
+  tle.number = (uint32_t)number;
+  tle.epoch = DateTime (y, 1, 1) + TimeSpan ((int64_t)std::llround ((day - 1.0) * TicksPerDay));
+  tle.bstar = (line1[53] == '-' ? -1.0 : 1.0) * mantissa * 1e-5 * std::pow (10.0, exponent);
+  tle.inc = inc * M_PI / 180.0;
+  tle.raan = raan * M_PI / 180.0;
+  tle.ecc = ecc * 1e-7;
+  tle.aop = aop * M_PI / 180.0;
+  tle.ma = ma * M_PI / 180.0;
+  tle.mm = mm;
+  tle.line1 = line1.substr (0, 69);
+  tle.line2 = line2.substr (0, 69);
+  return true;
+}
+
+}
+
+#endif /* ADI_TLE_H */
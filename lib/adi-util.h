@@ -21,10 +21,17 @@
 #ifndef ADI_UTIL_H
 #define ADI_UTIL_H
 
+#ifdef ADI_CPU
+// the host backend compiles the same helpers as plain host functions
+#define __host__
+#define __device__
+#else
 #include <cuda_runtime.h>
+#endif
 #include "adi-type-define.h"
 
 namespace adi {
+#ifndef ADI_CPU
 #define cudaCheck \
 { \
   cudaError_t cudaStatus; \
@@ -34,6 +41,7 @@ namespace adi {
     std::cout << __FILE__ << ": " << __LINE__ << " Error code: " << cudaGetErrorString (cudaStatus) << std::endl; \
   } \
 }
+#endif
 
 extern __host__ __device__ double Wrap(const double x, const double y);
 
@@ -88,6 +96,7 @@ extern __host__ __device__ void Swap (double& a, double& b);
 // Trajectory MemcpyDeviceToHost (Trajectory device);
 // Trajectories MemcpyDeviceToHost (Trajectories device);
 
+#ifndef ADI_CPU
 namespace cuda {
 
 /**
@@ -176,5 +185,6 @@ __global__ void CalcAnd (
   size_t  rows,
   size_t  cols);
 } // namespace cuda
+#endif
 } // namespace adi
 #endif /* UTIL_H */
\ No newline at end of file
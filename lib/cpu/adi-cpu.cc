@@ -0,0 +1,276 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include "adi-cpu.h"
+
+namespace adi {
+namespace cpu {
+
+namespace {
+
+/**
+ * \brief The fixed-size pool of worker threads used by ParallelFor,
+ * the workers are created at the first parallel loop and live until exit
+ */
+class ThreadPool
+{
+public:
+  ThreadPool ();
+  ~ThreadPool ();
+  void Resize (size_t n);
+  size_t GetN () const;
+  void Run (size_t n, size_t grain, const LoopBody& body);
+  static bool IsWorker ();
+private:
+  void Start (size_t n);
+  void Stop ();
+  void Work (size_t id);
+  std::vector<std::thread>  m_workers;
+  std::mutex                m_mutex;    //!< protects the job below
+  std::mutex                m_run;      //!< serializes the parallel loops
+  std::condition_variable   m_wake;
+  std::condition_variable   m_done;
+  const LoopBody*           m_body;
+  size_t                    m_n;
+  size_t                    m_block;
+  size_t                    m_next;     //!< the next block to be processed
+  size_t                    m_pending;  //!< the workers still in current job
+  uint64_t                  m_job;
+  bool                      m_exit;
+  static thread_local bool  m_isWorker;
+};
+
+thread_local bool ThreadPool::m_isWorker = false;
+
+size_t
+DefaultThreadCount ()
+{
+  const char* env = std::getenv ("ADI_CPU_THREADS");
+  if (env)
+  {
+    long n = std::strtol (env, NULL, 10);
+    if (n > 0)
+    {
+      return n;
+    }
+  }
+  size_t n = std::thread::hardware_concurrency ();
+  return n == 0 ? 1 : n;
+}
+
+ThreadPool::ThreadPool ()
+: m_body    (NULL)
+, m_n       (0)
+, m_block   (0)
+, m_next    (0)
+, m_pending (0)
+, m_job     (0)
+, m_exit    (false)
+{
+}
+
+ThreadPool::~ThreadPool ()
+{
+  Stop ();
+}
+
+void
+ThreadPool::Start (size_t n)
+{
+  m_exit = false;
+  // the calling thread takes part in every loop, so one thread less is needed
+  for (size_t i = 1;i < n;++i)
+  {
+    m_workers.push_back (std::thread (&ThreadPool::Work, this, i));
+  }
+}
+
+void
+ThreadPool::Stop ()
+{
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_exit = true;
+  }
+  m_wake.notify_all ();
+  for (size_t i = 0;i < m_workers.size ();++i)
+  {
+    m_workers[i].join ();
+  }
+  m_workers.clear ();
+}
+
+void
+ThreadPool::Resize (size_t n)
+{
+  std::lock_guard<std::mutex> run (m_run);
+  Stop ();
+  Start (n);
+}
+
+size_t
+ThreadPool::GetN () const
+{
+  return m_workers.size () + 1;
+}
+
+bool
+ThreadPool::IsWorker ()
+{
+  return m_isWorker;
+}
+
+void
+ThreadPool::Run (size_t n, size_t grain, const LoopBody& body)
+{
+  std::lock_guard<std::mutex> run (m_run);
+  size_t threads = GetN ();
+  size_t block = std::max (grain, (n + threads - 1) / threads);
+  if (threads == 1 || block >= n)
+  {
+    // the loops nested in body must not lock m_run again
+    m_isWorker = true;
+    body (0, n);
+    m_isWorker = false;
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_body = &body;
+    m_n = n;
+    m_block = block;
+    m_next = 0;
+    m_pending = m_workers.size ();
+    ++m_job;
+  }
+  m_wake.notify_all ();
+  m_isWorker = true;
+  while (true)
+  {
+    size_t begin;
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      begin = m_next;
+      m_next += m_block;
+    }
+    if (begin >= n)
+    {
+      break;
+    }
+    body (begin, std::min (begin + block, n));
+  }
+  m_isWorker = false;
+  std::unique_lock<std::mutex> lock (m_mutex);
+  m_done.wait (lock, [this] { return m_pending == 0; });
+  m_body = NULL;
+}
+
+void
+ThreadPool::Work (size_t /* id */)
+{
+  m_isWorker = true;
+  uint64_t job = 0;
+  while (true)
+  {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    m_wake.wait (lock, [this, job] { return m_exit || m_job != job; });
+    if (m_exit)
+    {
+      return;
+    }
+    job = m_job;
+    while (m_next < m_n)
+    {
+      size_t begin = m_next;
+      size_t end = std::min (begin + m_block, m_n);
+      m_next += m_block;
+      lock.unlock ();
+      (*m_body) (begin, end);
+      lock.lock ();
+    }
+    if (--m_pending == 0)
+    {
+      m_done.notify_one ();
+    }
+  }
+}
+
+ThreadPool&
+GetPool ()
+{
+  static ThreadPool pool;
+  static bool started = false;
+  if (!started)
+  {
+    started = true;
+    pool.Resize (DefaultThreadCount ());
+  }
+  return pool;
+}
+
+} // namespace
+
+void
+SetThreadCount (size_t n)
+{
+  if (n == 0)
+  {
+    n = std::max (1u, std::thread::hardware_concurrency ());
+  }
+  GetPool ().Resize (n);
+}
+
+size_t
+GetThreadCount ()
+{
+  return GetPool ().GetN ();
+}
+
+void
+ParallelFor (size_t n, const LoopBody& body, size_t grain)
+{
+  if (n == 0)
+  {
+    return;
+  }
+  // nested loops are run serially by the worker which owns the outer block
+  if (ThreadPool::IsWorker ())
+  {
+    body (0, n);
+    return;
+  }
+  GetPool ().Run (n, std::max<size_t> (grain, 1), body);
+}
+
+void
+ParallelFor (size_t rows, size_t cols, const LoopBody& body)
+{
+  ParallelFor (rows * cols, body, 64);
+}
+
+} // namespace cpu
+} // namespace adi
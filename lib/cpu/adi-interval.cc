@@ -0,0 +1,205 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <algorithm>
+#include "adi-interval.h"
+
+namespace adi {
+
+Interval::Interval ()
+: m_start (DateTime ())
+, m_stop  (DateTime ())
+{
+}
+
+Interval::Interval (const Interval& interval)
+: m_start (interval.m_start)
+, m_stop  (interval.m_stop)
+{
+}
+
+Interval::Interval (DateTime _start, DateTime _stop)
+: m_start (_start)
+, m_stop  (_stop)
+{
+  if (m_stop < m_start)
+  {
+    std::swap (m_start, m_stop);
+  }
+}
+
+void
+Interval::SetStart (const DateTime& start)
+{
+  m_start = start;
+}
+
+const DateTime&
+Interval::GetStart () const
+{
+  return m_start;
+}
+
+void
+Interval::SetStop (const DateTime& stop)
+{
+  m_stop = stop;
+}
+
+const DateTime&
+Interval::GetStop () const
+{
+  return m_stop;
+}
+
+Interval&
+Interval::Shift (const TimeSpan& delay)
+{
+  m_start = m_start + delay;
+  m_stop = m_stop + delay;
+  return *this;
+}
+
+std::string
+Interval::ToString () const
+{
+  std::stringstream ss;
+  ss << m_start << " ~ " << m_stop;
+  return ss.str ();
+}
+
+bool
+Interval::operator== (const Interval& interval) const
+{
+  return m_start == interval.m_start && m_stop == interval.m_stop;
+}
+
+bool
+Interval::operator!= (const Interval& interval) const
+{
+  return !(*this == interval);
+}
+
+bool
+Interval::operator< (const Interval& interval) const
+{
+  return m_start < interval.m_start;
+}
+
+bool
+Interval::Intersect (const Interval& interval) const
+{
+  return m_start <= interval.m_stop && interval.m_start <= m_stop;
+}
+
+bool
+Interval::Intersect (const DateTime& dateTime) const
+{
+  return m_start <= dateTime && dateTime <= m_stop;
+}
+
+void
+Interval::Merge (const Interval& interval)
+{
+  m_start = std::min (m_start, interval.m_start);
+  m_stop = std::max (m_stop, interval.m_stop);
+}
+
+void
+Interval::InsertToList (Intervals& intervals) const
+{
+  Interval merged = *this;
+  Intervals::iterator it = intervals.begin ();
+  while (it != intervals.end ())
+  {
+    if (merged.Intersect (*it))
+    {
+      merged.Merge (*it);
+      it = intervals.erase (it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  intervals.insert (std::upper_bound (intervals.begin (), intervals.end (), merged), merged);
+}
+
+size_t
+Interval::GetTicks (const TimeSpan& step) const
+{
+  return (m_stop - m_start).Ticks () / step.Ticks () + 1;
+}
+
+size_t
+Interval::GetTotalTicks (const Intervals& intervals, const TimeSpan& step)
+{
+  size_t ticks = 0;
+  for (const Interval& interval : intervals)
+  {
+    ticks += interval.GetTicks (step);
+  }
+  return ticks;
+}
+
+std::vector<double>
+Interval::CreateSeconds (const Intervals& intervals, const DateTime& epoch, const TimeSpan& step)
+{
+  std::vector<double> seconds;
+  seconds.reserve (GetTotalTicks (intervals, step));
+  for (const Interval& interval : intervals)
+  {
+    double t0 = (interval.m_start - epoch).TotalSeconds ();
+    double dt = step.TotalSeconds ();
+    size_t n = interval.GetTicks (step);
+    for (size_t i = 0;i < n;++i)
+    {
+      seconds.push_back (t0 + dt * i);
+    }
+  }
+  return seconds;
+}
+
+std::vector<int64_t>
+Interval::CreateTicks (const Intervals& intervals, const DateTime& /* epoch */, const TimeSpan& step)
+{
+  std::vector<int64_t> ticks;
+  ticks.reserve (GetTotalTicks (intervals, step));
+  for (const Interval& interval : intervals)
+  {
+    int64_t t0 = interval.m_start.Ticks ();
+    int64_t dt = step.Ticks ();
+    size_t n = interval.GetTicks (step);
+    for (size_t i = 0;i < n;++i)
+    {
+      ticks.push_back (t0 + dt * i);
+    }
+  }
+  return ticks;
+}
+
+std::ostream&
+operator<< (std::ostream& os, const Interval& i)
+{
+  os << i.ToString ();
+  return os;
+}
+
+} //namespace adi
@@ -0,0 +1,495 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <map>
+#include <unordered_map>
+#include "adi-link-helper.h"
+#include "adi-constant.h"
+#include "adi-turntable.h"
+#include "adi-cpu.h"
+#include "adi-cpu-kernel.h"
+
+namespace adi {
+
+namespace {
+
+/**
+ * The range between two satellites can not dip deeper than
+ * 0.5 * (15 km/s)^2 / 1500 km * (30 s)^2 = 67.5 km between two samples a minute apart,
+ * so the coarse pass with this margin does not lose the windows limited by the distance.
+ * The other states (field of view, pointing bounds, sun) have no such bound and may
+ * flip twice within a minute, so they are only checked by the fine pass.
+ */
+const double K_COARSE_MARGIN = 70.0;
+
+/**
+ * The fine pass propagates every object once per chunk of this length and shares
+ * the trajectory among its links, the chunk bounds the memory of the trajectories.
+ */
+const TimeSpan K_CHUNK = TimeSpan (0, 10, 0);
+
+/**
+ * \brief The part of a candidate interval inside a chunk
+ */
+struct Piece
+{
+  Interval interval;  //!< the clipped interval, it starts on the step grid of the candidate
+  size_t   candidate; //!< the index of candidate interval
+};
+
+/**
+ * \brief Get the index of the first time of the interval in the trajectory of the interval list
+ * \param[in] intervals the interval list which the trajectory is calculated at
+ * \param[in] offsets   the index of the first time of every interval in the list
+ * \param[in] interval  the interval inside the list, on the same step grid
+ * \param[in] step      the time step
+ * \return the index of the first time
+ */
+size_t
+GetOffset (const Intervals& intervals, const std::vector<size_t>& offsets, const Interval& interval, const TimeSpan& step)
+{
+  int64_t start = interval.GetStart ().Ticks ();
+  size_t i = std::upper_bound (intervals.begin (), intervals.end (), interval) - intervals.begin ();
+  while (i-- > 0)
+  {
+    int64_t begin = intervals[i].GetStart ().Ticks ();
+    if ((start - begin) % step.Ticks () == 0 && interval.GetStop () <= intervals[i].GetStop ())
+    {
+      return offsets[i] + (start - begin) / step.Ticks ();
+    }
+  }
+  return offsets.back ();
+}
+
+/**
+ * \brief Get the key of the cell that contains the position
+ * \param[in] x    the index of cell in x axis
+ * \param[in] y    the index of cell in y axis
+ * \param[in] z    the index of cell in z axis
+ * \return the key of cell
+ */
+int64_t
+GetCellKey (int64_t x, int64_t y, int64_t z)
+{
+  const int64_t offset = 1 << 20;
+  return ((x + offset) << 42) | ((y + offset) << 21) | (z + offset);
+}
+
+/**
+ * \brief Find the coarse intervals that both ends of the links are close enough.
+ *
+ * Every object is propagated once with the coarse step, the destinations are
+ * put into a grid with the cell as large as the maximum distance at every time,
+ * so only the pairs in the neighbour cells are checked instead of all links.
+ * The links whose distance is not limited are calculated in the whole intervals.
+ * \param[in] links      the links, they share the same epoch
+ * \param[in] intervals  the intervals to be calculated
+ * \return the candidate intervals of every link
+ */
+std::vector<Intervals>
+CalcCandidateInterval (const Links& links, const Intervals& intervals)
+{
+  std::vector<Intervals> candidates (links.size ());
+  std::vector<const Object*> objects;
+  std::map<const Object*, uint32_t> indices;
+  std::vector<uint32_t> srcs, dsts;
+  std::unordered_map<uint64_t, std::vector<size_t>> pairs;
+  double cell = 0.0;
+  for (size_t i = 0;i < links.size ();++i)
+  {
+    Link link = links[i];
+    if ((link.GetExcludedState () & BEYOND_DISTANCE) == 0)
+    {
+      candidates[i] = intervals;
+      continue;
+    }
+    uint32_t ends[2];
+    for (size_t j = 0;j < 2;++j)
+    {
+      const Object* object = link.GetTurntable (j)->GetObject ();
+      std::map<const Object*, uint32_t>::iterator it = indices.find (object);
+      if (it == indices.end ())
+      {
+        it = indices.insert (std::make_pair (object, (uint32_t) objects.size ())).first;
+        objects.push_back (object);
+      }
+      ends[j] = it->second;
+    }
+    srcs.push_back (ends[0]);
+    dsts.push_back (ends[1]);
+    pairs[(uint64_t) ends[0] << 32 | ends[1]].push_back (i);
+    cell = std::max (cell, link.GetMaxDistance () + K_COARSE_MARGIN);
+  }
+  if (pairs.empty ())
+  {
+    return candidates;
+  }
+  std::sort (srcs.begin (), srcs.end ());
+  srcs.erase (std::unique (srcs.begin (), srcs.end ()), srcs.end ());
+  std::sort (dsts.begin (), dsts.end ());
+  dsts.erase (std::unique (dsts.begin (), dsts.end ()), dsts.end ());
+  std::vector<TrajectoryBuffer> trajectories (objects.size ());
+  DateTime epoch = links.front ().GetEpoch ();
+  cpu::ParallelFor (objects.size (), [&] (size_t begin, size_t end)
+  {
+    for (size_t i = begin;i < end;++i)
+    {
+      cpu::CalcTrajectory (objects[i], intervals, epoch, Minute, trajectories[i]);
+    }
+  });
+  // the links that both ends are close enough at every coarse time
+  size_t num = Interval::GetTotalTicks (intervals, Minute);
+  std::vector<std::vector<size_t>> visibles (num);
+  cpu::ParallelFor (num, [&] (size_t begin, size_t end)
+  {
+    std::unordered_map<int64_t, std::vector<uint32_t>> grid;
+    for (size_t k = begin;k < end;++k)
+    {
+      grid.clear ();
+      for (uint32_t dst : dsts)
+      {
+        const Vector& p = trajectories[dst].pos[k];
+        grid[GetCellKey (std::floor (p.x / cell), std::floor (p.y / cell), std::floor (p.z / cell))].push_back (dst);
+      }
+      for (uint32_t src : srcs)
+      {
+        const Vector& p = trajectories[src].pos[k];
+        int64_t x = std::floor (p.x / cell);
+        int64_t y = std::floor (p.y / cell);
+        int64_t z = std::floor (p.z / cell);
+        for (int64_t dx = -1;dx <= 1;++dx)
+        for (int64_t dy = -1;dy <= 1;++dy)
+        for (int64_t dz = -1;dz <= 1;++dz)
+        {
+          std::unordered_map<int64_t, std::vector<uint32_t>>::const_iterator c = grid.find (GetCellKey (x + dx, y + dy, z + dz));
+          if (c == grid.end ())
+          {
+            continue;
+          }
+          for (uint32_t dst : c->second)
+          {
+            std::unordered_map<uint64_t, std::vector<size_t>>::const_iterator it = pairs.find ((uint64_t) src << 32 | dst);
+            if (it == pairs.end ())
+            {
+              continue;
+            }
+            const Vector& q = trajectories[dst].pos[k];
+            double distance = std::sqrt ((p.x - q.x) * (p.x - q.x) + (p.y - q.y) * (p.y - q.y) + (p.z - q.z) * (p.z - q.z));
+            for (size_t i : it->second)
+            {
+              if (distance <= links[i].GetMaxDistance () + K_COARSE_MARGIN)
+              {
+                visibles[k].push_back (i);
+              }
+            }
+          }
+        }
+      }
+    }
+  });
+  // the runs of close times are widened by a coarse step to keep the rejected samples around the edges
+  std::vector<int64_t> last (links.size (), -2);
+  size_t k = 0;
+  for (const Interval& interval : intervals)
+  {
+    int64_t n = interval.GetTicks (Minute);
+    for (int64_t t = 0;t < n;++t, ++k)
+    {
+      for (size_t i : visibles[k])
+      {
+        DateTime start = interval.GetStart () + TimeSpan (std::max (t - 1, (int64_t) 0) * Minute.Ticks ());
+        DateTime stop = t + 1 < n ? interval.GetStart () + TimeSpan ((t + 1) * Minute.Ticks ()) : interval.GetStop ();
+        if (last[i] >= t - 2 && !candidates[i].empty ())
+        {
+          candidates[i].back ().SetStop (stop);
+        }
+        else
+        {
+          candidates[i].push_back (Interval (start, stop));
+        }
+        last[i] = t;
+      }
+    }
+    std::fill (last.begin (), last.end (), -2);
+  }
+  return candidates;
+}
+
+/**
+ * \brief Calculate the link data with the fine step inside the candidate intervals.
+ *
+ * The time is split into chunks, in every chunk each end is propagated once in the
+ * union of the candidate intervals of its links, and the links read the shared trajectories.
+ * The windows cut by the chunks are joined again, so the result is the same as
+ * calculating every link alone.
+ * \param[in]  links      the links, they share the same epoch and step
+ * \param[in]  intervals  the intervals to be calculated, whose starts anchor the step grid
+ * \param[in]  coarse     the candidate intervals of every link
+ * \param[out] results    the link data of every link
+ */
+void
+CalcFineLinkData (const Links& links, const Intervals& intervals, const std::vector<Intervals>& coarse, std::vector<LinkInfoList>& results)
+{
+  const TimeSpan step = links.front ().GetStep ();
+  // the candidates start on the step grid of the interval containing them,
+  // which is the grid of calculating every link alone
+  std::vector<Intervals> candidates (coarse.size ());
+  for (size_t i = 0;i < coarse.size ();++i)
+  {
+    for (const Interval& candidate : coarse[i])
+    {
+      int64_t start = candidate.GetStart ().Ticks ();
+      int64_t anchor = start;
+      for (const Interval& interval : intervals)
+      {
+        if (interval.GetStart ().Ticks () <= start && start <= interval.GetStop ().Ticks ())
+        {
+          anchor = interval.GetStart ().Ticks ();
+          break;
+        }
+      }
+      start = anchor + (start - anchor + step.Ticks () - 1) / step.Ticks () * step.Ticks ();
+      if (start <= candidate.GetStop ().Ticks ())
+      {
+        candidates[i].push_back (Interval (DateTime (start), candidate.GetStop ()));
+      }
+    }
+  }
+  std::vector<const Object*> objects;
+  std::map<const Object*, uint32_t> indices;
+  std::vector<uint32_t> ends (links.size () * 2);
+  DateTime begin, end;
+  bool isEmpty = true;
+  for (size_t i = 0;i < links.size ();++i)
+  {
+    if (candidates[i].empty ())
+    {
+      continue;
+    }
+    Link link = links[i];
+    for (size_t j = 0;j < 2;++j)
+    {
+      const Object* object = link.GetTurntable (j)->GetObject ();
+      std::map<const Object*, uint32_t>::iterator it = indices.find (object);
+      if (it == indices.end ())
+      {
+        it = indices.insert (std::make_pair (object, (uint32_t) objects.size ())).first;
+        objects.push_back (object);
+      }
+      ends[i * 2 + j] = it->second;
+    }
+    if (isEmpty || candidates[i].front ().GetStart () < begin)
+    {
+      begin = candidates[i].front ().GetStart ();
+    }
+    if (isEmpty || candidates[i].back ().GetStop () > end)
+    {
+      end = candidates[i].back ().GetStop ();
+    }
+    isEmpty = false;
+  }
+  if (isEmpty)
+  {
+    return;
+  }
+  DateTime epoch = links.front ().GetEpoch ();
+  std::vector<size_t> lasts (links.size (), candidates.size ());
+  std::vector<std::vector<Piece>> pieces (links.size ());
+  std::vector<Intervals> unions (objects.size ());
+  std::vector<std::vector<size_t>> offsets (objects.size ());
+  std::vector<TrajectoryBuffer> trajectories (objects.size ());
+  for (DateTime chunk = begin;chunk <= end;chunk = chunk + K_CHUNK)
+  {
+    int64_t first = chunk.Ticks ();
+    int64_t last = (chunk + K_CHUNK).Ticks () - 1;
+    for (size_t k = 0;k < objects.size ();++k)
+    {
+      unions[k].clear ();
+    }
+    for (size_t i = 0;i < links.size ();++i)
+    {
+      pieces[i].clear ();
+      for (size_t c = 0;c < candidates[i].size ();++c)
+      {
+        int64_t start = candidates[i][c].GetStart ().Ticks ();
+        int64_t stop = std::min (candidates[i][c].GetStop ().Ticks (), last);
+        if (start < first)
+        {
+          start += (first - start + step.Ticks () - 1) / step.Ticks () * step.Ticks ();
+        }
+        if (start > stop)
+        {
+          continue;
+        }
+        Interval interval = Interval (DateTime (start), DateTime (stop));
+        pieces[i].push_back (Piece {interval, c});
+        unions[ends[i * 2]].push_back (interval);
+        unions[ends[i * 2 + 1]].push_back (interval);
+      }
+    }
+    // the intervals of an object are merged when they are on the same step grid
+    for (size_t k = 0;k < objects.size ();++k)
+    {
+      Intervals& intervals = unions[k];
+      std::sort (intervals.begin (), intervals.end ());
+      Intervals merged;
+      for (const Interval& interval : intervals)
+      {
+        if (!merged.empty ()
+          && interval.GetStart () <= merged.back ().GetStop () + step
+          && (interval.GetStart () - merged.back ().GetStart ()).Ticks () % step.Ticks () == 0)
+        {
+          merged.back ().SetStop (std::max (merged.back ().GetStop (), interval.GetStop ()));
+        }
+        else
+        {
+          merged.push_back (interval);
+        }
+      }
+      intervals.swap (merged);
+      offsets[k].assign (1, 0);
+      for (const Interval& interval : intervals)
+      {
+        offsets[k].push_back (offsets[k].back () + interval.GetTicks (step));
+      }
+    }
+    cpu::ParallelFor (objects.size (), [&] (size_t begin, size_t end)
+    {
+      for (size_t k = begin;k < end;++k)
+      {
+        if (!unions[k].empty ())
+        {
+          cpu::CalcTrajectory (objects[k], unions[k], epoch, step, trajectories[k]);
+        }
+      }
+    });
+    cpu::ParallelFor (links.size (), [&] (size_t begin, size_t end)
+    {
+      for (size_t i = begin;i < end;++i)
+      {
+        Link link = links[i];
+        for (const Piece& piece : pieces[i])
+        {
+          uint32_t src = ends[i * 2];
+          uint32_t dst = ends[i * 2 + 1];
+          link.SetIntervalList (Intervals (1, piece.interval));
+          LinkInfoList infos = link.CalcLinkData (
+            trajectories[src].GetView (GetOffset (unions[src], offsets[src], piece.interval, step)),
+            trajectories[dst].GetView (GetOffset (unions[dst], offsets[dst], piece.interval, step))
+          );
+          LinkInfoList::iterator it = infos.begin ();
+          // the window cut by the chunk continues at the next sample of the same candidate
+          if (it != infos.end () && lasts[i] == piece.candidate && !results[i].empty ()
+            && results[i].back ().linkDatas.back ().time + step == it->linkDatas.front ().time)
+          {
+            LinkDatas& datas = results[i].back ().linkDatas;
+            datas.insert (datas.end (), it->linkDatas.begin (), it->linkDatas.end ());
+            ++it;
+          }
+          results[i].insert (results[i].end (), std::make_move_iterator (it), std::make_move_iterator (infos.end ()));
+          lasts[i] = piece.candidate;
+        }
+      }
+    });
+  }
+}
+
+} // namespace
+
+void
+LinkHelper::SetInterval (const Interval& interval)
+{
+  m_intervals.clear ();
+  m_intervals.push_back (interval);
+}
+
+void
+LinkHelper::SetIntervalList (const Intervals& intervals)
+{
+  m_intervals = intervals;
+}
+
+const Intervals&
+LinkHelper::GetIntervalList () const
+{
+  return m_intervals;
+}
+
+void
+LinkHelper::AddLink (const Link& link)
+{
+  if (!IsExist (link))
+  {
+    m_links.push_back (link);
+  }
+}
+
+LinkInfoList&
+LinkHelper::CalcLink ()
+{
+  m_linkDatas.clear ();
+  std::vector<LinkInfoList> results (m_links.size ());
+  // the trajectories of the grid are propagated from the epoch of links, and the
+  // fine trajectories are shared on the step grid of links, so the links of
+  // different epochs or steps are calculated in separate groups
+  typedef std::pair<int64_t, int64_t> GroupKey;
+  std::map<GroupKey, std::vector<size_t>> groups;
+  for (size_t i = 0;i < m_links.size ();++i)
+  {
+    groups[GroupKey (m_links[i].GetEpoch ().Ticks (), m_links[i].GetStep ().Ticks ())].push_back (i);
+  }
+  for (const std::pair<const GroupKey, std::vector<size_t>>& group : groups)
+  {
+    Links links;
+    for (size_t i : group.second)
+    {
+      links.push_back (m_links[i]);
+    }
+    std::vector<Intervals> intervals = CalcCandidateInterval (links, m_intervals);
+    // every link is calculated with the fine step inside its candidate intervals, which
+    // are the only coarse screening safe for all states, so the result is the full scan's
+    std::vector<LinkInfoList> infos (links.size ());
+    CalcFineLinkData (links, m_intervals, intervals, infos);
+    for (size_t k = 0;k < group.second.size ();++k)
+    {
+      results[group.second[k]].swap (infos[k]);
+    }
+  }
+  for (size_t i = 0;i < results.size ();++i)
+  {
+    m_linkDatas.insert (
+      m_linkDatas.end (),
+      std::make_move_iterator (results[i].begin ()),
+      std::make_move_iterator (results[i].end ())
+    );
+  }
+  return m_linkDatas;
+}
+
+bool
+LinkHelper::IsExist (Link link)
+{
+  return std::find (m_links.begin (), m_links.end (), link) != m_links.end ();
+}
+
+}
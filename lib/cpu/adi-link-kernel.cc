@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <cmath>
+#include "adi-util.h"
+#include "adi-constant.h"
+#include "adi-cpu.h"
+#include "adi-cpu-kernel.h"
+
+namespace adi {
+namespace cpu {
+namespace link {
+
+namespace {
+
+/**
+ * \return true if the object is lit by the sun, the satellite is checked
+ * with the cylindrical shadow of the earth, the station with the local horizon
+ */
+bool
+IsDay (const Vector& pos, const Vector& sun, bool isEarth)
+{
+  if (isEarth)
+  {
+    return Dot (pos, sun) > 0.0;
+  }
+  Vector dir = sun;
+  Normalize (dir);
+  double proj = Dot (pos, dir);
+  if (proj >= 0.0)
+  {
+    return true;
+  }
+  Scale (dir, proj);
+  return Norm (pos - dir) > K_RE;
+}
+
+/**
+ * \return true if the line of sight between two satellites is blocked by the earth
+ */
+bool
+IsBlocked (const Vector& src, const Vector& dst)
+{
+  Vector r = dst - src;
+  double t = -Dot (src, r) / Dot (r, r);
+  if (t <= 0.0 || t >= 1.0)
+  {
+    return false;
+  }
+  Scale (r, t);
+  return Norm (src + r) < K_RE;
+}
+
+/**
+ * \brief Calculate the state of one time, the views in faces are returned
+ */
+uint8_t
+CalcState (
+  const Vector&         srcPos,
+  const Matrix&         srcMat,
+  Vec2Vec               srcOp,
+  const PointingBound&  srcBound,
+  bool                  srcEarth,
+  const Vector&         dstPos,
+  const Matrix&         dstMat,
+  Vec2Vec               dstOp,
+  const PointingBound&  dstBound,
+  bool                  dstEarth,
+  const Vector&         sunPos,
+  double                maxDistance,
+  const PointingBound&  FOV,
+  Vector&               srcDir,
+  Vector&               dstDir,
+  double&               range)
+{
+  uint8_t state = 0;
+  Vector r = dstPos - srcPos;
+  Vector rr = -r;
+  range = Norm (r);
+  srcDir = srcOp (const_cast<Matrix&> (srcMat) * r);
+  dstDir = dstOp (const_cast<Matrix&> (dstMat) * rr);
+  if (range > maxDistance)
+  {
+    state |= BEYOND_DISTANCE;
+  }
+  if (IsDay (srcPos, sunPos, srcEarth))
+  {
+    state |= SRC_DAY;
+  }
+  if (IsDay (dstPos, sunPos, dstEarth))
+  {
+    state |= DST_DAY;
+  }
+  bool blocked = !srcEarth && !dstEarth && IsBlocked (srcPos, dstPos);
+  Direction srcView = View (srcDir);
+  Direction dstView = View (dstDir);
+  if (!blocked && srcDir.x > 0.0 && IsInside (srcView, srcBound))
+  {
+    state |= SRC2DST;
+  }
+  if (!blocked && dstDir.x > 0.0 && IsInside (dstView, dstBound))
+  {
+    state |= DST2SRC;
+  }
+  if (srcDir.x > 0.0 && dstDir.x > 0.0 && IsInside (srcView, FOV) && IsInside (dstView, FOV))
+  {
+    state |= IN_FOV;
+  }
+  return state;
+}
+
+} // namespace
+
+void
+CalcLink (
+  uint8_t*      state,
+  const Vector* srcPos,
+  const Matrix* srcMat,
+  Vec2Vec       srcOp,
+  PointingBound srcBound,
+  bool          srcEarth,
+  const Vector* dstPos,
+  const Matrix* dstMat,
+  Vec2Vec       dstOp,
+  PointingBound dstBound,
+  bool          dstEarth,
+  const Vector* sunPos,
+  double        maxDistance,
+  PointingBound FOV,
+  size_t        depth)
+{
+  ParallelFor (depth, [=] (size_t begin, size_t end)
+  {
+    Vector srcDir, dstDir;
+    double range;
+    for (size_t k = begin;k < end;++k)
+    {
+      state[k] = CalcState (
+        srcPos[k], srcMat[k], srcOp, srcBound, srcEarth,
+        dstPos[k], dstMat[k], dstOp, dstBound, dstEarth,
+        sunPos[k], maxDistance, FOV, srcDir, dstDir, range);
+    }
+  }, 64);
+}
+
+void
+CalcLinkData (
+  uint8_t*      state,
+  const Vector* srcPos,
+  const Vector* srcVel,
+  const Matrix* srcMat,
+  const Matrix* srcDMat,
+  Vec2Vec       srcOp,
+  PointingBound srcBound,
+  bool          srcEarth,
+  Pointing*     srcView,
+  const Vector* dstPos,
+  const Vector* dstVel,
+  const Matrix* dstMat,
+  const Matrix* dstDMat,
+  Vec2Vec       dstOp,
+  PointingBound dstBound,
+  bool          dstEarth,
+  Pointing*     dstView,
+  double*       range,
+  const Vector* sunPos,
+  double        maxDistance,
+  PointingBound FOV,
+  size_t        depth)
+{
+  ParallelFor (depth, [=] (size_t begin, size_t end)
+  {
+    Vector srcDir, dstDir;
+    for (size_t k = begin;k < end;++k)
+    {
+      state[k] = CalcState (
+        srcPos[k], srcMat[k], srcOp, srcBound, srcEarth,
+        dstPos[k], dstMat[k], dstOp, dstBound, dstEarth,
+        sunPos[k], maxDistance, FOV, srcDir, dstDir, range[k]);
+      // d(M * r) / dt = dM * r + M * dr, both transforms are linear
+      Vector r = dstPos[k] - srcPos[k];
+      Vector v = dstVel[k] - srcVel[k];
+      Matrix sm = srcMat[k], sdm = srcDMat[k];
+      Matrix dm = dstMat[k], ddm = dstDMat[k];
+      Vector rr = -r, vv = -v;
+      Vector srcRate = srcOp ((sdm * r) + (sm * v));
+      Vector dstRate = dstOp ((ddm * rr) + (dm * vv));
+      srcView[k] = View (srcDir, srcRate);
+      dstView[k] = View (dstDir, dstRate);
+    }
+  }, 64);
+}
+
+} // namespace link
+} // namespace cpu
+} // namespace adi
@@ -0,0 +1,353 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <utility>
+#include "adi-link.h"
+#include "adi-turntable.h"
+#include "adi-satellite.h"
+#include "adi-cpu-kernel.h"
+
+namespace adi {
+
+namespace {
+
+// the boresight of every face is the x axis of the face coordinate
+
+Vector
+Body2Left (const Vector& v)
+{
+  return Vector {-v.y, v.x, v.z};
+}
+
+Vector
+Body2Right (const Vector& v)
+{
+  return Vector {v.y, -v.x, v.z};
+}
+
+Vector
+Body2Front (const Vector& v)
+{
+  return Vector {v.x, v.y, v.z};
+}
+
+Vector
+Body2Back (const Vector& v)
+{
+  return Vector {-v.x, -v.y, v.z};
+}
+
+Vector
+Body2Top (const Vector& v)
+{
+  return Vector {-v.z, -v.y, v.x};
+}
+
+Vector
+Body2Bottom (const Vector& v)
+{
+  return Vector {v.z, v.y, -v.x};
+}
+
+/**
+ * \brief Calculate the ticks of the interval list and the sun at them
+ */
+void
+CalcLinkTime (
+  std::vector<int64_t>& ticks,
+  std::vector<Vector>&  sun,
+  const Intervals&      intervals,
+  const DateTime&       epoch,
+  const TimeSpan&       step)
+{
+  ticks = Interval::CreateTicks (intervals, epoch, step);
+  sun.resize (ticks.size ());
+  size_t k = 0;
+  for (const Interval& interval : intervals)
+  {
+    size_t n = interval.GetTicks (step);
+    cpu::sun::GetEciPosition (sun.data () + k, interval.GetStart ().Ticks (), step.Ticks (), n);
+    k += n;
+  }
+}
+
+} // namespace
+
+Link::Link ()
+: m_epoch         (J2000)
+, m_step          (Second)
+, m_src           (NULL)
+, m_dst           (NULL)
+, m_maxDistance   (K_MAX_DISTANCE)
+, m_includedState (SRC2DST | DST2SRC)
+, m_excludedState (SRC_DAY | DST_DAY)
+{
+}
+
+Link::Link (
+  Turntable* src,
+  Turntable* dst,
+  uint8_t included,
+  uint8_t excluded)
+: m_epoch         (J2000)
+, m_step          (Second)
+, m_src           (src)
+, m_dst           (dst)
+, m_maxDistance   (K_MAX_DISTANCE)
+, m_includedState (included)
+, m_excludedState (excluded)
+{
+}
+
+Link::~Link ()
+{
+}
+
+void
+Link::SetIntervalList (const Intervals& intervals)
+{
+  m_intervals = intervals;
+}
+
+const Intervals&
+Link::AddInterval (const Interval& interval)
+{
+  interval.InsertToList (m_intervals);
+  return m_intervals;
+}
+
+const Intervals&
+Link::GetIntervalList () const
+{
+  return m_intervals;
+}
+
+void
+Link::SetEpoch (const DateTime& epoch)
+{
+  m_epoch = epoch;
+}
+
+const DateTime&
+Link::GetEpoch () const
+{
+  return m_epoch;
+}
+
+void
+Link::SetStep (const TimeSpan& step)
+{
+  m_step = step;
+}
+
+const TimeSpan&
+Link::GetStep () const
+{
+  return m_step;
+}
+
+void
+Link::SetMaxDistance (const double& maxDistance)
+{
+  m_maxDistance = maxDistance;
+}
+
+const double&
+Link::GetMaxDistance () const
+{
+  return m_maxDistance;
+}
+
+Intervals
+Link::CalcLinkInterval ()
+{
+  Intervals intervals;
+  const Object* src = m_src->GetObject ();
+  const Object* dst = m_dst->GetObject ();
+  std::vector<int64_t> ticks;
+  std::vector<Vector> sun;
+  CalcLinkTime (ticks, sun, m_intervals, m_epoch, m_step);
+  TrajectoryBuffer srcTraj, dstTraj;
+  cpu::CalcTrajectory (src, m_intervals, m_epoch, m_step, srcTraj);
+  cpu::CalcTrajectory (dst, m_intervals, m_epoch, m_step, dstTraj);
+  Vec2Vec srcOp, dstOp;
+  FaceTransform (srcOp, m_src->GetFace ());
+  FaceTransform (dstOp, m_dst->GetFace ());
+  States states (ticks.size ());
+  cpu::link::CalcLink (
+    states.data (),
+    srcTraj.pos.data (), srcTraj.mat.data (), srcOp, m_src->GetPointingBound (), src->GetType () == Object::STATION,
+    dstTraj.pos.data (), dstTraj.mat.data (), dstOp, m_dst->GetPointingBound (), dst->GetType () == Object::STATION,
+    sun.data (), m_maxDistance, K_FOV, states.size ());
+  size_t k = 0;
+  for (const Interval& interval : m_intervals)
+  {
+    size_t n = interval.GetTicks (m_step);
+    bool isOpen = false;
+    Interval current;
+    for (size_t i = 0;i < n;++i, ++k)
+    {
+      DateTime time (ticks[k]);
+      if (IsAcceptedState (states[k]))
+      {
+        if (!isOpen)
+        {
+          current.SetStart (time);
+          isOpen = true;
+        }
+        current.SetStop (time);
+      }
+      else if (isOpen)
+      {
+        intervals.push_back (current);
+        isOpen = false;
+      }
+    }
+    if (isOpen)
+    {
+      intervals.push_back (current);
+    }
+  }
+  return intervals;
+}
+
+LinkInfoList
+Link::CalcLinkData ()
+{
+  TrajectoryBuffer srcTraj, dstTraj;
+  cpu::CalcTrajectory (m_src->GetObject (), m_intervals, m_epoch, m_step, srcTraj);
+  cpu::CalcTrajectory (m_dst->GetObject (), m_intervals, m_epoch, m_step, dstTraj);
+  return CalcLinkData (srcTraj.GetView (), dstTraj.GetView ());
+}
+
+LinkInfoList
+Link::CalcLinkData (const TrajectoryView& srcTraj, const TrajectoryView& dstTraj)
+{
+  LinkInfoList infos;
+  const Object* src = m_src->GetObject ();
+  const Object* dst = m_dst->GetObject ();
+  std::vector<int64_t> ticks;
+  std::vector<Vector> sun;
+  CalcLinkTime (ticks, sun, m_intervals, m_epoch, m_step);
+  Vec2Vec srcOp, dstOp;
+  FaceTransform (srcOp, m_src->GetFace ());
+  FaceTransform (dstOp, m_dst->GetFace ());
+  size_t num = ticks.size ();
+  States states (num);
+  std::vector<Pointing> srcView (num);
+  std::vector<Pointing> dstView (num);
+  std::vector<double> range (num);
+  cpu::link::CalcLinkData (
+    states.data (),
+    srcTraj.pos, srcTraj.vel, srcTraj.mat, srcTraj.dmat,
+    srcOp, m_src->GetPointingBound (), src->GetType () == Object::STATION, srcView.data (),
+    dstTraj.pos, dstTraj.vel, dstTraj.mat, dstTraj.dmat,
+    dstOp, m_dst->GetPointingBound (), dst->GetType () == Object::STATION, dstView.data (),
+    range.data (), sun.data (), m_maxDistance, K_FOV, num);
+  size_t k = 0;
+  for (const Interval& interval : m_intervals)
+  {
+    size_t n = interval.GetTicks (m_step);
+    LinkInfo info {m_src, m_dst, LinkDatas ()};
+    for (size_t i = 0;i < n;++i, ++k)
+    {
+      if (IsAcceptedState (states[k]))
+      {
+        LinkData data {states[k], DateTime (ticks[k]), srcView[k], dstView[k], range[k]};
+        info.linkDatas.push_back (data);
+      }
+      else if (!info.linkDatas.empty ())
+      {
+        infos.push_back (std::move (info));
+        info.linkDatas.clear ();
+      }
+    }
+    if (!info.linkDatas.empty ())
+    {
+      infos.push_back (std::move (info));
+    }
+  }
+  return infos;
+}
+
+Satellite*
+Link::GetSatellite (size_t i)
+{
+  Turntable* turntable = GetTurntable (i);
+  if (turntable == NULL || turntable->GetObject ()->GetType () != Object::SATELLITE)
+  {
+    return NULL;
+  }
+  return static_cast<Satellite*> (turntable->GetObject ());
+}
+
+Turntable*
+Link::GetTurntable (size_t i)
+{
+  return i == 0 ? m_src : m_dst;
+}
+
+Face
+Link::GetFace (size_t i) const
+{
+  Turntable* turntable = i == 0 ? m_src : m_dst;
+  return turntable == NULL ? ErrFace : turntable->GetFace ();
+}
+
+bool
+Link::operator== (const Link& link)
+{
+  return m_src == link.m_src && m_dst == link.m_dst;
+}
+
+void
+Link::SetIncludedState (uint8_t included)
+{
+  m_includedState = included;
+}
+
+void
+Link::SetExcludedState (uint8_t excluded)
+{
+  m_excludedState = excluded;
+}
+
+void
+Link::FaceTransform (Vec2Vec& host, Face face)
+{
+  switch (face)
+  {
+    case Left:    host = &Body2Left;   break;
+    case Right:   host = &Body2Right;  break;
+    case Front:   host = &Body2Front;  break;
+    case Back:    host = &Body2Back;   break;
+    case Top:     host = &Body2Top;    break;
+    case Bottom:  host = &Body2Bottom; break;
+    default:      host = &Body2Front;  break;
+  }
+}
+
+bool
+Link::IsAcceptedState (const uint8_t& state) const
+{
+  return (state & m_includedState) == m_includedState && (state & m_excludedState) == 0;
+}
+
+}
@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include "adi-object.h"
+#include "adi-turntable.h"
+#include "adi-constant.h"
+#include "adi-satellite.h"
+#include "adi-station.h"
+#include "adi-cpu-kernel.h"
+
+namespace adi {
+
+Object::Object ()
+: m_ns3   (NULL)
+, m_epoch (J2000)
+, m_step  (Second)
+, m_uid   (0)
+, d_pos   (NULL)
+, d_vel   (NULL)
+, d_mat   (NULL)
+{
+}
+
+Object::Object (const Object& obj)
+: m_ns3         (obj.m_ns3)
+, m_epoch       (obj.m_epoch)
+, m_step        (obj.m_step)
+, m_intervals   (obj.m_intervals)
+, m_uid         (obj.m_uid)
+, m_turntables  (obj.m_turntables)
+, m_name        (obj.m_name)
+, d_pos         (NULL)
+, d_vel         (NULL)
+, d_mat         (NULL)
+{
+}
+
+Object::~Object ()
+{
+}
+
+void
+Object::SetEpoch (const DateTime& epoch)
+{
+  m_epoch = epoch;
+}
+
+const DateTime&
+Object::GetEpoch () const
+{
+  return m_epoch;
+}
+
+void
+Object::SetStep (const TimeSpan& step)
+{
+  m_step = step;
+}
+
+const TimeSpan&
+Object::GetStep () const
+{
+  return m_step;
+}
+
+void
+Object::SetIntervalList (const Intervals& intervals)
+{
+  m_intervals = intervals;
+}
+
+const Intervals&
+Object::AddInterval (const Interval& interval)
+{
+  interval.InsertToList (m_intervals);
+  return m_intervals;
+}
+
+const Intervals&
+Object::GetIntervalList () const
+{
+  return m_intervals;
+}
+
+Turntable*
+Object::Install (const Face& face, const PointingBound& bound)
+{
+  if (m_turntables.find (face) != m_turntables.end ())
+  {
+    return NULL;
+  }
+  Turntable* turntable = new Turntable ();
+  turntable->SetFace (face);
+  turntable->SetObject (this);
+  turntable->SetPointingBound (bound);
+  m_turntables[face] = turntable;
+  return turntable;
+}
+
+Turntable*
+Object::GetTurntable (const Face& face)
+{
+  TurntableList::iterator it = m_turntables.find (face);
+  if (it == m_turntables.end ())
+  {
+    return NULL;
+  }
+  return it->second;
+}
+
+void
+Object::SetNs3 (void* ns3)
+{
+  m_ns3 = ns3;
+}
+
+void*
+Object::GetNs3 () const
+{
+  return m_ns3;
+}
+
+size_t
+Object::GetIntervalTicks () const
+{
+  return Interval::GetTotalTicks (m_intervals, m_step);
+}
+
+void
+TrajectoryBuffer::Resize (size_t n)
+{
+  pos.resize (n);
+  vel.resize (n);
+  mat.resize (n);
+  dmat.resize (n);
+}
+
+Trajectory
+TrajectoryBuffer::Get ()
+{
+  return Trajectory {pos.data (), vel.data (), mat.data (), pos.size ()};
+}
+
+TrajectoryView
+TrajectoryBuffer::GetView (size_t offset) const
+{
+  return TrajectoryView {pos.data () + offset, vel.data () + offset, mat.data () + offset, dmat.data () + offset};
+}
+
+namespace cpu {
+
+void
+CalcTrajectory (
+  const Object*     obj,
+  const Intervals&  intervals,
+  const DateTime&   epoch,
+  const TimeSpan&   step,
+  TrajectoryBuffer& buffer)
+{
+  if (obj->GetType () == Object::SATELLITE)
+  {
+    std::vector<double> seconds = Interval::CreateSeconds (intervals, epoch, step);
+    SatelliteHelper::CalcTrajectory (*static_cast<const Satellite*> (obj), epoch, seconds.data (), seconds.size (), buffer);
+  }
+  else
+  {
+    std::vector<int64_t> ticks = Interval::CreateTicks (intervals, epoch, step);
+    StationHelper::CalcTrajectory (*static_cast<const Station*> (obj), ticks.data (), ticks.size (), buffer);
+  }
+}
+
+} // namespace cpu
+}
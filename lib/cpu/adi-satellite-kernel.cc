@@ -0,0 +1,419 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+#include "adi-util.h"
+#include "adi-constant.h"
+#include "adi-cpu.h"
+#include "adi-cpu-kernel.h"
+
+namespace adi {
+namespace cpu {
+
+AlignedArray::AlignedArray ()
+: m_data  (NULL)
+, m_n     (0)
+{
+}
+
+AlignedArray::~AlignedArray ()
+{
+  free (m_data);
+}
+
+void
+AlignedArray::Resize (size_t n)
+{
+  if (n == m_n)
+  {
+    return;
+  }
+  free (m_data);
+  m_data = NULL;
+  m_n = 0;
+  if (n == 0)
+  {
+    return;
+  }
+  void* ptr = NULL;
+  if (posix_memalign (&ptr, ALIGNMENT, n * sizeof (double)) != 0)
+  {
+    throw std::bad_alloc ();
+  }
+  m_data = static_cast<double*> (ptr);
+  m_n = n;
+}
+
+namespace satellite {
+
+namespace {
+
+/**
+ * \brief Get the number of Newton's iterations of Kepler's equation, starting from
+ * E = M + e * sin (M) the error is about e^2 and it is squared by every iteration,
+ * the number is a constant of satellite so that the loop over times has no branch
+ * \param[in] ecc the eccentricity
+ * \return the number of iterations to reach the double precision
+ */
+int
+GetKeplerIterations (double ecc)
+{
+  int n = 0;
+  for (double err = ecc * ecc;err > 1e-16 && n < 8;err = err * err / (1.0 - ecc))
+  {
+    ++n;
+  }
+  return n;
+}
+
+/**
+ * \brief Round to the nearest integer by adding and subtracting 1.5 * 2^52,
+ * unlike floor it is vectorized without SSE4.1 and the fast math flags
+ * \param[in] x the value whose magnitude is less than 2^51
+ * \return the nearest integer
+ */
+inline double
+Round (double x)
+{
+  const double shift = 6755399441055744.0;
+  return (x + shift) - shift;
+}
+
+/**
+ * \brief Wrap the angle into [0, 2 * PI) as WrapTwoPI, but inlined and
+ * without floor, so that the loops calling it can be vectorized
+ * \param[in] x the angle
+ * \return the wrapped angle
+ */
+inline double
+WrapAngle (double x)
+{
+  double r = x - 2.0 * M_PI * Round (x * (0.5 / M_PI));
+  return r < 0.0 ? r + 2.0 * M_PI : r;
+}
+
+/**
+ * \brief Calculate the sine and cosine without any libm call or branch, so that
+ * the loops calling it are vectorized without the vector math library.
+ * The angle is reduced by PI / 2 in three parts (Cody-Waite) and the minimax
+ * polynomials of Cephes are evaluated in [-PI / 4, PI / 4], the error is
+ * within 2 ulp for the angles of a few turns used by the orbital states.
+ * \param[in]  x the angle
+ * \param[out] s the sine
+ * \param[out] c the cosine
+ */
+inline void
+SinCos (double x, double& s, double& c)
+{
+  double q = Round (x * 0.63661977236758134308);
+  double r = x - q * 1.57079625129699707031;
+  r -= q * 7.54978941586159635336e-8;
+  r -= q * 5.39030285815811905290e-15;
+  double z = r * r;
+  double ps = ((((( 1.58962301576546568060e-10  * z
+                  - 2.50507477628578072866e-8)  * z
+                  + 2.75573136213857245213e-6)  * z
+                  - 1.98412698295895385996e-4)  * z
+                  + 8.33333333332211858878e-3)  * z
+                  - 1.66666666666666307295e-1);
+  double pc = ((((( -1.13585365213876817300e-11 * z
+                  + 2.08757008419747316778e-9)  * z
+                  - 2.75573141792967388112e-7)  * z
+                  + 2.48015872888517045348e-5)  * z
+                  - 1.38888888888730564116e-3)  * z
+                  + 4.16666666666665929218e-2);
+  double sr = r + r * z * ps;
+  double cr = 1.0 - 0.5 * z + z * z * pc;
+  // the quadrant swaps sine and cosine and flips their signs
+  int n = (int) q;
+  double swap = (double) (n & 1);
+  double ss = 1.0 - (double) (n & 2);
+  double sc = 1.0 - (double) ((n + 1) & 2);
+  s = ss * (sr + swap * (cr - sr));
+  c = sc * (cr + swap * (sr - cr));
+}
+
+/**
+ * \brief Split the flattened indices [begin, end) into the segments of rows,
+ * f (i, begin, end) is called once per row i, so that the constants of row
+ * are loaded out of the inner loop over times
+ */
+template<class F>
+void
+ForEachRow (size_t begin, size_t end, size_t cols, F f)
+{
+  while (begin < end)
+  {
+    size_t i = begin / cols;
+    size_t stop = std::min (end, (i + 1) * cols);
+    f (i, begin, stop);
+    begin = stop;
+  }
+}
+
+} // namespace
+
+void
+StateArrays::Resize (size_t n)
+{
+  raan.Resize (n);
+  aop.Resize (n);
+  ma.Resize (n);
+  ea.Resize (n);
+  cosTa.Resize (n);
+  sinTa.Resize (n);
+  radius.Resize (n);
+}
+
+void
+CalcState (
+  StateArrays&          state,
+  const Satellite::Par* param,
+  const double*         times,
+  size_t                rows,
+  size_t                cols)
+{
+  double* raan = state.raan.Data ();
+  double* aop = state.aop.Data ();
+  double* ma = state.ma.Data ();
+  ParallelFor (rows, cols, [=] (size_t begin, size_t end)
+  {
+    ForEachRow (begin, end, cols, [=] (size_t i, size_t b, size_t e)
+    {
+      const double raan0 = param[i].elem.raan, draan = param[i].draan;
+      const double aop0 = param[i].elem.aop, daop = param[i].daop;
+      const double ma0 = param[i].elem.ma, dma = param[i].dma;
+      const size_t offset = i * cols;
+      #pragma omp simd
+      for (size_t k = b;k < e;++k)
+      {
+        const double t = times[k - offset];
+        raan[k] = WrapAngle (raan0 + draan * t);
+        aop[k] = WrapAngle (aop0 + daop * t);
+        ma[k] = WrapAngle (ma0 + dma * t);
+      }
+    });
+  });
+}
+
+void
+CalcTureAnomaly (
+  StateArrays&          state,
+  const Satellite::Par* param,
+  size_t                rows,
+  size_t                cols)
+{
+  const double* ma = state.ma.Data ();
+  double* ea = state.ea.Data ();
+  double* cosTa = state.cosTa.Data ();
+  double* sinTa = state.sinTa.Data ();
+  double* radius = state.radius.Data ();
+  ParallelFor (rows, cols, [=] (size_t begin, size_t end)
+  {
+    ForEachRow (begin, end, cols, [=] (size_t i, size_t b, size_t e)
+    {
+      const double ecc = param[i].elem.ecc;
+      const double sma = param[i].elem.sma;
+      const double kq = sqrt (1.0 - ecc * ecc);
+      const int iterations = GetKeplerIterations (ecc);
+      // every Newton's iteration is a pass over the row, the loops have no inner loop
+      #pragma omp simd
+      for (size_t k = b;k < e;++k)
+      {
+        double sM, cM;
+        SinCos (ma[k], sM, cM);
+        ea[k] = ma[k] + ecc * sM;
+      }
+      for (int n = 0;n < iterations;++n)
+      {
+        #pragma omp simd
+        for (size_t k = b;k < e;++k)
+        {
+          double sE, cE;
+          SinCos (ea[k], sE, cE);
+          ea[k] -= (ea[k] - ecc * sE - ma[k]) / (1.0 - ecc * cE);
+        }
+      }
+      // the true anomaly follows from E without any more trigonometric call
+      #pragma omp simd
+      for (size_t k = b;k < e;++k)
+      {
+        double sE, cE;
+        SinCos (ea[k], sE, cE);
+        double q = 1.0 - ecc * cE;
+        cosTa[k] = (cE - ecc) / q;
+        sinTa[k] = kq * sE / q;
+        radius[k] = sma * q;
+      }
+    });
+  });
+}
+
+void
+CalcEciState (
+  Vector*               position,
+  Vector*               velocity,
+  const Satellite::Par* param,
+  const StateArrays&    state,
+  size_t                rows,
+  size_t                cols)
+{
+  const double* raan = state.raan.Data ();
+  const double* aop = state.aop.Data ();
+  const double* cosTa = state.cosTa.Data ();
+  const double* sinTa = state.sinTa.Data ();
+  const double* radius = state.radius.Data ();
+  ParallelFor (rows, cols, [=] (size_t begin, size_t end)
+  {
+    ForEachRow (begin, end, cols, [=] (size_t i, size_t b, size_t e)
+    {
+      const double ecc = param[i].elem.ecc;
+      const double ci = cos (param[i].elem.inc);
+      const double si = sin (param[i].elem.inc);
+      const double kv = sqrt (K_MU / param[i].slr);
+      #pragma omp simd
+      for (size_t k = b;k < e;++k)
+      {
+        // P and Q are the first two columns of the matrix from orbital to eci
+        double cO, sO, cw, sw;
+        SinCos (raan[k], sO, cO);
+        SinCos (aop[k], sw, cw);
+        double cv = cosTa[k],      sv = sinTa[k];
+        double px = cO * cw - sO * sw * ci;
+        double py = sO * cw + cO * sw * ci;
+        double pz = sw * si;
+        double qx = -cO * sw - sO * cw * ci;
+        double qy = -sO * sw + cO * cw * ci;
+        double qz = cw * si;
+        double a = radius[k] * cv, b = radius[k] * sv;
+        double c = -kv * sv, d = kv * (ecc + cv);
+        position[k] = Vector {a * px + b * qx, a * py + b * qy, a * pz + b * qz};
+        velocity[k] = Vector {c * px + d * qx, c * py + d * qy, c * pz + d * qz};
+      }
+    });
+  });
+}
+
+void
+CalcTrajectory (
+  Vector*               position,
+  Vector*               velocity,
+  Matrix*               matrix,
+  Matrix*               derivMatrix,
+  const Satellite::Par* param,
+  const double*         times,
+  size_t                rows,
+  size_t                cols)
+{
+  StateArrays state;
+  state.Resize (rows * cols);
+  CalcState (state, param, times, rows, cols);
+  CalcTureAnomaly (state, param, rows, cols);
+  CalcEciState (position, velocity, param, state, rows, cols);
+  CalcMatrixFromEciToBody (matrix, position, velocity, rows, cols);
+  if (derivMatrix)
+  {
+    CalcDerivMatrixFromEciToBody (derivMatrix, matrix, position, velocity, rows, cols);
+  }
+}
+
+void
+CalcParam (
+  Satellite::Par* param,
+  size_t          rows)
+{
+  for (size_t i = 0;i < rows;++i)
+  {
+    Satellite::Par& par = param[i];
+    const Satellite::Ele& ele = par.elem;
+    double cosi = cos (ele.inc);
+    par.ar = sqrt (K_MU / (ele.sma * ele.sma * ele.sma));
+    par.slr = ele.sma * (1.0 - ele.ecc * ele.ecc);
+    double k = K_J2 * (K_RE / par.slr) * (K_RE / par.slr) * par.ar;
+    par.draan = -1.5 * k * cosi;
+    par.daop = 0.75 * k * (5.0 * cosi * cosi - 1.0);
+    par.dma = par.ar + 0.75 * k * sqrt (1.0 - ele.ecc * ele.ecc) * (3.0 * cosi * cosi - 1.0);
+  }
+}
+
+void
+CalcMatrixFromEciToBody (
+  Matrix*         matrix,
+  Vector*         position,
+  Vector*         velocity,
+  size_t          rows,
+  size_t          cols)
+{
+  ParallelFor (rows, cols, [=] (size_t begin, size_t end)
+  {
+    for (size_t idx = begin;idx < end;++idx)
+    {
+      Vector z = -position[idx];
+      Normalize (z);
+      Vector y = Cross (z, velocity[idx]);
+      Normalize (y);
+      Vector x = Cross (y, z);
+      matrix[idx] = Matrix {x, y, z};
+    }
+  });
+}
+
+void
+CalcDerivMatrixFromEciToBody (
+  Matrix*         derivMatrix,
+  Matrix*         matrix,
+  Vector*         position,
+  Vector*         velocity,
+  size_t          rows,
+  size_t          cols)
+{
+  ParallelFor (rows, cols, [=] (size_t begin, size_t end)
+  {
+    for (size_t idx = begin;idx < end;++idx)
+    {
+      // the body frame rotates with the orbital angular rate, dM = -[w]x * M
+      Vector r = position[idx];
+      Vector w = Cross (r, velocity[idx]);
+      Scale (w, 1.0 / Dot (r, r));
+      Matrix& m = matrix[idx];
+      w = m * w;
+      Matrix& d = derivMatrix[idx];
+      d.r1 = Vector {
+        w.z * m.r2.x - w.y * m.r3.x,
+        w.z * m.r2.y - w.y * m.r3.y,
+        w.z * m.r2.z - w.y * m.r3.z};
+      d.r2 = Vector {
+        w.x * m.r3.x - w.z * m.r1.x,
+        w.x * m.r3.y - w.z * m.r1.y,
+        w.x * m.r3.z - w.z * m.r1.z};
+      d.r3 = Vector {
+        w.y * m.r1.x - w.x * m.r2.x,
+        w.y * m.r1.y - w.x * m.r2.y,
+        w.y * m.r1.z - w.x * m.r2.z};
+    }
+  });
+}
+
+} // namespace satellite
+} // namespace cpu
+} // namespace adi
@@ -0,0 +1,271 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include "Globals.h"
+#include "adi-satellite.h"
+#include "adi-satellite-list.h"
+#include "adi-util.h"
+#include "adi-constant.h"
+#include "adi-cpu-kernel.h"
+
+namespace adi {
+
+std::string
+Satellite::Element::ToString () const
+{
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision (6)
+     << "sma = " << sma << ", ecc = " << ecc
+     << ", inc = " << RadiansToDegrees (inc)
+     << ", raan = " << RadiansToDegrees (raan)
+     << ", aop = " << RadiansToDegrees (aop)
+     << ", ma = " << RadiansToDegrees (ma);
+  return ss.str ();
+}
+
+bool
+Satellite::Element::operator== (Element& ele) const
+{
+  return sma == ele.sma && ecc == ele.ecc && inc == ele.inc
+      && raan == ele.raan && aop == ele.aop && ma == ele.ma;
+}
+
+std::string
+Satellite::Parameter::ToString () const
+{
+  std::stringstream ss;
+  ss << elem.ToString () << std::scientific << std::setprecision (6)
+     << ", ar = " << ar << ", slr = " << slr
+     << ", draan = " << draan << ", daop = " << daop << ", dma = " << dma;
+  return ss.str ();
+}
+
+std::string
+Satellite::State::ToString () const
+{
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision (6)
+     << "radius = " << radius
+     << ", raan = " << RadiansToDegrees (raan)
+     << ", aop = " << RadiansToDegrees (aop)
+     << ", ma = " << RadiansToDegrees (ma)
+     << ", ta = " << RadiansToDegrees (ta)
+     << ", dta = " << dta;
+  return ss.str ();
+}
+
+Satellite::Satellite ()
+: Object ()
+, m_par   (Par {})
+, d_par   (NULL)
+, d_sta   (NULL)
+{
+  Construct ();
+}
+
+Satellite::Satellite (const Satellite& sat)
+: Object  (sat)
+, m_par   (sat.m_par)
+, d_par   (NULL)
+, d_sta   (NULL)
+, m_sgp4  (sat.m_sgp4)
+{
+}
+
+Satellite::~Satellite ()
+{
+  Release ();
+}
+
+void
+Satellite::SetElement (Ele ele)
+{
+  m_par.elem = ele;
+  cpu::satellite::CalcParam (&m_par, 1);
+  m_sgp4.reset ();
+}
+
+void
+Satellite::SetElement (
+  double sma,
+  double ecc,
+  double inc,
+  double raan,
+  double aop,
+  double ma,
+  bool   isDegree)
+{
+  if (isDegree)
+  {
+    inc = DegreesToRadians (inc);
+    raan = DegreesToRadians (raan);
+    aop = DegreesToRadians (aop);
+    ma = DegreesToRadians (ma);
+  }
+  SetElement (Ele {sma, ecc, inc, raan, aop, ma});
+}
+
+bool
+Satellite::SetTle (const Tle& tle)
+{
+  std::shared_ptr<cpu::sgp4::Parameter> sgp4 = std::make_shared<cpu::sgp4::Parameter> ();
+  if (!cpu::sgp4::Initialize (*sgp4, tle))
+  {
+    return false;
+  }
+  SetElement (Ele {sgp4->aodp * kXKMPER, tle.ecc, tle.inc, tle.raan, tle.aop, tle.ma});
+  m_sgp4 = sgp4;
+  return true;
+}
+
+const Tle*
+Satellite::GetTle () const
+{
+  return m_sgp4 ? &m_sgp4->tle : NULL;
+}
+
+std::string
+Satellite::GetName () const
+{
+  return m_name;
+}
+
+size_t
+Satellite::GetId () const
+{
+  return m_uid;
+}
+
+Object::Type
+Satellite::GetType () const
+{
+  return SATELLITE;
+}
+
+Trajectory
+Satellite::CalcTrajectory (Matrix** dmat)
+{
+  Initialzie ();
+  size_t num = GetIntervalTicks ();
+  std::vector<double> seconds = Interval::CreateSeconds (m_intervals, m_epoch, m_step);
+  Matrix* deriv = NULL;
+  if (dmat)
+  {
+    deriv = *dmat = new Matrix[num];
+  }
+  if (m_sgp4)
+  {
+    cpu::sgp4::CalcTrajectory (d_pos, d_vel, d_mat, deriv, m_sgp4.get (), (m_epoch - J2000).TotalMinutes (), seconds.data (), 1, num);
+  }
+  else
+  {
+    cpu::satellite::CalcTrajectory (d_pos, d_vel, d_mat, deriv, d_par, seconds.data (), 1, num);
+  }
+  return Trajectory {d_pos, d_vel, d_mat, num};
+}
+
+Turntable*
+Satellite::GetTurntable (Face face)
+{
+  return Object::GetTurntable (face);
+}
+
+void
+Satellite::Construct ()
+{
+  m_uid = SatelliteList::Add (this);
+  m_name = "SAT" + std::to_string (m_uid);
+}
+
+void
+Satellite::Initialzie ()
+{
+  Release ();
+  size_t num = GetIntervalTicks ();
+  d_par = new Par (m_par);
+  d_pos = new Vector[num];
+  d_vel = new Vector[num];
+  d_mat = new Matrix[num];
+}
+
+void
+Satellite::Release ()
+{
+  delete d_par;
+  delete[] d_sta;
+  delete[] d_pos;
+  delete[] d_vel;
+  delete[] d_mat;
+  d_par = NULL;
+  d_sta = NULL;
+  d_pos = NULL;
+  d_vel = NULL;
+  d_mat = NULL;
+}
+
+Satellite::Par
+SatelliteHelper::GetParameter (const Satellite& sat)
+{
+  return sat.m_par;
+}
+
+void
+SatelliteHelper::CalcTrajectory (
+  const Satellite&  sat,
+  const DateTime&   epoch,
+  const double*     seconds,
+  size_t            n,
+  TrajectoryBuffer& buffer)
+{
+  buffer.Resize (n);
+  if (sat.m_sgp4)
+  {
+    cpu::sgp4::CalcTrajectory (
+      buffer.pos.data (), buffer.vel.data (), buffer.mat.data (), buffer.dmat.data (),
+      sat.m_sgp4.get (), (epoch - J2000).TotalMinutes (), seconds, 1, n);
+    return;
+  }
+  cpu::satellite::CalcTrajectory (
+    buffer.pos.data (), buffer.vel.data (), buffer.mat.data (), buffer.dmat.data (),
+    &sat.m_par, seconds, 1, n);
+}
+
+std::ostream&
+operator<< (std::ostream& os, const Satellite::Ele& ele)
+{
+  os << ele.ToString ();
+  return os;
+}
+
+std::ostream&
+operator<< (std::ostream& os, const Satellite::Par& par)
+{
+  os << par.ToString ();
+  return os;
+}
+
+std::ostream&
+operator<< (std::ostream& os, const Satellite::Sta& sta)
+{
+  os << sta.ToString ();
+  return os;
+}
+
+}
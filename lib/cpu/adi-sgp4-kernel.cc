@@ -0,0 +1,287 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "Globals.h"
+#include "adi-constant.h"
+#include "adi-cpu.h"
+#include "adi-cpu-kernel.h"
+
+namespace adi {
+namespace cpu {
+namespace sgp4 {
+
+namespace {
+
+/**
+ * \brief Calculate the state of satellite with the near earth SGP4 model,
+ * the same algorithm as SGP4::FindPositionSGP4 of libsgp4
+ * \param[in]   p       the constants
+ * \param[in]   tsince  the elapsed minutes from the epoch of elements
+ * \param[out]  pos     the eci position, in km
+ * \param[out]  vel     the eci velocity, in km/s
+ */
+void
+CalcState (const Parameter& p, double tsince, Vector& pos, Vector& vel)
+{
+  const Tle& tle = p.tle;
+  // secular gravity and atmospheric drag
+  const double xmdf = tle.ma + p.xmdot * tsince;
+  const double omgadf = tle.aop + p.omgdot * tsince;
+  const double xnoddf = tle.raan + p.xnodot * tsince;
+  const double tsq = tsince * tsince;
+  const double xnode = xnoddf + p.xnodcf * tsq;
+  double omega = omgadf;
+  double xmp = xmdf;
+  double tempa = 1.0 - p.c1 * tsince;
+  double tempe = tle.bstar * p.c4 * tsince;
+  double templ = p.t2cof * tsq;
+  if (!p.isSimple)
+  {
+    const double delomg = p.omgcof * tsince;
+    const double delm = p.xmcof * (std::pow (1.0 + p.eta * std::cos (xmdf), 3.0) - p.delmo);
+    xmp = xmdf + delomg + delm;
+    omega = omgadf - delomg - delm;
+    const double tcube = tsq * tsince;
+    const double tfour = tsince * tcube;
+    tempa = tempa - p.d2 * tsq - p.d3 * tcube - p.d4 * tfour;
+    tempe = tempe + tle.bstar * p.c5 * (std::sin (xmp) - p.sinmo);
+    templ = templ + p.t3cof * tcube + tfour * (p.t4cof + tsince * p.t5cof);
+  }
+  const double a = p.aodp * tempa * tempa;
+  const double e = std::max (tle.ecc - tempe, 1.0e-6);
+  const double xl = xmp + omega + xnode + p.xnodp * templ;
+  // long period periodics
+  const double beta2 = 1.0 - e * e;
+  const double xn = kXKE / std::pow (a, 1.5);
+  const double axn = e * std::cos (omega);
+  const double temp11 = 1.0 / (a * beta2);
+  const double xll = temp11 * p.xlcof * axn;
+  const double aynl = temp11 * p.aycof;
+  const double xlt = xl + xll;
+  const double ayn = e * std::sin (omega) + aynl;
+  const double elsq = axn * axn + ayn * ayn;
+  // solve the kepler's equation
+  const double capu = std::fmod (xlt - xnode, kTWOPI);
+  const double maxDelta = 1.25 * std::sqrt (elsq);
+  double epw = capu;
+  double sinepw = 0.0, cosepw = 1.0, ecose = 0.0, esine = 0.0;
+  for (int i = 0;i < 10;++i)
+  {
+    sinepw = std::sin (epw);
+    cosepw = std::cos (epw);
+    ecose = axn * cosepw + ayn * sinepw;
+    esine = axn * sinepw - ayn * cosepw;
+    const double f = capu - epw + esine;
+    if (std::fabs (f) < 1.0e-12)
+    {
+      break;
+    }
+    const double fdot = 1.0 - ecose;
+    double delta = f / fdot;
+    if (i == 0)
+    {
+      delta = std::min (std::max (delta, -maxDelta), maxDelta);
+    }
+    else
+    {
+      delta = f / (fdot + 0.5 * esine * delta);
+    }
+    epw += delta;
+  }
+  // short period preliminary quantities
+  const double temp21 = 1.0 - elsq;
+  const double pl = a * temp21;
+  const double r = a * (1.0 - ecose);
+  const double temp31 = 1.0 / r;
+  const double rdot = kXKE * std::sqrt (a) * esine * temp31;
+  const double rfdot = kXKE * std::sqrt (pl) * temp31;
+  const double temp32 = a * temp31;
+  const double betal = std::sqrt (temp21);
+  const double temp33 = 1.0 / (1.0 + betal);
+  const double cosu = temp32 * (cosepw - axn + ayn * esine * temp33);
+  const double sinu = temp32 * (sinepw - ayn - axn * esine * temp33);
+  const double u = std::atan2 (sinu, cosu);
+  const double sin2u = 2.0 * sinu * cosu;
+  const double cos2u = 2.0 * cosu * cosu - 1.0;
+  const double temp41 = 1.0 / pl;
+  const double temp42 = kCK2 * temp41;
+  const double temp43 = temp42 * temp41;
+  // short period periodics
+  const double rk = r * (1.0 - 1.5 * temp43 * betal * p.x3thm1) + 0.5 * temp42 * p.x1mth2 * cos2u;
+  const double uk = u - 0.25 * temp43 * p.x7thm1 * sin2u;
+  const double xnodek = xnode + 1.5 * temp43 * p.cosio * sin2u;
+  const double xinck = tle.inc + 1.5 * temp43 * p.cosio * p.sinio * cos2u;
+  const double rdotk = rdot - xn * temp42 * p.x1mth2 * sin2u;
+  const double rfdotk = rfdot + xn * temp42 * (p.x1mth2 * cos2u + 1.5 * p.x3thm1);
+  // orientation vectors
+  const double sinuk = std::sin (uk), cosuk = std::cos (uk);
+  const double sinik = std::sin (xinck), cosik = std::cos (xinck);
+  const double sinnok = std::sin (xnodek), cosnok = std::cos (xnodek);
+  const double xmx = -sinnok * cosik;
+  const double xmy = cosnok * cosik;
+  const double ux = xmx * sinuk + cosnok * cosuk;
+  const double uy = xmy * sinuk + sinnok * cosuk;
+  const double uz = sinik * sinuk;
+  const double vx = xmx * cosuk - cosnok * sinuk;
+  const double vy = xmy * cosuk - sinnok * sinuk;
+  const double vz = sinik * cosuk;
+  const double kv = kXKMPER / 60.0;
+  pos = Vector {rk * ux * kXKMPER, rk * uy * kXKMPER, rk * uz * kXKMPER};
+  vel = Vector {(rdotk * ux + rfdotk * vx) * kv, (rdotk * uy + rfdotk * vy) * kv, (rdotk * uz + rfdotk * vz) * kv};
+}
+
+} // namespace
+
+bool
+Initialize (
+  Parameter&  p,
+  const Tle&  tle)
+{
+  p.tle = tle;
+  p.epoch = (tle.epoch - J2000).TotalSeconds () / 60.0;
+  // recover the original mean motion and semi-major axis from the elements
+  const double mm = tle.mm * kTWOPI / kMINUTES_PER_DAY;
+  const double a1 = std::pow (kXKE / mm, kTWOTHIRD);
+  p.cosio = std::cos (tle.inc);
+  p.sinio = std::sin (tle.inc);
+  const double theta2 = p.cosio * p.cosio;
+  p.x3thm1 = 3.0 * theta2 - 1.0;
+  const double eosq = tle.ecc * tle.ecc;
+  const double betao2 = 1.0 - eosq;
+  const double betao = std::sqrt (betao2);
+  const double temp = (1.5 * kCK2) * p.x3thm1 / (betao * betao2);
+  const double del1 = temp / (a1 * a1);
+  const double a0 = a1 * (1.0 - del1 * (1.0 / 3.0 + del1 * (1.0 + del1 * 134.0 / 81.0)));
+  const double del0 = temp / (a0 * a0);
+  p.xnodp = mm / (1.0 + del0);
+  p.aodp = a0 / (1.0 - del0);
+  if (kTWOPI / p.xnodp >= 225.0)
+  {
+    return false;
+  }
+  const double perigee = (p.aodp * (1.0 - tle.ecc) - kAE) * kXKMPER;
+  // the drag terms depend on the perigee height
+  double s4 = kS;
+  double qoms24 = kQOMS2T;
+  p.isSimple = perigee < 220.0;
+  if (perigee < 156.0)
+  {
+    s4 = perigee < 98.0 ? 20.0 : perigee - 78.0;
+    qoms24 = std::pow ((120.0 - s4) * kAE / kXKMPER, 4.0);
+    s4 = s4 / kXKMPER + kAE;
+  }
+  const double pinvsq = 1.0 / (p.aodp * p.aodp * betao2 * betao2);
+  const double tsi = 1.0 / (p.aodp - s4);
+  p.eta = p.aodp * tle.ecc * tsi;
+  const double etasq = p.eta * p.eta;
+  const double eeta = tle.ecc * p.eta;
+  const double psisq = std::fabs (1.0 - etasq);
+  const double coef = qoms24 * std::pow (tsi, 4.0);
+  const double coef1 = coef / std::pow (psisq, 3.5);
+  const double c2 = coef1 * p.xnodp * (p.aodp * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq))
+                  + 0.75 * kCK2 * tsi / psisq * p.x3thm1 * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+  p.c1 = tle.bstar * c2;
+  p.x1mth2 = 1.0 - theta2;
+  p.c4 = 2.0 * p.xnodp * coef1 * p.aodp * betao2 * (p.eta * (2.0 + 0.5 * etasq)
+       + tle.ecc * (0.5 + 2.0 * etasq) - 2.0 * kCK2 * tsi / (p.aodp * psisq)
+       * (-3.0 * p.x3thm1 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta))
+       + 0.75 * p.x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * std::cos (2.0 * tle.aop)));
+  const double theta4 = theta2 * theta2;
+  const double temp1 = 3.0 * kCK2 * pinvsq * p.xnodp;
+  const double temp2 = temp1 * kCK2 * pinvsq;
+  const double temp3 = 1.25 * kCK4 * pinvsq * pinvsq * p.xnodp;
+  p.xmdot = p.xnodp + 0.5 * temp1 * betao * p.x3thm1 + 0.0625 * temp2 * betao * (13.0 - 78.0 * theta2 + 137.0 * theta4);
+  const double x1m5th = 1.0 - 5.0 * theta2;
+  p.omgdot = -0.5 * temp1 * x1m5th + 0.0625 * temp2 * (7.0 - 114.0 * theta2 + 395.0 * theta4)
+           + temp3 * (3.0 - 36.0 * theta2 + 49.0 * theta4);
+  const double xhdot1 = -temp1 * p.cosio;
+  p.xnodot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * theta2) + 2.0 * temp3 * (3.0 - 7.0 * theta2)) * p.cosio;
+  p.xnodcf = 3.5 * betao2 * xhdot1 * p.c1;
+  p.t2cof = 1.5 * p.c1;
+  const double cosio1 = std::fabs (p.cosio + 1.0) > 1.5e-12 ? 1.0 + p.cosio : 1.5e-12;
+  p.xlcof = 0.125 * kA3OVK2 * p.sinio * (3.0 + 5.0 * p.cosio) / cosio1;
+  p.aycof = 0.25 * kA3OVK2 * p.sinio;
+  p.x7thm1 = 7.0 * theta2 - 1.0;
+  const double c3 = tle.ecc > 1.0e-4 ? coef * tsi * kA3OVK2 * p.xnodp * kAE * p.sinio / tle.ecc : 0.0;
+  p.c5 = 2.0 * coef1 * p.aodp * betao2 * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+  p.omgcof = tle.bstar * c3 * std::cos (tle.aop);
+  p.xmcof = tle.ecc > 1.0e-4 ? -kTWOTHIRD * coef * tle.bstar * kAE / eeta : 0.0;
+  p.delmo = std::pow (1.0 + p.eta * std::cos (tle.ma), 3.0);
+  p.sinmo = std::sin (tle.ma);
+  p.d2 = p.d3 = p.d4 = p.t3cof = p.t4cof = p.t5cof = 0.0;
+  if (!p.isSimple)
+  {
+    const double c1sq = p.c1 * p.c1;
+    p.d2 = 4.0 * p.aodp * tsi * c1sq;
+    const double temp = p.d2 * tsi * p.c1 / 3.0;
+    p.d3 = (17.0 * p.aodp + s4) * temp;
+    p.d4 = 0.5 * temp * p.aodp * tsi * (221.0 * p.aodp + 31.0 * s4) * p.c1;
+    p.t3cof = p.d2 + 2.0 * c1sq;
+    p.t4cof = 0.25 * (3.0 * p.d3 + p.c1 * (12.0 * p.d2 + 10.0 * c1sq));
+    p.t5cof = 0.2 * (3.0 * p.d4 + 12.0 * p.c1 * p.d3 + 6.0 * p.d2 * p.d2 + 15.0 * c1sq * (2.0 * p.d2 + c1sq));
+  }
+  return true;
+}
+
+void
+CalcEciState (
+  Vector*           position,
+  Vector*           velocity,
+  const Parameter*  param,
+  double            epoch,
+  const double*     seconds,
+  size_t            rows,
+  size_t            cols)
+{
+  ParallelFor (rows, cols, [=] (size_t begin, size_t end)
+  {
+    for (size_t idx = begin;idx < end;++idx)
+    {
+      const Parameter& p = param[idx / cols];
+      CalcState (p, seconds[idx % cols] / 60.0 + (epoch - p.epoch), position[idx], velocity[idx]);
+    }
+  });
+}
+
+void
+CalcTrajectory (
+  Vector*           position,
+  Vector*           velocity,
+  Matrix*           matrix,
+  Matrix*           derivMatrix,
+  const Parameter*  param,
+  double            epoch,
+  const double*     seconds,
+  size_t            rows,
+  size_t            cols)
+{
+  CalcEciState (position, velocity, param, epoch, seconds, rows, cols);
+  satellite::CalcMatrixFromEciToBody (matrix, position, velocity, rows, cols);
+  if (derivMatrix)
+  {
+    satellite::CalcDerivMatrixFromEciToBody (derivMatrix, matrix, position, velocity, rows, cols);
+  }
+}
+
+} // namespace sgp4
+} // namespace cpu
+} // namespace adi
@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <cmath>
+#include "Globals.h"
+#include "adi-util.h"
+#include "adi-constant.h"
+#include "adi-cpu.h"
+#include "adi-cpu-kernel.h"
+
+namespace adi {
+namespace cpu {
+namespace station {
+
+namespace {
+const double kEarthSpin = kTWOPI * (kOMEGA_E / kSECONDS_PER_DAY); //!< rate of earth spin, in radian per second
+}
+
+void
+CalcLocalGreenwichSiderealTime (
+  Gst*            gst,
+  Station::Ele*   element,
+  const int64_t*  ticks,
+  size_t          rows,
+  size_t          cols)
+{
+  ParallelFor (rows, cols, [=] (size_t begin, size_t end)
+  {
+    for (size_t idx = begin;idx < end;++idx)
+    {
+      gst[idx] = DateTime (ticks[idx % cols]).ToLocalMeanSiderealTime (element[idx / cols].lon);
+    }
+  });
+}
+
+void
+CalcEciPosition (
+  Vector*         position,
+  Station::Ele*   element,
+  Gst*            gst,
+  size_t          rows,
+  size_t          cols)
+{
+  ParallelFor (rows, cols, [=] (size_t begin, size_t end)
+  {
+    for (size_t idx = begin;idx < end;++idx)
+    {
+      const Station::Ele& ele = element[idx / cols];
+      double sinLat = sin (ele.lat);
+      double c = 1.0 / sqrt (1.0 + K_F * (K_F - 2.0) * sinLat * sinLat);
+      double s = (1.0 - K_F) * (1.0 - K_F) * c;
+      double achcp = (K_RE * c + ele.alt) * cos (ele.lat);
+      position[idx] = Vector {
+        achcp * cos (gst[idx]),
+        achcp * sin (gst[idx]),
+        (K_RE * s + ele.alt) * sinLat
+      };
+    }
+  });
+}
+
+void
+CalcEciVelocity (
+  Vector*         velocity,
+  Vector*         position,
+  size_t          rows,
+  size_t          cols)
+{
+  ParallelFor (rows, cols, [=] (size_t begin, size_t end)
+  {
+    for (size_t idx = begin;idx < end;++idx)
+    {
+      velocity[idx] = Vector {-kEarthSpin * position[idx].y, kEarthSpin * position[idx].x, 0.0};
+    }
+  });
+}
+
+void
+CalcMatrixFromEciToBody (
+  Matrix*         matrix,
+  Station::Ele*   element,
+  Gst*            gst,
+  size_t          rows,
+  size_t          cols)
+{
+  ParallelFor (rows, cols, [=] (size_t begin, size_t end)
+  {
+    for (size_t idx = begin;idx < end;++idx)
+    {
+      const Station::Ele& ele = element[idx / cols];
+      double sp = sin (ele.lat), cp = cos (ele.lat);
+      double st = sin (gst[idx]), ct = cos (gst[idx]);
+      // north-east-down
+      matrix[idx] = Matrix {
+        Vector {-sp * ct, -sp * st, cp},
+        Vector {-st,      ct,       0.0},
+        Vector {-cp * ct, -cp * st, -sp}
+      };
+    }
+  });
+}
+
+void
+CalcDerivMatrixFromEciToBody (
+  Matrix*         derivMatrix,
+  Matrix*         /* matrix */,
+  Station::Ele*   element,
+  Gst*            gst,
+  size_t          rows,
+  size_t          cols)
+{
+  ParallelFor (rows, cols, [=] (size_t begin, size_t end)
+  {
+    for (size_t idx = begin;idx < end;++idx)
+    {
+      const Station::Ele& ele = element[idx / cols];
+      double sp = sin (ele.lat), cp = cos (ele.lat);
+      double st = sin (gst[idx]), ct = cos (gst[idx]);
+      double w = kEarthSpin;
+      derivMatrix[idx] = Matrix {
+        Vector {w * sp * st, -w * sp * ct, 0.0},
+        Vector {-w * ct,     -w * st,      0.0},
+        Vector {w * cp * st, -w * cp * ct, 0.0}
+      };
+    }
+  });
+}
+
+} // namespace station
+} // namespace cpu
+} // namespace adi
@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include "adi-station.h"
+#include "adi-station-list.h"
+#include "adi-util.h"
+#include "adi-cpu-kernel.h"
+
+namespace adi {
+
+std::string
+Station::Element::ToString () const
+{
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision (6)
+     << "lat = " << RadiansToDegrees (lat)
+     << ", lon = " << RadiansToDegrees (lon)
+     << ", alt = " << alt;
+  return ss.str ();
+}
+
+Station::Station ()
+: Object  ()
+, m_ele   (Ele {0.0, 0.0, 0.0})
+, d_ele   (NULL)
+, d_gst   (NULL)
+{
+  Construct ();
+}
+
+Station::Station (const Station& sta)
+: Object  (sta)
+, m_ele   (sta.m_ele)
+, d_ele   (NULL)
+, d_gst   (NULL)
+{
+}
+
+Station::~Station ()
+{
+  Release ();
+}
+
+void
+Station::SetElement (Ele ele)
+{
+  m_ele = ele;
+}
+
+void
+Station::SetElement (
+  double lat,
+  double lon,
+  double alt,
+  std::string name,
+  bool isDegree)
+{
+  if (isDegree)
+  {
+    lat = DegreesToRadians (lat);
+    lon = DegreesToRadians (lon);
+  }
+  m_name = name;
+  SetElement (Ele {alt, lat, lon});
+}
+
+std::string
+Station::GetName () const
+{
+  return m_name;
+}
+
+size_t
+Station::GetId () const
+{
+  return m_uid;
+}
+
+Object::Type
+Station::GetType () const
+{
+  return STATION;
+}
+
+Trajectory
+Station::CalcTrajectory (Matrix** dmat)
+{
+  Initialize ();
+  size_t num = GetIntervalTicks ();
+  std::vector<int64_t> ticks = Interval::CreateTicks (m_intervals, m_epoch, m_step);
+  cpu::station::CalcLocalGreenwichSiderealTime (d_gst, d_ele, ticks.data (), 1, num);
+  cpu::station::CalcEciPosition (d_pos, d_ele, d_gst, 1, num);
+  cpu::station::CalcEciVelocity (d_vel, d_pos, 1, num);
+  cpu::station::CalcMatrixFromEciToBody (d_mat, d_ele, d_gst, 1, num);
+  if (dmat)
+  {
+    *dmat = new Matrix[num];
+    cpu::station::CalcDerivMatrixFromEciToBody (*dmat, d_mat, d_ele, d_gst, 1, num);
+  }
+  return Trajectory {d_pos, d_vel, d_mat, num};
+}
+
+Turntable*
+Station::GetTurntable (Face face)
+{
+  return Object::GetTurntable (face);
+}
+
+void
+Station::Construct ()
+{
+  m_uid = StationList::Add (this);
+  m_name = "NoName";
+}
+
+void
+Station::Initialize ()
+{
+  Release ();
+  size_t num = GetIntervalTicks ();
+  d_ele = new Ele (m_ele);
+  d_gst = new Gst[num];
+  d_pos = new Vector[num];
+  d_vel = new Vector[num];
+  d_mat = new Matrix[num];
+}
+
+void
+Station::Release ()
+{
+  delete d_ele;
+  delete[] d_gst;
+  delete[] d_pos;
+  delete[] d_vel;
+  delete[] d_mat;
+  d_ele = NULL;
+  d_gst = NULL;
+  d_pos = NULL;
+  d_vel = NULL;
+  d_mat = NULL;
+}
+
+const Station::Ele&
+StationHelper::GetElement (const Station& sta)
+{
+  return sta.m_ele;
+}
+
+void
+StationHelper::CalcTrajectory (
+  const Station&    sta,
+  const int64_t*    ticks,
+  size_t            n,
+  TrajectoryBuffer& buffer)
+{
+  Station::Ele ele = sta.m_ele;
+  std::vector<Gst> gst (n);
+  buffer.Resize (n);
+  cpu::station::CalcLocalGreenwichSiderealTime (gst.data (), &ele, ticks, 1, n);
+  cpu::station::CalcEciPosition (buffer.pos.data (), &ele, gst.data (), 1, n);
+  cpu::station::CalcEciVelocity (buffer.vel.data (), buffer.pos.data (), 1, n);
+  cpu::station::CalcMatrixFromEciToBody (buffer.mat.data (), &ele, gst.data (), 1, n);
+  cpu::station::CalcDerivMatrixFromEciToBody (buffer.dmat.data (), buffer.mat.data (), &ele, gst.data (), 1, n);
+}
+
+std::ostream&
+operator<< (std::ostream& os, Station::Ele& elem)
+{
+  os << elem.ToString ();
+  return os;
+}
+
+}
@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include "Globals.h"
+#include "Util.h"
+#include "adi-util.h"
+#include "adi-cpu.h"
+#include "adi-cpu-kernel.h"
+
+namespace adi {
+namespace cpu {
+namespace sun {
+
+namespace {
+
+double
+Delta_ET (double year)
+{
+  return 26.465 + 0.747622 * (year - 1950) + 1.886913 * sin (kTWOPI * (year - 1975) / 33);
+}
+
+const size_t K_BLOCK_SIZE = 1024;     //!< the number of times in a block of table
+const size_t K_MAX_BLOCKS = 1024;     //!< the maximum number of blocks kept in table
+
+typedef std::tuple<int64_t, int64_t, int64_t> BlockKey;   //!< the step, phase and index of block
+typedef std::shared_ptr<const std::vector<Vector>> Block;
+
+std::mutex                g_mutex;
+std::map<BlockKey, Block> g_blocks;
+
+/**
+ * \brief Get the block of sun positions, it is calculated if it is not in table
+ * \param[in] step   the ticks between two times
+ * \param[in] phase  the remainder of ticks divided by step
+ * \param[in] index  the index of block
+ * \return the block
+ */
+Block
+GetBlock (int64_t step, int64_t phase, int64_t index)
+{
+  BlockKey key (step, phase, index);
+  {
+    std::lock_guard<std::mutex> lock (g_mutex);
+    std::map<BlockKey, Block>::const_iterator it = g_blocks.find (key);
+    if (it != g_blocks.end ())
+    {
+      return it->second;
+    }
+  }
+  std::vector<int64_t> ticks (K_BLOCK_SIZE);
+  for (size_t i = 0;i < K_BLOCK_SIZE;++i)
+  {
+    ticks[i] = phase + (index * (int64_t) K_BLOCK_SIZE + (int64_t) i) * step;
+  }
+  std::shared_ptr<std::vector<Vector>> block = std::make_shared<std::vector<Vector>> (K_BLOCK_SIZE);
+  CalcEciPosition (block->data (), ticks.data (), K_BLOCK_SIZE);
+  std::lock_guard<std::mutex> lock (g_mutex);
+  if (g_blocks.size () >= K_MAX_BLOCKS)
+  {
+    g_blocks.clear ();
+  }
+  // another thread may have filled the same block
+  return g_blocks.insert (std::make_pair (key, Block (block))).first->second;
+}
+
+} // namespace
+
+void
+CalcEciPosition (
+  Vector*         position,
+  const int64_t*  ticks,
+  size_t          N)
+{
+  ParallelFor (N, [=] (size_t begin, size_t end)
+  {
+    for (size_t i = begin;i < end;++i)
+    {
+      // the same algorithm as SolarPosition of libsgp4
+      const double mjd = ToJ2000 (ticks[i]);
+      const double year = 1900 + mjd / 365.25;
+      const double T = (mjd + Delta_ET (year) / kSECONDS_PER_DAY) / 36525.0;
+      const double M = Util::DegreesToRadians (Util::Wrap360 (358.47583
+            + Util::Wrap360 (35999.04975 * T)
+            - (0.000150 + 0.0000033 * T) * T * T));
+      const double L = Util::DegreesToRadians (Util::Wrap360 (279.69668
+            + Util::Wrap360 (36000.76892 * T)
+            + 0.0003025 * T * T));
+      const double e = 0.01675104 - (0.0000418 + 0.000000126 * T) * T;
+      const double C = Util::DegreesToRadians ((1.919460
+            - (0.004789 + 0.000014 * T) * T) * sin (M)
+            + (0.020094 - 0.000100 * T) * sin (2 * M)
+            + 0.000293 * sin (3 * M));
+      const double O = Util::DegreesToRadians (Util::Wrap360 (259.18 - 1934.142 * T));
+      const double Lsa = Util::WrapTwoPI (L + C - Util::DegreesToRadians (0.00569 - 0.00479 * sin (O)));
+      const double nu = Util::WrapTwoPI (M + C);
+      double R = 1.0000002 * (1 - e * e) / (1 + e * cos (nu));
+      const double eps = Util::DegreesToRadians (23.452294 - (0.0130125
+            + (0.00000164 - 0.000000503 * T) * T) * T + 0.00256 * cos (O));
+      R = R * kAU;
+      position[i] = Vector {R * cos (Lsa), R * sin (Lsa) * cos (eps), R * sin (Lsa) * sin (eps)};
+    }
+  }, 64);
+}
+
+void
+GetEciPosition (
+  Vector*         position,
+  int64_t         start,
+  int64_t         step,
+  size_t          N)
+{
+  int64_t phase = start % step;
+  int64_t first = start / step;
+  size_t i = 0;
+  while (i < N)
+  {
+    int64_t index = (first + (int64_t) i) / (int64_t) K_BLOCK_SIZE;
+    size_t offset = (first + (int64_t) i) % (int64_t) K_BLOCK_SIZE;
+    size_t count = std::min (K_BLOCK_SIZE - offset, N - i);
+    Block block = GetBlock (step, phase, index);
+    std::copy (block->begin () + offset, block->begin () + offset + count, position + i);
+    i += count;
+  }
+}
+
+} // namespace sun
+} // namespace cpu
+} // namespace adi
@@ -0,0 +1,38 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include "adi-sun.h"
+#include "adi-cpu-kernel.h"
+
+namespace adi {
+
+Vector* Sun::d_pos = NULL;
+
+Vector*
+Sun::CalcPosition (const Intervals& intervals, const DateTime& epoch, const TimeSpan& step)
+{
+  std::vector<int64_t> ticks = Interval::CreateTicks (intervals, epoch, step);
+  delete[] d_pos;
+  d_pos = new Vector[ticks.size ()];
+  cpu::sun::CalcEciPosition (d_pos, ticks.data (), ticks.size ());
+  return d_pos;
+}
+
+}
@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include "adi-type-define.h"
+#include "adi-turntable.h"
+#include "adi-object.h"
+
+namespace adi {
+
+std::string
+Vector::ToString () const
+{
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision (6)
+     << "(" << x << ", " << y << ", " << z << ")";
+  return ss.str ();
+}
+
+std::string
+Matrix::ToString () const
+{
+  std::stringstream ss;
+  ss << "[" << r1.ToString () << ", " << r2.ToString () << ", " << r3.ToString () << "]";
+  return ss.str ();
+}
+
+std::string
+Trajectory::ToString () const
+{
+  std::stringstream ss;
+  for (size_t i = 0;i < num;++i)
+  {
+    ss << "pos = " << pos[i].ToString ()
+       << ", vel = " << vel[i].ToString ()
+       << ", mat = " << mat[i].ToString () << std::endl;
+  }
+  return ss.str ();
+}
+
+std::string
+PointingBound::ToString () const
+{
+  std::stringstream ss;
+  ss << "azimuth: [" << azimuth.min << ", " << azimuth.max << "], "
+     << "pitch: [" << pitch.min << ", " << pitch.max << "]";
+  return ss.str ();
+}
+
+std::string
+FaceToString (Face face)
+{
+  switch (face)
+  {
+    case Left:    return "Left";
+    case Right:   return "Right";
+    case Front:   return "Front";
+    case Back:    return "Back";
+    case Top:     return "Top";
+    case Bottom:  return "Bottom";
+    default:      return "ErrFace";
+  }
+}
+
+std::string
+LinkInfo::ToString () const
+{
+  std::stringstream ss;
+  ss << src->GetObject ()->GetName () << "[" << FaceToString (src->GetFace ()) << "] -> "
+     << dst->GetObject ()->GetName () << "[" << FaceToString (dst->GetFace ()) << "]";
+  if (!linkDatas.empty ())
+  {
+    ss << " " << linkDatas.front ().time << " ~ " << linkDatas.back ().time;
+  }
+  return ss.str ();
+}
+
+std::ostream&
+operator<< (std::ostream& os, const Vector& v)
+{
+  os << v.ToString ();
+  return os;
+}
+
+std::ostream&
+operator<< (std::ostream& os, const Matrix& m)
+{
+  os << m.ToString ();
+  return os;
+}
+
+std::ostream&
+operator<< (std::ostream& os, const Trajectory& t)
+{
+  os << t.ToString ();
+  return os;
+}
+
+std::ostream&
+operator<< (std::ostream& os, const LinkInfo& l)
+{
+  os << l.ToString ();
+  return os;
+}
+
+}
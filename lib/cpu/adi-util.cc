@@ -0,0 +1,227 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <cmath>
+#include "adi-util.h"
+#include "adi-cpu.h"
+#include "adi-cpu-kernel.h"
+
+namespace adi {
+
+double
+Wrap (const double x, const double y)
+{
+  if (y == 0.0)
+  {
+    return x;
+  }
+  return x - y * floor (x / y);
+}
+
+double
+WrapTwoPI (double x)
+{
+  return Wrap (x, 2.0 * M_PI);
+}
+
+double
+Wrap360 (double x)
+{
+  return Wrap (x, 360.0);
+}
+
+double
+DegreesToRadians (double x)
+{
+  return x * M_PI / 180.0;
+}
+
+double
+RadiansToDegrees (double x)
+{
+  return x * 180.0 / M_PI;
+}
+
+double
+ToJulian (int64_t ticks)
+{
+  return (double)ticks / TicksPerDay + 1721425.5;
+}
+
+double
+ToJ2000 (int64_t ticks)
+{
+  return ToJulian (ticks) - 2415020.0;
+}
+
+Vector
+Add (Vector v1, Vector v2)
+{
+  return Vector {v1.x + v2.x, v1.y + v2.y, v1.z + v2.z};
+}
+
+Vector
+Sub (Vector v1, Vector v2)
+{
+  return Vector {v1.x - v2.x, v1.y - v2.y, v1.z - v2.z};
+}
+
+void
+Scale (Vector& v, double scale)
+{
+  v.x *= scale;
+  v.y *= scale;
+  v.z *= scale;
+}
+
+double
+Dot (Vector v1, Vector v2)
+{
+  return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+}
+
+Vector
+operator* (Matrix& m, Vector& v)
+{
+  return Vector {Dot (m.r1, v), Dot (m.r2, v), Dot (m.r3, v)};
+}
+
+Vector
+operator+ (const Vector& v1, const Vector& v2)
+{
+  return Add (v1, v2);
+}
+
+Vector
+operator- (const Vector& v1, const Vector& v2)
+{
+  return Sub (v1, v2);
+}
+
+Vector
+operator- (const Vector& v)
+{
+  return Vector {-v.x, -v.y, -v.z};
+}
+
+Vector
+Cross (Vector v1, Vector v2)
+{
+  return Vector {
+    v1.y * v2.z - v1.z * v2.y,
+    v1.z * v2.x - v1.x * v2.z,
+    v1.x * v2.y - v1.y * v2.x
+  };
+}
+
+void
+Normalize (Vector& v)
+{
+  double norm = Norm (v);
+  if (norm > 0.0)
+  {
+    Scale (v, 1.0 / norm);
+  }
+}
+
+double
+Norm (const Vector& v)
+{
+  return sqrt (v.x * v.x + v.y * v.y + v.z * v.z);
+}
+
+Direction
+View (Vector v)
+{
+  Direction d;
+  d.azimuth = atan2 (v.y, v.x);
+  d.pitch = -atan (v.z / sqrt (v.x * v.x + v.y * v.y));
+  return d;
+}
+
+Pointing
+View (const Vector& pos, const Vector& vel)
+{
+  double x = pos.x;
+  double y = pos.y;
+  double z = pos.z;
+  double r2 = x * x + y * y + z * z;
+  double d2 = x * x + y * y;
+  double d = sqrt (d2);
+  double u = x * vel.x + y * vel.y;
+  Pointing p;
+  p.angle = View (pos);
+  p.rate.azimuth = (x * vel.y - y * vel.x) / d2;
+  p.rate.pitch = (z * u - d2 * vel.z) / (r2 * d);
+  return p;
+}
+
+bool
+IsInside (const Direction& d, const PointingBound& b)
+{
+  return d.azimuth >= b.azimuth.min && d.azimuth <= b.azimuth.max
+      && d.pitch >= b.pitch.min && d.pitch <= b.pitch.max;
+}
+
+void
+Swap (double& a, double& b)
+{
+  double t = a;
+  a = b;
+  b = t;
+}
+
+namespace cpu {
+
+void
+CalcMatsMulVecs (
+  Matrix* A,
+  Vector* b,
+  size_t  rows,
+  size_t  cols)
+{
+  ParallelFor (rows, cols, [=] (size_t begin, size_t end)
+  {
+    for (size_t i = begin;i < end;++i)
+    {
+      b[i] = A[i] * b[i];
+    }
+  });
+}
+
+void
+CalcVecsEqMatsMulVecs (
+  Vector* c,
+  Matrix* A,
+  Vector* b,
+  size_t  rows,
+  size_t  cols)
+{
+  ParallelFor (rows, cols, [=] (size_t begin, size_t end)
+  {
+    for (size_t i = begin;i < end;++i)
+    {
+      c[i] = A[i] * b[i];
+    }
+  });
+}
+
+} // namespace cpu
+} // namespace adi
@@ -19,6 +19,11 @@
  */
 
 #include <iomanip>
+#include <cmath>
+#include <algorithm>
+#if defined (__AVX__) || defined (__SSE2__)
+#include <immintrin.h>
+#endif
 #include "ns3/util.h"
 #include "bang-bang-controller.h"
 #include "turntable.h"
@@ -84,6 +89,7 @@ BangBangController::BangBangController (
 , m_currState (State (Seconds (0.0), 0.0, 0.0, 0.0))
 , m_lastState (State (Seconds (0.0), 0.0, 0.0, 0.0))
 , m_states    (States ())
+, m_trajectory (BangBangTrajectory ())
 {
 }
 
@@ -102,6 +108,7 @@ BangBangController::NotifyTarget ()
   // limiting the last state
   DoLimit ();
   DoMakeScheme ();
+  DoMakeTrajectory ();
 }
 
 void
@@ -116,6 +123,19 @@ BangBangController::GetBound () const
   return m_bound;
 }
 
+BangBangController::State
+BangBangController::GetState (const Time& t) const
+{
+  BangBangTrajectory::Segment state = m_trajectory.Evaluate (t);
+  return State (state.t, state.x, state.v, state.a);
+}
+
+const BangBangTrajectory&
+BangBangController::GetTrajectory () const
+{
+  return m_trajectory;
+}
+
 Time
 BangBangController::SwingTime (
   const CoordTurntable& initPointing,
@@ -202,46 +222,147 @@ BangBangController::SwingTime (
   NS_ASSERT (false);
 }
 
+namespace {
+
+#if defined (__AVX__)
+typedef __m256d Pack;
+const std::size_t K_LANES = 4;
+inline Pack Load (const double* p)  { return _mm256_loadu_pd (p); }
+inline void Store (double* p, Pack x) { _mm256_storeu_pd (p, x); }
+inline Pack Broadcast (double x)    { return _mm256_set1_pd (x); }
+inline Pack Sqrt (Pack x)           { return _mm256_sqrt_pd (x); }
+inline Pack Max (Pack a, Pack b)    { return _mm256_max_pd (a, b); }
+inline Pack Gt (Pack a, Pack b)     { return _mm256_cmp_pd (a, b, _CMP_GT_OQ); }
+inline Pack Lt (Pack a, Pack b)     { return _mm256_cmp_pd (a, b, _CMP_LT_OQ); }
+inline Pack Ge (Pack a, Pack b)     { return _mm256_cmp_pd (a, b, _CMP_GE_OQ); }
+inline Pack Eq (Pack a, Pack b)     { return _mm256_cmp_pd (a, b, _CMP_EQ_OQ); }
+inline Pack And (Pack a, Pack b)    { return _mm256_and_pd (a, b); }
+inline Pack Or (Pack a, Pack b)     { return _mm256_or_pd (a, b); }
+inline Pack AndNot (Pack a, Pack b) { return _mm256_andnot_pd (a, b); }
+inline Pack Select (Pack m, Pack a, Pack b) { return _mm256_blendv_pd (b, a, m); }
+#elif defined (__SSE2__)
+typedef __m128d Pack;
+const std::size_t K_LANES = 2;
+inline Pack Load (const double* p)  { return _mm_loadu_pd (p); }
+inline void Store (double* p, Pack x) { _mm_storeu_pd (p, x); }
+inline Pack Broadcast (double x)    { return _mm_set1_pd (x); }
+inline Pack Sqrt (Pack x)           { return _mm_sqrt_pd (x); }
+inline Pack Max (Pack a, Pack b)    { return _mm_max_pd (a, b); }
+inline Pack Gt (Pack a, Pack b)     { return _mm_cmpgt_pd (a, b); }
+inline Pack Lt (Pack a, Pack b)     { return _mm_cmplt_pd (a, b); }
+inline Pack Ge (Pack a, Pack b)     { return _mm_cmpge_pd (a, b); }
+inline Pack Eq (Pack a, Pack b)     { return _mm_cmpeq_pd (a, b); }
+inline Pack And (Pack a, Pack b)    { return _mm_and_pd (a, b); }
+inline Pack Or (Pack a, Pack b)     { return _mm_or_pd (a, b); }
+inline Pack AndNot (Pack a, Pack b) { return _mm_andnot_pd (a, b); }
+inline Pack Select (Pack m, Pack a, Pack b) { return _mm_or_pd (_mm_and_pd (m, a), _mm_andnot_pd (m, b)); }
+#endif
+
+#if defined (__AVX__) || defined (__SSE2__)
+/**
+ * \brief Calculate the swing times of K_LANES cases, all four bang-bang cases
+ * are evaluated and the result is selected by masks, in the same order
+ * of the scalar BangBangController::SwingTime
+ */
+inline Pack
+CalcSwingTime (Pack x0, Pack v0, Pack xf, Pack vf, Pack vm, Pack am)
+{
+  Pack zero = Broadcast (0.0);
+  Pack two = Broadcast (2.0);
+  Pack half = Broadcast (0.5);
+  // the divisions are replaced by the reciprocals, which agree to rounding
+  Pack ia = Broadcast (1.0) / am;
+  Pack ia2 = half * ia;
+  Pack ivm = Broadcast (1.0) / vm;
+  Pack v02 = v0 * v0;
+  Pack vf2 = vf * vf;
+  Pack vm2 = vm * vm;
+  Pack k1 = x0 - v02 * ia2;
+  Pack k2 = x0 + v02 * ia2;
+  Pack c0 = vf - v0;
+  Pack c1 = xf - vf2 * ia2 - k1;
+  Pack c2 = xf + vf2 * ia2 - k2;
+  Pack pos = Ge (c0, zero);
+  // speed up then down, with or without keeping the maximum rate
+  Pack up = Or (And (pos, Gt (c1, zero)), AndNot (pos, Gt (c2, zero)));
+  Pack vsUp = Sqrt (Max (half * (vf2 + v02) + am * (xf - x0), zero));
+  Pack ts1Up = (vm - v0) * ia;
+  Pack ts2Up = ts1Up + ((xf + (vf2 - vm2) * ia2) - (x0 + (vm2 - v02) * ia2)) * ivm;
+  Pack tUp = Select (Gt (vsUp, vm),
+    ts2Up - (vf - vm) * ia,
+    two * ((vsUp - v0) * ia) + (v0 - vf) * ia);
+  // speed down then up
+  Pack down = Or (And (pos, Lt (c1, zero)), AndNot (pos, Lt (c2, zero)));
+  Pack vsDown = zero - Sqrt (Max (half * (vf2 + v02) + am * (x0 - xf), zero));
+  Pack ts1Down = (v0 + vm) * ia;
+  Pack ts2Down = ts1Down - ((xf - (vf2 - vm2) * ia2) - (x0 - (vm2 - v02) * ia2)) * ivm;
+  Pack tDown = Select (Lt (vsDown, zero - vm),
+    ts2Down + (vf + vm) * ia,
+    two * ((zero - (vsDown - v0)) * ia) + (vf - v0) * ia);
+  // only speed up or down
+  Pack tFlat = Select (And (pos, Eq (c1, zero)), c0 * ia, (zero - c0) * ia);
+  return Select (up, tUp, Select (down, tDown, tFlat));
+}
+#endif
+
+} // namespace
+
 void
-BangBangController::DoCalcState ()
+BangBangController::SwingTime (
+  const double* x0,
+  const double* v0,
+  const double* xf,
+  const double* vf,
+  const double* vm,
+  const double* am,
+  double* t,
+  std::size_t n)
 {
-  if (m_states.empty ())
-    return;
-  Time now = Simulator::Now ();
-  while (m_states.front ().t <= now)
+  std::size_t i = 0;
+#if defined (__AVX__) || defined (__SSE2__)
+  for (;i + K_LANES <= n;i += K_LANES)
   {
-    m_currState = m_states.front ();
-    m_states.pop ();
-    if (m_states.empty ())
-    {
-      break;
-    }
+    Store (t + i, CalcSwingTime (
+      Load (x0 + i), Load (v0 + i),
+      Load (xf + i), Load (vf + i),
+      Load (vm + i), Load (am + i)));
   }
-  NS_ASSERT (now >= m_currState.t);
-  double dt = (now - m_currState.t).GetSeconds ();
-  NS_ASSERT (dt >= 0);
-  if (dt > 0)
+  // the tail is padded to a full pack
+  if (i < n)
   {
-    m_currState.t = now;
-    m_currState.x = m_currState.x + m_currState.v * dt + 0.5 * m_currState.a * dt * dt;
-    if (m_currState.x > m_bound.xMax)
-    {
-      m_currState.x = m_bound.xMax;
-    }
-    if (m_currState.x < m_bound.xMin)
+    double buffer[6][K_LANES];
+    for (std::size_t k = 0;k < K_LANES;++k)
     {
-      m_currState.x = m_bound.xMin;
-    }
-    m_currState.v = m_currState.v + m_currState.a * dt;
-    if (m_currState.v > m_bound.yMax)
-    {
-      m_currState.v = m_bound.yMax;
-    }
-    if (m_currState.v < m_bound.yMin)
-    {
-      m_currState.v = m_bound.yMin;
+      bool valid = i + k < n;
+      buffer[0][k] = valid ? x0[i + k] : 0.0;
+      buffer[1][k] = valid ? v0[i + k] : 0.0;
+      buffer[2][k] = valid ? xf[i + k] : 0.0;
+      buffer[3][k] = valid ? vf[i + k] : 0.0;
+      buffer[4][k] = valid ? vm[i + k] : 1.0;
+      buffer[5][k] = valid ? am[i + k] : 1.0;
     }
+    double result[K_LANES];
+    Store (result, CalcSwingTime (
+      Load (buffer[0]), Load (buffer[1]),
+      Load (buffer[2]), Load (buffer[3]),
+      Load (buffer[4]), Load (buffer[5])));
+    std::copy (result, result + (n - i), t + i);
+    i = n;
+  }
+#endif
+  for (;i < n;++i)
+  {
+    Box limiter (0.0, 0.0, -vm[i], vm[i], -am[i], am[i]);
+    t[i] = SwingTime (State (Seconds (0.0), x0[i], v0[i]), State (Seconds (0.0), xf[i], vf[i]), limiter).GetSeconds ();
   }
+}
+
+void
+BangBangController::DoCalcState ()
+{
+  if (m_trajectory.IsEmpty ())
+    return;
+  m_currState = GetState (Simulator::Now ());
   m_set (m_currState.t, m_currState.x, m_currState.v);
   m_initState = m_currState;
 }
@@ -250,12 +371,8 @@ void
 BangBangController::DoMakeScheme ()
 {
   NS_LOG_LOGIC (this << ": Scheme will be calculated.");
-  // clear the state's queue
-  while (!m_states.empty ())
-  {
-    m_states.pop ();
-  }
-  m_states.push (m_initState);
+  m_states.clear ();
+  m_states.push_back (m_initState);
   /*
   * Here is a completed scheme calculation process
   * which is based on Bang-bang control
@@ -367,6 +484,21 @@ BangBangController::DoMakeScheme ()
   return;
 }
 
+void
+BangBangController::DoMakeTrajectory ()
+{
+  BangBangTrajectory::Segments segments (m_states.size ());
+  for (std::size_t i = 0;i < m_states.size ();++i)
+  {
+    segments[i].t = m_states[i].t;
+    segments[i].x = m_states[i].x;
+    segments[i].v = m_states[i].v;
+    segments[i].a = m_states[i].a;
+  }
+  m_trajectory = BangBangTrajectory (segments, m_bound);
+  m_states.clear ();
+}
+
 void
 BangBangController::Speeding (double t)
 {
@@ -380,13 +512,13 @@ BangBangController::Speeding (double t)
   }
   State _state = m_states.back ();
   _state.a = m_bound.zMax;
-  m_states.push (_state);
+  m_states.push_back (_state);
   State state;
   state.t = _state.t + Seconds (t);
   state.x = _state.x + _state.v * t + 0.5 * m_bound.zMax * t * t;
   state.v = _state.v + m_bound.zMax * t;
   state.a = 0.0;
-  m_states.push (state);
+  m_states.push_back (state);
 }
 
 void
@@ -402,14 +534,14 @@ BangBangController::Braking (double t)
   }
   State _state = m_states.back ();
   _state.a = m_bound.zMin;
-  m_states.push (_state);
+  m_states.push_back (_state);
   State state;
   state.t = _state.t + Seconds (t);
   state.x = _state.x + _state.v * t + 0.5 * m_bound.zMin * t * t;
   state.v = _state.v + m_bound.zMin * t;
   state.a = m_bound.zMin;
   // state.event = Simulator::Schedule (state.t - Now (), &BangBangController::DoSet, this, state);
-  m_states.push (state);
+  m_states.push_back (state);
 }
 
 void
@@ -425,14 +557,14 @@ BangBangController::Keeping (double t)
   }
   State _state = m_states.back ();
   _state.a = 0.0;
-  m_states.push (_state);
+  m_states.push_back (_state);
   State state;
   state.t = _state.t + Seconds (t);
   state.x = _state.x + _state.v * t;
   state.v = _state.v;
   state.a = 0.0;
   // state.event = Simulator::Schedule (state.t - Now (), &BangBangController::DoSet, this, state);
-  m_states.push (state);
+  m_states.push_back (state);
 }
 
 void
@@ -443,7 +575,7 @@ BangBangController::Tracking ()
   {
     m_lastState.t = m_states.back ().t;
   }
-  m_states.push (m_lastState);
+  m_states.push_back (m_lastState);
 }
 
 void
@@ -470,12 +602,12 @@ BangBangController::Staying ()
     t = 0;
   }
   _state.a = a;
-  m_states.push (_state);
+  m_states.push_back (_state);
   state.t = _state.t + Seconds (t);
   state.x = _state.x + _state.v * t + 0.5 * a * t * t;
   state.v = 0.0;
   state.a = 0.0;
-  m_states.push (state);
+  m_states.push_back (state);
 }
 
 void
@@ -21,12 +21,13 @@
 #ifndef BANG_BANG_CONTROLLER_H
 #define BANG_BANG_CONTROLLER_H
 
-#include <queue>
+#include <vector>
 #include "ns3/object.h"
 #include "ns3/box.h"
 #include "ns3/simulator.h"
 #include "ns3/callback.h"
 #include "coordinate-turntable.h"
+#include "bang-bang-trajectory.h"
 
 namespace ns3 {
 
@@ -80,6 +81,18 @@ public:
   void NotifyTarget ();
   void SetBound (const Box& bound);
   Box GetBound () const;
+  /**
+   * \brief Get the state at given time from the trajectory of current scheme,
+   * the controller is not mutated
+   * \param[in] t the time
+   * \return the state at time t
+   */
+  State GetState (const Time& t) const;
+  /**
+   * \brief Get the trajectory of current scheme
+   * \return the trajectory, empty before any target is notified
+   */
+  const BangBangTrajectory& GetTrajectory () const;
   static Time SwingTime (
     const CoordTurntable& initPointing,
     const CoordTurntable& lastPointing,
@@ -89,9 +102,32 @@ public:
     const State& initState,
     const State& lastState,
     const Box& limiter);
+  /**
+   * \brief Calculate the swing times of a batch of cases in structure of arrays,
+   * the four bang-bang cases are selected by masks without branches.
+   * The scalar SwingTime is kept as the reference, they agree to rounding.
+   * \param[in] x0  the initial angles
+   * \param[in] v0  the initial angular rates
+   * \param[in] xf  the last angles
+   * \param[in] vf  the last angular rates
+   * \param[in] vm  the maximum angular rates of limiters
+   * \param[in] am  the maximum angular accelerations of limiters
+   * \param[out] t  the swing times, in second
+   * \param[in] n   the number of cases
+   */
+  static void SwingTime (
+    const double* x0,
+    const double* v0,
+    const double* xf,
+    const double* vf,
+    const double* vm,
+    const double* am,
+    double* t,
+    std::size_t n);
 private:
   void DoCalcState ();
   void DoMakeScheme ();
+  void DoMakeTrajectory ();
   void Speeding (double t);
   void Braking (double t);
   void Keeping (double t);
@@ -101,7 +137,7 @@ private:
   void DoGet (State& state);
   void DoSet (const State& state);
 private:
-  typedef std::queue<State> States;
+  typedef std::vector<State> States;
   Ptr<Turntable>  m_turntable;
   Box     m_bound;
   CbGet   m_get;
@@ -110,6 +146,7 @@ private:
   State   m_currState;
   State   m_lastState;
   States  m_states;
+  BangBangTrajectory m_trajectory;
 };
 
 std::ostream& operator<< (std::ostream& os, const BangBangController::State& state);
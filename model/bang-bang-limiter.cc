@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <algorithm>
+#include "bang-bang-limiter.h"
+
+namespace ns3 {
+
+BangBangLimiter::BangBangLimiter ()
+: BangBangLimiter (Box (0.0, 0.0, -1.0, 1.0, -1.0, 1.0))
+{
+}
+
+BangBangLimiter::BangBangLimiter (const Box& bound)
+: m_bound (bound)
+, m_vm    (bound.yMax)
+, m_am    (bound.zMax)
+, m_vm2   (bound.yMax * bound.yMax)
+, m_ia    (1.0 / bound.zMax)
+, m_ia2   (0.5 / bound.zMax)
+, m_ivm   (1.0 / bound.yMax)
+{
+}
+
+const Box&
+BangBangLimiter::GetBound () const
+{
+  return m_bound;
+}
+
+bool
+BangBangLimiter::CanSwing (double x0, double v0, double xf, double vf, double t) const
+{
+  // the same cases of BangBangController::SwingTime
+  double dx = xf - x0;
+  double v02 = v0 * v0;
+  double vf2 = vf * vf;
+  double c0 = vf - v0;
+  double c1 = dx - (vf2 - v02) * m_ia2;
+  double c2 = dx + (vf2 - v02) * m_ia2;
+  if ((c0 >= 0 && c1 > 0) || (c0 < 0 && c2 > 0))
+  {
+    // speed up then down, vs is the peak rate
+    double vs2 = std::max (0.5 * (vf2 + v02) + m_am * dx, 0.0);
+    if (vs2 > m_vm2)
+    {
+      double tf = (m_vm - v0) * m_ia
+        + (dx + (vf2 - m_vm2) * m_ia2 - (m_vm2 - v02) * m_ia2) * m_ivm
+        - (vf - m_vm) * m_ia;
+      return tf <= t;
+    }
+    // tf = (2 * vs - v0 - vf) / am <= t
+    double r = m_am * t + v0 + vf;
+    return r >= 0 && 4 * vs2 <= r * r;
+  }
+  if ((c0 >= 0 && c1 < 0) || (c0 < 0 && c2 < 0))
+  {
+    // speed down then up, -vs is the peak rate
+    double vs2 = std::max (0.5 * (vf2 + v02) - m_am * dx, 0.0);
+    if (vs2 > m_vm2)
+    {
+      double tf = (v0 + m_vm) * m_ia
+        - (dx - (vf2 - m_vm2) * m_ia2 + (m_vm2 - v02) * m_ia2) * m_ivm
+        + (vf + m_vm) * m_ia;
+      return tf <= t;
+    }
+    // tf = (2 * vs + v0 + vf) / am <= t
+    double r = m_am * t - v0 - vf;
+    return r >= 0 && 4 * vs2 <= r * r;
+  }
+  // only speed up or down
+  double tf = c0 >= 0 && c1 == 0 ? c0 * m_ia : -c0 * m_ia;
+  return tf <= t;
+}
+
+bool
+BangBangLimiter::CanSwing (
+  const CoordTurntable& initPointing,
+  const CoordTurntable& lastPointing,
+  const BangBangLimiter& azLimiter,
+  const BangBangLimiter& ptLimiter,
+  const Time& t)
+{
+  double dt = t.GetSeconds ();
+  return azLimiter.CanSwing (initPointing.GetAzimuth (), initPointing.GetAzimuthRate (),
+                             lastPointing.GetAzimuth (), lastPointing.GetAzimuthRate (), dt)
+      && ptLimiter.CanSwing (initPointing.GetPitch (), initPointing.GetPitchRate (),
+                             lastPointing.GetPitch (), lastPointing.GetPitchRate (), dt);
+}
+
+} // namespace ns3
@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#ifndef BANG_BANG_LIMITER_H
+#define BANG_BANG_LIMITER_H
+
+#include "ns3/nstime.h"
+#include "ns3/box.h"
+#include "coordinate-turntable.h"
+
+namespace ns3 {
+
+/**
+ * \brief Precomputed limiter of one axis of turntable for the swing time tests
+ *
+ * The reciprocals of the maximum angular rate and acceleration are computed
+ * once per limiter. Whether the axis can swing between two states within a
+ * given time is then decided by the closed-form inverse of the bang-bang
+ * swing time: both sides of the comparison are squared, so no square root
+ * and no division is taken. The decision is exact up to rounding, it agrees
+ * with comparing BangBangController::SwingTime except when the swing time is
+ * within the rounding error of the given time.
+ */
+class BangBangLimiter
+{
+public:
+  /**
+   * \brief Default constructor, the limiter is unit
+   */
+  BangBangLimiter ();
+
+  /**
+   * \brief Precompute the limiter
+   * \param[in] bound the limiter of angle, angular rate and acceleration
+   */
+  BangBangLimiter (const Box& bound);
+
+  /**
+   * \brief Get the limiter
+   * \return the limiter
+   */
+  const Box& GetBound () const;
+
+  /**
+   * \brief Check whether the swing time is not longer than the given time
+   * \param[in] x0  the initial angle
+   * \param[in] v0  the initial angular rate
+   * \param[in] xf  the last angle
+   * \param[in] vf  the last angular rate
+   * \param[in] t   the given time, in second
+   * \return true if the axis can swing to the last state within t
+   */
+  bool CanSwing (double x0, double v0, double xf, double vf, double t) const;
+
+  /**
+   * \brief Check whether both axes can swing between two pointings in time
+   * \param[in] initPointing  the initial pointing
+   * \param[in] lastPointing  the last pointing
+   * \param[in] azLimiter     the azimuth limiter
+   * \param[in] ptLimiter     the pitch limiter
+   * \param[in] t             the given time
+   * \return true if the turntable can swing to the last pointing within t
+   */
+  static bool CanSwing (
+    const CoordTurntable& initPointing,
+    const CoordTurntable& lastPointing,
+    const BangBangLimiter& azLimiter,
+    const BangBangLimiter& ptLimiter,
+    const Time& t);
+private:
+  Box     m_bound;  //!< the limiter
+  double  m_vm;     //!< the maximum angular rate
+  double  m_am;     //!< the maximum angular acceleration
+  double  m_vm2;    //!< the square of maximum angular rate
+  double  m_ia;     //!< the reciprocal of maximum angular acceleration
+  double  m_ia2;    //!< the reciprocal of twice maximum angular acceleration
+  double  m_ivm;    //!< the reciprocal of maximum angular rate
+};
+
+} // namespace ns3
+
+#endif /* BANG_BANG_LIMITER_H */
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <algorithm>
+#include "ns3/assert.h"
+#include "bang-bang-trajectory.h"
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * \brief Compare the time with the start time of segment
+ */
+bool
+IsBefore (const Time& t, const BangBangTrajectory::Segment& segment)
+{
+  return t < segment.t;
+}
+
+} // namespace
+
+BangBangTrajectory::BangBangTrajectory ()
+{
+}
+
+BangBangTrajectory::BangBangTrajectory (const Segments& segments, const Box& bound)
+: m_segments (segments)
+, m_bound    (bound)
+{
+  for (std::size_t i = 1;i < m_segments.size ();++i)
+  {
+    NS_ASSERT (m_segments[i - 1].t <= m_segments[i].t);
+  }
+}
+
+bool
+BangBangTrajectory::IsEmpty () const
+{
+  return m_segments.empty ();
+}
+
+std::size_t
+BangBangTrajectory::GetNSegments () const
+{
+  return m_segments.size ();
+}
+
+const BangBangTrajectory::Segment&
+BangBangTrajectory::GetSegment (std::size_t i) const
+{
+  NS_ASSERT (i < m_segments.size ());
+  return m_segments[i];
+}
+
+Time
+BangBangTrajectory::GetStart () const
+{
+  NS_ASSERT (!m_segments.empty ());
+  return m_segments.front ().t;
+}
+
+Time
+BangBangTrajectory::GetStop () const
+{
+  NS_ASSERT (!m_segments.empty ());
+  return m_segments.back ().t;
+}
+
+BangBangTrajectory::Segment
+BangBangTrajectory::Evaluate (const Time& t) const
+{
+  NS_ASSERT (!m_segments.empty ());
+  // the last segment starting no later than t
+  Segments::const_iterator it = std::upper_bound (m_segments.begin (), m_segments.end (), t, IsBefore);
+  if (it == m_segments.begin ())
+  {
+    Segment state = m_segments.front ();
+    state.t = t;
+    return state;
+  }
+  const Segment& segment = *(--it);
+  double dt = (t - segment.t).GetSeconds ();
+  Segment state;
+  state.t = t;
+  state.x = segment.x + segment.v * dt + 0.5 * segment.a * dt * dt;
+  state.v = segment.v + segment.a * dt;
+  state.a = segment.a;
+  state.x = std::min (std::max (state.x, m_bound.xMin), m_bound.xMax);
+  state.v = std::min (std::max (state.v, m_bound.yMin), m_bound.yMax);
+  return state;
+}
+
+} // namespace ns3
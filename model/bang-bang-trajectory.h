@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#ifndef BANG_BANG_TRAJECTORY_H
+#define BANG_BANG_TRAJECTORY_H
+
+#include <vector>
+#include "ns3/nstime.h"
+#include "ns3/box.h"
+
+namespace ns3 {
+
+/**
+ * \brief Immutable trajectory of one axis of turntable made by a bang-bang scheme
+ *
+ * The scheme is a sequence of segments with constant acceleration, in each
+ * of them the angle is a quadratic polynomial of time. The segments are sorted
+ * by their start times, so the state at any time is found by a binary search
+ * without mutating the trajectory, and can be queried lazily at any instant
+ * instead of polling the controller from simulator events.
+ */
+class BangBangTrajectory
+{
+public:
+  /**
+   * \brief The state at the start of a segment
+   */
+  struct Segment
+  {
+    Time   t;   //!< the start time
+    double x;   //!< the angle, in radian
+    double v;   //!< the angular rate, in radian per second
+    double a;   //!< the angular acceleration kept until the next segment
+  };
+  typedef std::vector<Segment> Segments;
+
+  /**
+   * \brief Default constructor, the trajectory is empty
+   */
+  BangBangTrajectory ();
+
+  /**
+   * \brief Build the trajectory from the segments
+   *
+   * Of the segments starting at the same time, only the last one takes effect.
+   *
+   * \param[in] segments  the segments, sorted by start time
+   * \param[in] bound     the limiter of angle and angular rate
+   */
+  BangBangTrajectory (const Segments& segments, const Box& bound);
+
+  /**
+   * \brief Check whether the trajectory is empty
+   * \return true if there is no segment
+   */
+  bool IsEmpty () const;
+
+  /**
+   * \brief Get the number of segments
+   * \return the number of segments
+   */
+  std::size_t GetNSegments () const;
+
+  /**
+   * \brief Get the segment
+   * \param[in] i the index of segment
+   * \return the segment
+   */
+  const Segment& GetSegment (std::size_t i) const;
+
+  /**
+   * \brief Get the start time of the first segment
+   * \return the start time
+   */
+  Time GetStart () const;
+
+  /**
+   * \brief Get the start time of the last segment, after which the axis stays
+   * \return the stop time
+   */
+  Time GetStop () const;
+
+  /**
+   * \brief Evaluate the state at given time in O(log segments)
+   *
+   * Before the first segment the state of the first segment is returned.
+   * The angle and angular rate are limited into the bound.
+   *
+   * \param[in] t the time
+   * \return the state, whose start time is t
+   */
+  Segment Evaluate (const Time& t) const;
+private:
+  Segments  m_segments;   //!< the segments
+  Box       m_bound;      //!< the limiter
+};
+
+} // namespace ns3
+
+#endif /* BANG_BANG_TRAJECTORY_H */
@@ -0,0 +1,355 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <cmath>
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "fso-atmosphere-model.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FsoAtmosphereModel");
+
+NS_OBJECT_ENSURE_REGISTERED (FsoAtmosphereModel);
+
+namespace {
+
+/**
+ * \brief Kasten-Young air mass, finite at the horizon
+ * \param[in] elevation the elevation, in radian
+ * \return the relative air mass
+ */
+double
+AirMass (double elevation)
+{
+  double deg = std::max (0.0, elevation) * 180.0 / M_PI;
+  return 1.0 / (std::sin (deg * M_PI / 180.0) + 0.50572 * std::pow (deg + 6.07995, -1.6364));
+}
+
+/**
+ * \brief Variance of large-scale log-irradiance from Rytov variance
+ * \param[in] rytov the Rytov variance
+ * \return the variance
+ */
+double
+LargeScaleVariance (double rytov)
+{
+  return 0.49 * rytov / std::pow (1.0 + 1.11 * std::pow (rytov, 1.2), 7.0 / 6.0);
+}
+
+/**
+ * \brief Variance of small-scale log-irradiance from Rytov variance
+ * \param[in] rytov the Rytov variance
+ * \return the variance
+ */
+double
+SmallScaleVariance (double rytov)
+{
+  return 0.51 * rytov / std::pow (1.0 + 0.69 * std::pow (rytov, 1.2), 5.0 / 6.0);
+}
+
+} // namespace
+
+TypeId
+FsoAtmosphereModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FsoAtmosphereModel")
+    .SetParent<Object> ()
+    .SetGroupName ("Fso")
+    .AddConstructor<FsoAtmosphereModel> ()
+    .AddAttribute ("SiteAltitude", "The altitude of station, in meter",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&FsoAtmosphereModel::GetSiteAltitude,
+                                       &FsoAtmosphereModel::SetSiteAltitude),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("Visibility", "The visibility at station, in km",
+                   DoubleValue (23.0),
+                   MakeDoubleAccessor (&FsoAtmosphereModel::GetVisibility,
+                                       &FsoAtmosphereModel::SetVisibility),
+                   MakeDoubleChecker<double> (0.01))
+    .AddAttribute ("WindSpeed", "The rms wind speed of Hufnagel-Valley profile, in m/s",
+                   DoubleValue (21.0),
+                   MakeDoubleAccessor (&FsoAtmosphereModel::GetWindSpeed,
+                                       &FsoAtmosphereModel::SetWindSpeed),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("GroundCn2", "The refractive-index structure parameter at ground, in m^(-2/3)",
+                   DoubleValue (1.7e-14),
+                   MakeDoubleAccessor (&FsoAtmosphereModel::GetGroundCn2,
+                                       &FsoAtmosphereModel::SetGroundCn2),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("TurbulenceTop", "The height of top of turbulence above station, in meter",
+                   DoubleValue (20e3),
+                   MakeDoubleAccessor (&FsoAtmosphereModel::GetTurbulenceTop,
+                                       &FsoAtmosphereModel::SetTurbulenceTop),
+                   MakeDoubleChecker<double> (100.0))
+    .AddAttribute ("ElevationStep", "The elevation step of lookup tables, in degree",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&FsoAtmosphereModel::GetElevationStep,
+                                       &FsoAtmosphereModel::SetElevationStep),
+                   MakeDoubleChecker<double> (0.01, 10.0))
+  ;
+  return tid;
+}
+
+FsoAtmosphereModel::FsoAtmosphereModel ()
+: m_siteAltitude  (0.0)
+, m_visibility    (23.0)
+, m_windSpeed     (21.0)
+, m_groundCn2     (1.7e-14)
+, m_turbulenceTop (20e3)
+, m_elevationStep (0.5)
+, m_profiled      (false)
+, m_mu0           (0.0)
+, m_mu1           (0.0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FsoAtmosphereModel::~FsoAtmosphereModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FsoAtmosphereModel::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+  Reset ();
+  Object::DoDispose ();
+}
+
+void
+FsoAtmosphereModel::SetSiteAltitude (double altitude)
+{
+  NS_LOG_FUNCTION (this << altitude);
+  m_siteAltitude = altitude;
+  Reset ();
+}
+
+double
+FsoAtmosphereModel::GetSiteAltitude (void) const
+{
+  return m_siteAltitude;
+}
+
+void
+FsoAtmosphereModel::SetVisibility (double visibility)
+{
+  NS_LOG_FUNCTION (this << visibility);
+  m_visibility = visibility;
+  Reset ();
+}
+
+double
+FsoAtmosphereModel::GetVisibility (void) const
+{
+  return m_visibility;
+}
+
+void
+FsoAtmosphereModel::SetWindSpeed (double speed)
+{
+  NS_LOG_FUNCTION (this << speed);
+  m_windSpeed = speed;
+  Reset ();
+}
+
+double
+FsoAtmosphereModel::GetWindSpeed (void) const
+{
+  return m_windSpeed;
+}
+
+void
+FsoAtmosphereModel::SetGroundCn2 (double cn2)
+{
+  NS_LOG_FUNCTION (this << cn2);
+  m_groundCn2 = cn2;
+  Reset ();
+}
+
+double
+FsoAtmosphereModel::GetGroundCn2 (void) const
+{
+  return m_groundCn2;
+}
+
+void
+FsoAtmosphereModel::SetTurbulenceTop (double top)
+{
+  NS_LOG_FUNCTION (this << top);
+  m_turbulenceTop = top;
+  Reset ();
+}
+
+double
+FsoAtmosphereModel::GetTurbulenceTop (void) const
+{
+  return m_turbulenceTop;
+}
+
+void
+FsoAtmosphereModel::SetElevationStep (double step)
+{
+  NS_LOG_FUNCTION (this << step);
+  m_elevationStep = step;
+  Reset ();
+}
+
+double
+FsoAtmosphereModel::GetElevationStep (void) const
+{
+  return m_elevationStep;
+}
+
+void
+FsoAtmosphereModel::Reset (void)
+{
+  m_tables.clear ();
+  m_profiled = false;
+}
+
+void
+FsoAtmosphereModel::Prepare (double wavelength)
+{
+  DoGetTable (wavelength);
+}
+
+double
+FsoAtmosphereModel::GetTransmittance (double wavelength, double elevation)
+{
+  return DoInterpolate (wavelength, elevation).transmittance;
+}
+
+double
+FsoAtmosphereModel::GetScintillationIndex (double wavelength, double elevation)
+{
+  return DoInterpolate (wavelength, elevation).scintillation;
+}
+
+void
+FsoAtmosphereModel::GetScintillationVariances (double wavelength, double elevation, double& large, double& small)
+{
+  Entry entry = DoInterpolate (wavelength, elevation);
+  large = entry.large;
+  small = entry.small;
+}
+
+double
+FsoAtmosphereModel::GetBeamWanderLoss (double wavelength, double elevation, double divergence)
+{
+  double wander = DoInterpolate (wavelength, elevation).wander;
+  return 1.0 / (1.0 + wander * std::pow (divergence, -5.0 / 3.0));
+}
+
+void
+FsoAtmosphereModel::DoCalcProfile (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Hufnagel-Valley profile of the height above site, by composite Simpson's rule
+  auto cn2 = [this] (double h) {
+    double v = m_windSpeed / 27.0;
+    return 0.00594 * v * v * std::pow (1e-5 * h, 10.0) * std::exp (-h / 1000.0)
+         + 2.7e-16 * std::exp (-h / 1500.0)
+         + m_groundCn2 * std::exp (-h / 100.0);
+  };
+  const uint32_t n = 8000;
+  double dh = m_turbulenceTop / n;
+  m_mu0 = 0.0;
+  m_mu1 = 0.0;
+  for (uint32_t i = 0;i <= n;++i)
+  {
+    double h = i * dh;
+    double w = (i == 0 || i == n) ? 1.0 : (i % 2 == 1 ? 4.0 : 2.0);
+    double c = cn2 (h);
+    m_mu0 += w * c;
+    m_mu1 += w * c * std::pow (h, 5.0 / 6.0);
+  }
+  m_mu0 *= dh / 3.0;
+  m_mu1 *= dh / 3.0;
+  m_profiled = true;
+  NS_LOG_INFO ("mu0: " << m_mu0 << " mu1: " << m_mu1);
+}
+
+const FsoAtmosphereModel::Table&
+FsoAtmosphereModel::DoGetTable (double wavelength)
+{
+  std::map<double, Table>::const_iterator it = m_tables.find (wavelength);
+  if (it != m_tables.end ())
+  {
+    return it->second;
+  }
+  NS_LOG_FUNCTION (this << wavelength);
+  if (!m_profiled)
+  {
+    DoCalcProfile ();
+  }
+  double k = 2.0 * M_PI / wavelength;
+  double um = wavelength * 1e6;
+  // zenith optical depth of Rayleigh scattering and of aerosol by Kim model
+  double q = m_visibility > 50.0 ? 1.6
+           : m_visibility > 6.0  ? 1.3
+           : m_visibility > 1.0  ? 0.16 * m_visibility + 0.34
+           : m_visibility > 0.5  ? m_visibility - 0.5
+           : 0.0;
+  double tauR = 0.0088 * std::pow (um, -4.05) * std::exp (-m_siteAltitude / 8434.0);
+  double tauA = 3.91 / m_visibility * std::pow (um / 0.55, -q) * 1.2 * std::exp (-m_siteAltitude / 1200.0);
+  // the air mass stands for the secant of zenith angle along the turbulence path,
+  // the path length of uplinks cancels in the long-term beam spread of far field
+  double rytov = 2.25 * std::pow (k, 7.0 / 6.0) * m_mu1;
+  double wander = 4.35 * std::pow (2.0, 5.0 / 6.0) * std::cbrt (k) * m_mu0;
+  uint32_t n = std::ceil (90.0 / m_elevationStep);
+  Table& table = m_tables[wavelength];
+  table.resize (n + 1);
+  for (uint32_t i = 0;i <= n;++i)
+  {
+    double elevation = std::min (90.0, i * m_elevationStep) * M_PI / 180.0;
+    double am = AirMass (elevation);
+    table[i].transmittance = std::exp (-(tauR + tauA) * am);
+    double sigma2 = rytov * std::pow (am, 11.0 / 6.0);
+    table[i].large = LargeScaleVariance (sigma2);
+    table[i].small = SmallScaleVariance (sigma2);
+    // valid from weak to strong fluctuations
+    table[i].scintillation = std::exp (table[i].large + table[i].small) - 1.0;
+    table[i].wander = wander * am;
+  }
+  return table;
+}
+
+FsoAtmosphereModel::Entry
+FsoAtmosphereModel::DoInterpolate (double wavelength, double elevation)
+{
+  const Table& table = DoGetTable (wavelength);
+  double x = std::max (0.0, elevation) * 180.0 / M_PI / m_elevationStep;
+  std::size_t i = std::min ((std::size_t) x, table.size () - 2);
+  double t = std::min (1.0, x - i);
+  const Entry& a = table[i];
+  const Entry& b = table[i + 1];
+  Entry entry;
+  entry.transmittance = a.transmittance + t * (b.transmittance - a.transmittance);
+  entry.scintillation = a.scintillation + t * (b.scintillation - a.scintillation);
+  entry.large = a.large + t * (b.large - a.large);
+  entry.small = a.small + t * (b.small - a.small);
+  entry.wander = a.wander + t * (b.wander - a.wander);
+  return entry;
+}
+
+} // namespace ns3
@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#ifndef FSO_ATMOSPHERE_MODEL_H
+#define FSO_ATMOSPHERE_MODEL_H
+
+#include <map>
+#include <vector>
+#include "ns3/object.h"
+
+namespace ns3 {
+
+/**
+ * \brief Atmospheric profile of one ground station for the satellite-to-ground links
+ *
+ * The extinction follows the Rayleigh scattering and the Kim aerosol model of
+ * the visibility, scaled by the Kasten-Young air mass. The turbulence follows
+ * the Hufnagel-Valley Cn2 profile above the site, the beam wander of uplinks
+ * is taken in the long-term beam spread and the scintillation index of both
+ * directions from the Rytov variance, extended to strong fluctuations.
+ *
+ * The profile integrals are taken once per station, and the transmittance,
+ * the scintillation index and the beam wander coefficient are tabulated over
+ * the elevation once per wavelength, so a query is a table interpolation.
+ * The tables are built at the first query of a wavelength, and they are
+ * cleared whenever a profile attribute is set.
+ */
+class FsoAtmosphereModel : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  FsoAtmosphereModel ();
+  virtual ~FsoAtmosphereModel ();
+
+  /**
+   * \brief Build the table of given wavelength in advance
+   * \param[in] wavelength the wavelength, in meter
+   */
+  void Prepare (double wavelength);
+
+  /**
+   * \brief Get the transmittance of extinction
+   * \param[in] wavelength the wavelength, in meter
+   * \param[in] elevation  the elevation of link, in radian
+   * \return the transmittance
+   */
+  double GetTransmittance (double wavelength, double elevation);
+
+  /**
+   * \brief Get the scintillation index
+   * \param[in] wavelength the wavelength, in meter
+   * \param[in] elevation  the elevation of link, in radian
+   * \return the normalized variance of irradiance
+   */
+  double GetScintillationIndex (double wavelength, double elevation);
+
+  /**
+   * \brief Get the log-irradiance variances of the large-scale and small-scale
+   * fluctuations, which give the parameters of gamma-gamma fading
+   * \param[in]  wavelength the wavelength, in meter
+   * \param[in]  elevation  the elevation of link, in radian
+   * \param[out] large      the variance of large-scale log-irradiance
+   * \param[out] small      the variance of small-scale log-irradiance
+   */
+  void GetScintillationVariances (double wavelength, double elevation, double& large, double& small);
+
+  /**
+   * \brief Get the loss of beam wander of uplink, i.e. the ratio of the short-term
+   * beam area to the long-term one
+   * \param[in] wavelength the wavelength, in meter
+   * \param[in] elevation  the elevation of link, in radian
+   * \param[in] divergence the divergence half-angle of transmitter, in radian
+   * \return the loss of beam wander
+   */
+  double GetBeamWanderLoss (double wavelength, double elevation, double divergence);
+
+  /**
+   * \brief Set the altitude of station, the tables are rebuilt at the next query
+   * \param[in] altitude the altitude of station, in meter
+   */
+  void SetSiteAltitude (double altitude);
+  /**
+   * \return the altitude of station, in meter
+   */
+  double GetSiteAltitude (void) const;
+
+  /**
+   * \brief Set the visibility at station, the tables are rebuilt at the next query
+   * \param[in] visibility the visibility at station, in km
+   */
+  void SetVisibility (double visibility);
+  /**
+   * \return the visibility at station, in km
+   */
+  double GetVisibility (void) const;
+
+  /**
+   * \brief Set the rms wind speed of Hufnagel-Valley profile, the tables are rebuilt at the next query
+   * \param[in] speed the rms wind speed of Hufnagel-Valley profile, in m/s
+   */
+  void SetWindSpeed (double speed);
+  /**
+   * \return the rms wind speed of Hufnagel-Valley profile, in m/s
+   */
+  double GetWindSpeed (void) const;
+
+  /**
+   * \brief Set the refractive-index structure parameter at ground, the tables are rebuilt at the next query
+   * \param[in] cn2 the refractive-index structure parameter at ground, in m^(-2/3)
+   */
+  void SetGroundCn2 (double cn2);
+  /**
+   * \return the refractive-index structure parameter at ground, in m^(-2/3)
+   */
+  double GetGroundCn2 (void) const;
+
+  /**
+   * \brief Set the height of top of turbulence above station, the tables are rebuilt at the next query
+   * \param[in] top the height of top of turbulence above station, in meter
+   */
+  void SetTurbulenceTop (double top);
+  /**
+   * \return the height of top of turbulence above station, in meter
+   */
+  double GetTurbulenceTop (void) const;
+
+  /**
+   * \brief Set the elevation step of lookup tables, the tables are rebuilt at the next query
+   * \param[in] step the elevation step of lookup tables, in degree
+   */
+  void SetElevationStep (double step);
+  /**
+   * \return the elevation step of lookup tables, in degree
+   */
+  double GetElevationStep (void) const;
+
+  /**
+   * \brief Clear the tables, they are rebuilt at the next query
+   */
+  void Reset (void);
+protected:
+  virtual void DoDispose ();
+private:
+  /**
+   * \brief The tabulated values at one elevation
+   */
+  struct Entry
+  {
+    double transmittance;   //!< the transmittance of extinction
+    double scintillation;   //!< the scintillation index
+    double large;           //!< the variance of large-scale log-irradiance
+    double small;           //!< the variance of small-scale log-irradiance
+    double wander;          //!< the beam wander coefficient, multiplied by divergence^(-5/3)
+  };
+  typedef std::vector<Entry> Table;
+
+  /**
+   * \brief Calculate the integrals of Cn2 profile
+   */
+  void DoCalcProfile (void);
+
+  /**
+   * \brief Get the table of given wavelength, build it if absent
+   * \param[in] wavelength the wavelength, in meter
+   * \return the table
+   */
+  const Table& DoGetTable (double wavelength);
+
+  /**
+   * \brief Interpolate the table at given elevation
+   * \param[in] wavelength the wavelength, in meter
+   * \param[in] elevation  the elevation of link, in radian
+   * \return the interpolated entry
+   */
+  Entry DoInterpolate (double wavelength, double elevation);
+
+  double  m_siteAltitude;   //!< the altitude of site, in meter
+  double  m_visibility;     //!< the visibility, in km
+  double  m_windSpeed;      //!< the rms wind speed of high altitude, in m/s
+  double  m_groundCn2;      //!< the Cn2 at ground, in m^(-2/3)
+  double  m_turbulenceTop;  //!< the height of top of turbulence above site, in meter
+  double  m_elevationStep;  //!< the elevation step of tables, in degree
+  bool    m_profiled;       //!< whether the integrals of Cn2 are calculated
+  double  m_mu0;            //!< the integral of Cn2, in m^(1/3)
+  double  m_mu1;            //!< the integral of Cn2 weighted by height^(5/6), in m^(7/6)
+  std::map<double, Table> m_tables;  //!< the tables indexed by wavelength
+};
+
+} // namespace ns3
+
+#endif /* FSO_ATMOSPHERE_MODEL_H */
@@ -18,7 +18,13 @@
  * Author: Wang Junyong (wangjunyong@microsate.com)
  */
 
+#include <cmath>
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/global-value.h"
 #include "fso-channel-list.h"
+#include "turntable.h"
+#include "util.h"
 
 namespace ns3 {
 
@@ -26,6 +32,22 @@ NS_LOG_COMPONENT_DEFINE ("FsoChannelList");
 
 FsoChannelList::FsoChannels FsoChannelList::m_fsoChannels   = FsoChannels ();
 uint32_t                    FsoChannelList::m_channelCount  = 0;
+FsoChannelList::DueQueue    FsoChannelList::m_dues          = DueQueue ();
+uint64_t                    FsoChannelList::m_seq           = 0;
+EventId                     FsoChannelList::m_tickEvent     = EventId ();
+bool                        FsoChannelList::m_clearing      = false;
+
+static GlobalValue g_fsoChannelBatchUpdate (
+  "FsoChannelBatchUpdate",
+  "Update all active fso channels by one ticker instead of one event chain per channel",
+  BooleanValue (false),
+  MakeBooleanChecker ());
+
+bool
+FsoChannelList::Due::operator> (const Due& due) const
+{
+  return ts > due.ts || (ts == due.ts && seq > due.seq);
+}
 
 uint32_t
 FsoChannelList::Add (Ptr<FsoChannel> channel)
@@ -62,4 +84,136 @@ FsoChannelList::Get (Ptr<FsoTxDevice> tx, Ptr<FsoRxDevice> rx)
   return NULL;
 }
 
-}
\ No newline at end of file
+void
+FsoChannelList::SetBatchUpdate (bool enable)
+{
+  g_fsoChannelBatchUpdate.SetValue (BooleanValue (enable));
+}
+
+bool
+FsoChannelList::IsBatchUpdate (void)
+{
+  BooleanValue enable;
+  g_fsoChannelBatchUpdate.GetValue (enable);
+  return enable.Get ();
+}
+
+void
+FsoChannelList::Activate (Ptr<FsoChannel> channel, const Time& next)
+{
+  NS_LOG_FUNCTION (channel << next);
+  NS_ASSERT (channel);
+  NS_ASSERT (next > Now ());
+  if (!m_clearing)
+  {
+    Simulator::ScheduleDestroy (&FsoChannelList::DoClear);
+    m_clearing = true;
+  }
+  m_dues.push (Due {next.GetTimeStep (), m_seq++, channel});
+  DoScheduleTick ();
+}
+
+std::size_t
+FsoChannelList::GetNActiveChannels (void)
+{
+  return m_dues.size ();
+}
+
+void
+FsoChannelList::DoScheduleTick (void)
+{
+  if (m_dues.empty ())
+  {
+    return;
+  }
+  int64_t due = m_dues.top ().ts;
+  if (m_tickEvent.IsRunning ())
+  {
+    if ((int64_t) m_tickEvent.GetTs () <= due)
+    {
+      return;
+    }
+    m_tickEvent.Cancel ();
+  }
+  m_tickEvent = Simulator::Schedule (TimeStep (due) - Now (), &FsoChannelList::DoTick);
+}
+
+void
+FsoChannelList::DoTick (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  int64_t now = Now ().GetTimeStep ();
+  // only the channels due now are popped, in the order of their activation
+  std::vector<Due> dues;
+  while (!m_dues.empty () && m_dues.top ().ts <= now)
+  {
+    NS_ASSERT (m_dues.top ().ts == now);
+    dues.push_back (m_dues.top ());
+    m_dues.pop ();
+  }
+  // swing all channels due now, and gather the pointings of the unknown tracking
+  std::vector<std::size_t> checks;
+  std::vector<double> p1, a1, p2, a2;
+  for (std::size_t i = 0;i < dues.size ();++i)
+  {
+    FsoChannel* channel = PeekPointer (dues[i].channel);
+    channel->DoSwing (channel->m_next++);
+    if (channel->DoKeepTracking ())
+    {
+      continue;
+    }
+    checks.push_back (i);
+    CoordTurntable txPointing = channel->m_link.m_tx->GetTurntable ()->GetPointing ();
+    CoordTurntable rxPointing = channel->m_link.m_rx->GetTurntable ()->GetPointing ();
+    p1.push_back (channel->m_link.m_txCurrTarget.GetPitch ());
+    a1.push_back (channel->m_link.m_txCurrTarget.GetAzimuth ());
+    p2.push_back (txPointing.GetPitch ());
+    a2.push_back (txPointing.GetAzimuth ());
+    p1.push_back (channel->m_link.m_rxCurrTarget.GetPitch ());
+    a1.push_back (channel->m_link.m_rxCurrTarget.GetAzimuth ());
+    p2.push_back (rxPointing.GetPitch ());
+    a2.push_back (rxPointing.GetAzimuth ());
+  }
+  // the included angles in a flat loop, an angle below 1e-6 rad is compared
+  // by its cosine to keep the loop free of acos
+  static const double cosTolerance = std::cos (1e-6);
+  std::size_t n = p1.size ();
+  std::vector<uint8_t> aligned (n);
+  for (std::size_t j = 0;j < n;++j)
+  {
+    double c = std::sin (p1[j]) * std::sin (p2[j]) + std::cos (p1[j]) * std::cos (p2[j]) * std::cos (a1[j] - a2[j]);
+    aligned[j] = c > cosTolerance;
+  }
+  // decide the link states in the order of channels
+  // the finished channels are released, the others are pushed back with their sequences
+  std::size_t k = 0;
+  for (std::size_t i = 0;i < dues.size ();++i)
+  {
+    FsoChannel* channel = PeekPointer (dues[i].channel);
+    bool tracking = true;
+    if (k < checks.size () && checks[k] == i)
+    {
+      tracking = aligned[2 * k] && aligned[2 * k + 1];
+      ++k;
+    }
+    channel->DoTransit (tracking);
+    if (channel->m_next < channel->m_trajectory.GetNKnots ())
+    {
+      channel->m_next = channel->DoSkipKeptKnots ();
+      dues[i].ts = ToTime (channel->m_trajectory.GetKnotTime (channel->m_next)).GetTimeStep ();
+      m_dues.push (dues[i]);
+    }
+  }
+  NS_LOG_INFO ("updated: " << dues.size () << " checked: " << checks.size () << " active: " << m_dues.size ());
+  DoScheduleTick ();
+}
+
+void
+FsoChannelList::DoClear (void)
+{
+  m_tickEvent.Cancel ();
+  m_dues = DueQueue ();
+  m_clearing = false;
+}
+
+}
@@ -21,8 +21,11 @@
 #ifndef FSO_CHANNEL_LIST_H
 #define FSO_CHANNEL_LIST_H
 
+#include <functional>
 #include <map>
+#include <queue>
 #include <vector>
+#include "ns3/event-id.h"
 #include "fso-channel.h"
 
 namespace ns3 {
@@ -34,10 +37,60 @@ public:
   ~FsoChannelList (){}
   static uint32_t Add (Ptr<FsoChannel> channel);
   static Ptr<FsoChannel> Get (Ptr<FsoTxDevice> tx, Ptr<FsoRxDevice> rx);
+  /**
+   * \brief Enable or disable the batched update of fso channels
+   * \param[in] enable true if all active channels are updated by one ticker
+   */
+  static void SetBatchUpdate (bool enable);
+  /**
+   * \brief Check whether the fso channels are updated by the batched ticker
+   * \return true if batched
+   */
+  static bool IsBatchUpdate (void);
+  /**
+   * \brief Register the next update of the channel to the batched ticker
+   * \param[in] channel the fso channel
+   * \param[in] next    the time of next update
+   */
+  static void Activate (Ptr<FsoChannel> channel, const Time& next);
+  /**
+   * \brief Get the number of channels waiting for the batched ticker
+   * \return the number of active channels
+   */
+  static std::size_t GetNActiveChannels (void);
 private:
+  /**
+   * \brief Update all channels due now, the pointing errors are checked in one flat loop
+   */
+  static void DoTick (void);
+  /**
+   * \brief Schedule the ticker at the earliest due time of active channels
+   */
+  static void DoScheduleTick (void);
+  /**
+   * \brief Release the active channels when the simulator is destroyed
+   */
+  static void DoClear (void);
+  /**
+   * \brief The next update of an active channel, ordered by its time and then by
+   * the activation of channel, so the channels due at the same time are updated
+   * in the order they are activated
+   */
+  struct Due
+  {
+    int64_t         ts;       //!< the time step of next update
+    uint64_t        seq;      //!< the sequence of activation
+    Ptr<FsoChannel> channel;  //!< the active channel
+    bool operator> (const Due& due) const;
+  };
+  typedef std::priority_queue<Due, std::vector<Due>, std::greater<Due>> DueQueue;
   typedef std::map<Ptr<FsoTxDevice>, std::map<Ptr<FsoRxDevice>, Ptr<FsoChannel>>> FsoChannels;
   static FsoChannels m_fsoChannels;
   static uint32_t m_channelCount;
+  static DueQueue   m_dues;     //!< the min-heap of next updates of the active channels
+  static uint64_t   m_seq;      //!< the sequence of next activation
+  static EventId    m_tickEvent;//!< the pending ticker
+  static bool       m_clearing; //!< whether the release at destroy is scheduled
 };
 
 }
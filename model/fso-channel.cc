@@ -20,6 +20,8 @@
 
 #include "ns3/node.h"
 #include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
 #include "ns3/net-device.h"
 #include "ns3/adi-helper.h"
 #include "ns3/mobility-model.h"
@@ -30,6 +32,7 @@
 #include "fso-channel-list.h"
 #include "fso-propagation-loss-model.h"
 #include "fso-propagation-delay-model.h"
+#include "bang-bang-limiter.h"
 #include "turntable.h"
 #include "constant.h"
 #include "util.h"
@@ -66,6 +69,29 @@ FsoChannel::GetTypeId (void)
                    TimeValue (Seconds (1.0)),
                    MakeTimeAccessor (&FsoChannel::m_step),
                    MakeTimeChecker (Seconds (0.01), Seconds (1.0)))
+    .AddAttribute ("AngleTolerance",
+                   "The maximum pointing error of the link trajectory between two updates, in radian, "
+                   "zero to update at every link data",
+                   DoubleValue (1e-6),
+                   MakeDoubleAccessor (&FsoChannel::m_angleTolerance),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("DistanceTolerance",
+                   "The maximum distance error of the link trajectory between two updates, in km, "
+                   "zero to update at every link data",
+                   DoubleValue (1e-3),
+                   MakeDoubleAccessor (&FsoChannel::m_distanceTolerance),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("CoalesceUpdates",
+                   "Only evaluate the pointing errors and link state at the knots where the state may change, "
+                   "which are precomputed from the link trajectory and the limiters of turntables, "
+                   "the turntables are commanded directly at the other knots. Set it before the link datas",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&FsoChannel::m_coalesce),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("Record",
+                     "The link state and distance recorded by the turntables at each knot",
+                     MakeTraceSourceAccessor (&FsoChannel::m_recordTrace),
+                     "ns3::FsoChannel::RecordTracedCallback")
   ;
   return tid;
 }
@@ -78,6 +104,11 @@ FsoChannel::FsoChannel ()
 , m_loss      (CreateObject<FsoPropagationLossModel> (this))
 , m_delay     (CreateObject<FsoPropagationDelayModel> ())
 , m_updateEvent(EventId ())
+, m_angleTolerance    (1e-6)
+, m_distanceTolerance (1e-3)
+, m_next      (0)
+, m_coalesce  (false)
+, m_linked    (false)
 {
   NS_LOG_FUNCTION (this << Now ());
 }
@@ -89,6 +120,11 @@ FsoChannel::FsoChannel (const adi::LinkInfo& data)
 , m_loss      (CreateObject<FsoPropagationLossModel> (this))
 , m_delay     (CreateObject<FsoPropagationDelayModel> ())
 , m_updateEvent(EventId ())
+, m_angleTolerance    (1e-6)
+, m_distanceTolerance (1e-3)
+, m_next      (0)
+, m_coalesce  (false)
+, m_linked    (false)
 {
   ;
 }
@@ -206,13 +242,56 @@ FsoChannel::AssignStreams (int64_t stream)
 double
 FsoChannel::CalcChannelLoss ()
 {
-  return m_loss->CalcRxPower (m_link.m_currDistance, NULL, NULL);
+  return m_loss->CalcChannelLoss (GetDistance ());
+}
+
+double
+FsoChannel::CalcChannelLoss (const Time& start, const Time& stop)
+{
+  return m_loss->CalcChannelLoss (GetDistance (), start, stop);
+}
+
+bool
+FsoChannel::IsStochastic (void) const
+{
+  return m_loss->IsStochastic ();
 }
 
 double
 FsoChannel::GetDistance (void) const
 {
-  return m_link.m_currDistance;
+  // the knots are sparse, so the geometry in between is interpolated
+  if (m_trajectory.IsEmpty ())
+  {
+    return m_link.m_currDistance;
+  }
+  return m_trajectory.Evaluate (ToTime (Now ())).distance;
+}
+
+CoordTurntable
+FsoChannel::GetTxTarget (void) const
+{
+  if (m_trajectory.IsEmpty ())
+  {
+    return m_link.m_txCurrTarget;
+  }
+  return m_trajectory.Evaluate (ToTime (Now ())).fromSrc;
+}
+
+CoordTurntable
+FsoChannel::GetRxTarget (void) const
+{
+  if (m_trajectory.IsEmpty ())
+  {
+    return m_link.m_rxCurrTarget;
+  }
+  return m_trajectory.Evaluate (ToTime (Now ())).fromDst;
+}
+
+const FsoLinkTrajectory&
+FsoChannel::GetLinkTrajectory (void) const
+{
+  return m_trajectory;
 }
 
 void
@@ -233,7 +312,7 @@ FsoChannel::StartSending (Ptr<FsoTxDevice> txFso)
   m_sendStart = Now ();
   m_link.m_state = CONNECTED;
   m_sendingEvent = Simulator::Schedule (
-    m_delay->GetDelay (m_link.m_currDistance),
+    m_delay->GetDelay (GetDistance ()),
     &FsoRxDevice::NotifyConnectionSucceeded,
     m_link.m_rx
     );
@@ -263,6 +342,11 @@ FsoChannel::DoDispose ()
   m_loss = 0;
   m_delay = 0;
   m_updateEvent = EventId ();
+  m_trajectory = FsoLinkTrajectory ();
+  m_next = 0;
+  m_keep.clear ();
+  DoCancelKeptKnots ();
+  m_linked = false;
   Channel::DoDispose ();
 }
 
@@ -276,20 +360,98 @@ FsoChannel::DoUpdate ()
   NS_ASSERT (m_delay);
   NS_ASSERT (m_nDevices == N_DEVICES);
   Time now = Now ();
-  DoSwing ();
-  // cannot exceeds the simulation stop time
-  NS_ASSERT (now < SimulationStop);
-  double a1 = m_link.m_txCurrTarget.GetIncludedAngle (m_link.m_tx->GetTurntable ()->GetPointing ());
-  double a2 = m_link.m_rxCurrTarget.GetIncludedAngle (m_link.m_rx->GetTurntable ()->GetPointing ());
-  //
-  // Decide the current state of fso link
-  //
+  DoSwing (m_next++);
   bool tracking = false;
-  if (a1 < 1e-6 && a2 < 1e-6)
+  if (DoKeepTracking ())
   {
+    // the turntables have swung to the current targets in time
     tracking = true;
   }
-  if (tracking == true && m_link.m_currDistance <= adi::K_MAX_DISTANCE)
+  else
+  {
+    double a1 = m_link.m_txCurrTarget.GetIncludedAngle (m_link.m_tx->GetTurntable ()->GetPointing ());
+    double a2 = m_link.m_rxCurrTarget.GetIncludedAngle (m_link.m_rx->GetTurntable ()->GetPointing ());
+    if (a1 < 1e-6 && a2 < 1e-6)
+    {
+      tracking = true;
+    }
+  }
+  DoTransit (tracking);
+  if (m_next >= m_trajectory.GetNKnots ())
+  {
+    return;
+  }
+  m_next = DoSkipKeptKnots ();
+  Time next = ToTime (m_trajectory.GetKnotTime (m_next));
+  if (FsoChannelList::IsBatchUpdate ())
+  {
+    FsoChannelList::Activate (this, next);
+  }
+  else
+  {
+    Simulator::Schedule (next - now, &FsoChannel::DoUpdate, this);
+  }
+}
+
+bool
+FsoChannel::DoKeepTracking () const
+{
+  // the transitions are not precomputed if CoalesceUpdates is set after the link datas
+  std::size_t k = m_next - 1;
+  return m_coalesce && m_linked && k < m_keep.size () && m_keep[k];
+}
+
+std::size_t
+FsoChannel::DoSkipKeptKnots ()
+{
+  // the events of the knots skipped by the last update are all done
+  m_kept.clear ();
+  std::size_t next = m_next;
+  if (!m_coalesce || !m_linked)
+  {
+    return next;
+  }
+  // the last knot is always visited to finish the connection
+  Time now = Now ();
+  while (next + 1 < m_trajectory.GetNKnots () && next < m_keep.size () && m_keep[next])
+  {
+    Time delay = ToTime (m_trajectory.GetKnotTime (next)) - now;
+    m_kept.push_back (Simulator::Schedule (delay, &FsoChannel::DoKeepKnot, this, next));
+    ++next;
+  }
+  return next;
+}
+
+void
+FsoChannel::DoKeepKnot (std::size_t k)
+{
+  NS_LOG_FUNCTION (this << k);
+  DoSwing (k);
+  // the link is kept, so the state only changes by the devices in between
+  DoRecord ();
+}
+
+void
+FsoChannel::DoCancelKeptKnots ()
+{
+  for (std::size_t i = 0;i < m_kept.size ();++i)
+  {
+    m_kept[i].Cancel ();
+  }
+  m_kept.clear ();
+}
+
+void
+FsoChannel::DoTransit (bool tracking)
+{
+  NS_LOG_FUNCTION (this << tracking);
+  // cannot exceeds the simulation stop time
+  NS_ASSERT (Now () < SimulationStop);
+  //
+  // Decide the current state of fso link
+  //
+  m_linked = tracking && m_link.m_currDistance <= adi::K_MAX_DISTANCE;
+  if (m_linked)
   {
     if (m_link.m_state == UNCONNECTED || m_link.m_state == DISCONNECTED)
     {
@@ -328,11 +490,17 @@ FsoChannel::DoUpdate ()
       m_link.m_tx->NotifyConnectionFailed ();
     }
   }
-  if (m_linkDatas.empty ())
+  if (m_next >= m_trajectory.GetNKnots ())
   {
     Simulator::Schedule (m_step, &FsoTxDevice::NotifyConnectionFinished, m_link.m_tx);
     m_link.m_state = CONNECTION_DONE;
   }
+  DoRecord ();
+}
+
+void
+FsoChannel::DoRecord ()
+{
   switch (m_link.m_state)
   {
     case UNCONNECTED:     NS_LOG_INFO (Now ().As (Time::S) << " Unconnected "     << m_link.m_currDistance);  break;
@@ -349,11 +517,7 @@ FsoChannel::DoUpdate ()
   NS_LOG_INFO (m_link.m_rx->GetTurntable ()->GetPointing ());
   m_link.m_tx->GetTurntable ()->NotifyToRecord (m_link.m_state, m_link.m_currDistance);
   m_link.m_rx->GetTurntable ()->NotifyToRecord (m_link.m_state, m_link.m_currDistance);
-  if (m_linkDatas.empty ())
-  {
-    return;
-  }
-  Simulator::Schedule (m_linkDatas.front ().t - now, &FsoChannel::DoUpdate, this);
+  m_recordTrace (m_link.m_state, m_link.m_currDistance);
 }
 
 void
@@ -364,32 +528,84 @@ FsoChannel::DoAppend (const adi::LinkDatas& data)
   for (uint32_t i = 0;i < data.size ();++i)
   {
     NS_ASSERT (data[i].time > now);
-    Time t = ToTime (data[i].time);
     if (i > 0)
     {
       NS_ASSERT (data[i].time > data[i - 1].time);
     }
-    m_linkDatas.push (LinkData {t, data[i].distance, data[i].fromSrc, data[i].fromDst});
   }
+  // only the knots of trajectory are visited, the link datas in between
+  // are reproduced by the interpolation within the tolerances
+  m_trajectory = FsoLinkTrajectory (data, m_angleTolerance, m_distanceTolerance);
+  DoCancelKeptKnots ();
+  m_next = 0;
+  m_linked = false;
+  if (m_coalesce)
+  {
+    DoCalcTransitions ();
+  }
+  NS_LOG_INFO ("link datas: " << data.size () << " knots: " << m_trajectory.GetNKnots ());
   DoUpdate ();
 }
 
 void
-FsoChannel::DoSwing ()
+FsoChannel::DoSwing (std::size_t k)
+{
+  NS_LOG_FUNCTION (this << k);
+  FsoLinkTrajectory::Sample curr = m_trajectory.GetKnot (k);
+  m_link.m_txCurrTarget = curr.fromSrc;
+  m_link.m_rxCurrTarget = curr.fromDst;
+  m_link.m_currDistance = curr.distance;
+  if (k + 1 < m_trajectory.GetNKnots ())
+  {
+    FsoLinkTrajectory::Sample pred = m_trajectory.GetKnot (k + 1);
+    Time t = ToTime (m_trajectory.GetKnotTime (k + 1));
+    m_link.m_txPredTarget = pred.fromSrc;
+    m_link.m_rxPredTarget = pred.fromDst;
+    m_link.m_predDistance = pred.distance;
+    m_link.m_tx->GetTurntable ()->SetTargetPointing (t, m_link.m_txPredTarget);
+    m_link.m_rx->GetTurntable ()->SetTargetPointing (t, m_link.m_rxPredTarget);
+  }
+}
+
+void
+FsoChannel::DoCalcTransitions ()
 {
   NS_LOG_FUNCTION (this);
-  m_link.m_txCurrTarget = m_linkDatas.front ().fromSrc;
-  m_link.m_rxCurrTarget = m_linkDatas.front ().fromDst;
-  m_link.m_currDistance = m_linkDatas.front ().distance;
-  m_linkDatas.pop ();
-  if (!m_linkDatas.empty ())
+  Ptr<Turntable> tx = m_link.m_tx->GetTurntable ();
+  Ptr<Turntable> rx = m_link.m_rx->GetTurntable ();
+  BangBangLimiter txAz (tx->GetAzimuthLimiter ());
+  BangBangLimiter txPt (tx->GetPitchLimiter ());
+  BangBangLimiter rxAz (rx->GetAzimuthLimiter ());
+  BangBangLimiter rxPt (rx->GetPitchLimiter ());
+  // the controllers limit the targets out of bound, the swings are not predictable then
+  auto inBound = [] (const CoordTurntable& p, const BangBangLimiter& az, const BangBangLimiter& pt) {
+    const Box& a = az.GetBound ();
+    const Box& b = pt.GetBound ();
+    return p.GetAzimuth () >= a.xMin && p.GetAzimuth () <= a.xMax
+        && p.GetAzimuthRate () >= a.yMin && p.GetAzimuthRate () <= a.yMax
+        && p.GetPitch () >= b.xMin && p.GetPitch () <= b.xMax
+        && p.GetPitchRate () >= b.yMin && p.GetPitchRate () <= b.yMax;
+  };
+  std::size_t n = m_trajectory.GetNKnots ();
+  m_keep.assign (n, false);
+  std::size_t nTransitions = n > 0 ? 1 : 0;
+  for (std::size_t k = 1;k < n;++k)
   {
-    m_link.m_txPredTarget = m_linkDatas.front ().fromSrc;
-    m_link.m_rxPredTarget = m_linkDatas.front ().fromDst;
-    m_link.m_predDistance = m_linkDatas.front ().distance;
-    m_link.m_tx->GetTurntable ()->SetTargetPointing (m_linkDatas.front ().t, m_link.m_txPredTarget);
-    m_link.m_rx->GetTurntable ()->SetTargetPointing (m_linkDatas.front ().t, m_link.m_rxPredTarget);
+    FsoLinkTrajectory::Sample former = m_trajectory.GetKnot (k - 1);
+    FsoLinkTrajectory::Sample latter = m_trajectory.GetKnot (k);
+    Time dt = ToTime (m_trajectory.GetKnotTime (k)) - ToTime (m_trajectory.GetKnotTime (k - 1));
+    CoordTurntable txFormer = former.fromSrc;
+    CoordTurntable txLatter = latter.fromSrc;
+    CoordTurntable rxFormer = former.fromDst;
+    CoordTurntable rxLatter = latter.fromDst;
+    m_keep[k] = latter.distance <= adi::K_MAX_DISTANCE
+      && inBound (txLatter, txAz, txPt)
+      && inBound (rxLatter, rxAz, rxPt)
+      && BangBangLimiter::CanSwing (txFormer, txLatter, txAz, txPt, dt)
+      && BangBangLimiter::CanSwing (rxFormer, rxLatter, rxAz, rxPt, dt);
+    nTransitions += m_keep[k] ? 0 : 1;
   }
+  NS_LOG_INFO ("knots: " << n << " possible transitions: " << nTransitions);
 }
 
-} //namespace ns3
\ No newline at end of file
+} //namespace ns3
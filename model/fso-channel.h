@@ -20,13 +20,14 @@
 #ifndef FSO_CHANNEL_H
 #define FSO_CHANNEL_H
 
-#include <queue>
 #include "ns3/channel.h"
 #include "ns3/event-id.h"
 #include "ns3/callback.h"
+#include "ns3/traced-callback.h"
 #include "coordinate-turntable.h"
 #include "fso-tx-device.h"
 #include "fso-rx-device.h"
+#include "fso-link-trajectory.h"
 #include "adi-type-define.h"
 
 namespace ns3 {
@@ -57,6 +58,7 @@ std::string FsoLinkStateToString (const FsoLinkState& state);
 
 class FsoChannel : public Channel
 {
+  friend class FsoChannelList;
 public:
   static TypeId GetTypeId (void);
   FsoChannel ();
@@ -73,7 +75,39 @@ public:
   void SetPropagationLossModel (const Ptr<FsoPropagationLossModel> loss);
   void SetPropagationDelayModel (const Ptr<FsoPropagationDelayModel> delay);
   double CalcChannelLoss ();
+  /**
+   * \brief Calculate the channel loss averaged over the given period, with the
+   * fading sampled by the loss model if it is stochastic
+   * \param[in] start the start of period
+   * \param[in] stop  the stop of period
+   * \return the channel loss
+   */
+  double CalcChannelLoss (const Time& start, const Time& stop);
+  /**
+   * \brief Check whether the loss of this channel is sampled with fading
+   * \return true if stochastic
+   */
+  bool IsStochastic (void) const;
+  /**
+   * \brief Get the current distance, interpolated by the link trajectory between the knots
+   * \return the distance between two parties, in km
+   */
   double GetDistance (void) const;
+  /**
+   * \brief Get the current target pointing of tx turntable, interpolated by the link trajectory
+   * \return the pointing from source to destination
+   */
+  CoordTurntable GetTxTarget (void) const;
+  /**
+   * \brief Get the current target pointing of rx turntable, interpolated by the link trajectory
+   * \return the pointing from destination to source
+   */
+  CoordTurntable GetRxTarget (void) const;
+  /**
+   * \brief Get the adaptive-step trajectory of the link
+   * \return the trajectory, which can be evaluated at arbitrary times
+   */
+  const FsoLinkTrajectory& GetLinkTrajectory (void) const;
   /**
    * \brief Attach the fso devices at given time
    * \param[in] tx    the fso tx device
@@ -83,15 +117,13 @@ public:
   void Attach (Ptr<FsoDevice> tx, Ptr<FsoDevice> rx, const adi::LinkDatas& data);
   void StartSending (Ptr<FsoTxDevice> txFso);
   void StopSending (Ptr<FsoTxDevice> txFso);
+  /**
+   * \brief TracedCallback signature for the records of link state
+   * \param[in] state    the link state
+   * \param[in] distance the distance between two parties, in km
+   */
+  typedef void (* RecordTracedCallback) (FsoLinkState state, double distance);
 private:
-  struct LinkData
-  {
-    Time t;
-    double distance;
-    adi::Pointing fromSrc;
-    adi::Pointing fromDst;
-  };
-  typedef std::queue<LinkData> LinkDatas;
   /**
    * \brief Set the fso-tx-device
    * \param[in] fsoDevice the fso-tx-device 
@@ -120,9 +152,55 @@ private:
    */
   void DoAppend (const adi::LinkDatas& data);
 
-  void DoSwing ();
+  /**
+   * \brief Take the targets of the given knot as the current ones,
+   * and command the turntables to the targets of the next knot
+   * \param[in] k the index of knot
+   */
+  void DoSwing (std::size_t k);
+  /**
+   * \brief Precompute at which knots the tracking of both turntables carries over
+   * from the former knot, i.e. the turntables can swing from the former targets to
+   * the current ones in time and the link is in range, so the link state cannot change
+   */
+  void DoCalcTransitions ();
+  /**
+   * \brief Check whether the tracking at the current knot is known in advance
+   * \return true if the turntables keep tracking from the former knot
+   */
+  bool DoKeepTracking () const;
+  /**
+   * \brief Schedule the swings and records of the knots kept tracking after the
+   * current one, the link state is not decided at them
+   * \return the index of the knot at which the link state may change
+   */
+  std::size_t DoSkipKeptKnots ();
+  /**
+   * \brief Swing at a kept knot and record the link state, which carries over
+   * from the former knot, as DoUpdate does at the knot without CoalesceUpdates
+   * \param[in] k the index of knot
+   */
+  void DoKeepKnot (std::size_t k);
+  /**
+   * \brief Cancel the swings and records scheduled at the kept knots
+   */
+  void DoCancelKeptKnots ();
+  /**
+   * \brief Log the link state and notify the turntables to record it
+   */
+  void DoRecord ();
+  /**
+   * \brief Decide the link state at the current knot and notify the devices and turntables
+   * \param[in] tracking whether both turntables are tracking the current targets
+   */
+  void DoTransit (bool tracking);
   virtual void DoInitialize ();
   virtual void DoDispose ();
+  /**
+   * \brief Swing to the next knot, decide the link state and schedule the next update,
+   * either by itself or by the batched ticker of FsoChannelList. With CoalesceUpdates
+   * the next update is at the next knot where the link state may change
+   */
   virtual void DoUpdate ();
   class Link
   {
@@ -160,7 +238,15 @@ private:
   EventId   m_finishedEvent;
   EventId   m_txStartedEvent;
   EventId   m_rxStartedEvent;
-  LinkDatas m_linkDatas;
+  double    m_angleTolerance;     //!< Pointing tolerance of the link trajectory, in radian
+  double    m_distanceTolerance;  //!< Distance tolerance of the link trajectory, in km
+  FsoLinkTrajectory m_trajectory; //!< Adaptive-step trajectory of the link
+  std::size_t       m_next;       //!< Index of the next knot of trajectory
+  bool              m_coalesce;   //!< Whether only the knots of possible transitions are evaluated
+  std::vector<bool> m_keep;       //!< Whether the link state is kept at each knot if linked before
+  std::vector<EventId> m_kept;    //!< The events of the kept knots scheduled by the last update
+  bool              m_linked;     //!< Whether both turntables tracked the targets in range at last knot
+  TracedCallback<FsoLinkState, double> m_recordTrace; //!< The link state and distance recorded at each knot
 };
 
 } //namespace ns3
@@ -28,6 +28,7 @@
 #include "qkd-node.h"
 #include "turntable.h"
 #include "fso-channel.h"
+#include "fso-atmosphere-model.h"
 #include "q3p-l3-protocol.h"
 #include "constant.h"
 #include "util.h"
@@ -77,6 +78,7 @@ FsoDevice::FsoDevice ()
 , m_connectionFailed (MakeNullCallback<void> ())
 , m_connectionEvent (EventId ())
 , m_swingEvent (EventId ())
+, m_parameterVersion (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -162,6 +164,20 @@ FsoDevice::GetTurntable () const
   return m_turntable;
 }
 
+void
+FsoDevice::SetAtmosphere (Ptr<FsoAtmosphereModel> atmosphere)
+{
+  NS_LOG_FUNCTION (this << atmosphere);
+  m_atmosphere = atmosphere;
+  NotifyParameterChanged ();
+}
+
+Ptr<FsoAtmosphereModel>
+FsoDevice::GetAtmosphere () const
+{
+  return m_atmosphere;
+}
+
 void
 FsoDevice::SetConnectCallback (
   Callback<void> connectionStarted,
@@ -195,6 +211,18 @@ FsoDevice::GetRoundInterval (Time& start, Time& stop) const
   stop  = m_timeStop;
 }
 
+uint32_t
+FsoDevice::GetParameterVersion (void) const
+{
+  return m_parameterVersion;
+}
+
+void
+FsoDevice::NotifyParameterChanged (void)
+{
+  ++m_parameterVersion;
+}
+
 // bool Compare (const std::pair<Time, CoordTurntable>& first, const std::pair<Time, CoordTurntable>& second)
 // {
 //   return first.first < second.first;
@@ -241,6 +269,7 @@ FsoDevice::DoDispose ()
   m_node = 0;
   m_netDevice = 0;
   m_turntable = 0;
+  m_atmosphere = 0;
   m_channel = 0;
   m_connectionStarted = MakeNullCallback<void> ();
   m_connectionFinished = MakeNullCallback<void> ();
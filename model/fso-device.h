@@ -38,6 +38,7 @@ class NetDevice;
 class FsoChannel;
 class Node;
 class Turntable;
+class FsoAtmosphereModel;
 
 class FsoDevice : public Object
 {
@@ -121,6 +122,18 @@ public:
    */
   Ptr<Turntable> GetTurntable () const;
 
+  /**
+   * \brief Set the atmospheric profile of the station this device is installed on
+   * \param[in] atmosphere the atmospheric profile, null for the devices in space
+   */
+  void SetAtmosphere (Ptr<FsoAtmosphereModel> atmosphere);
+
+  /**
+   * \brief Get the atmospheric profile
+   * \return the atmospheric profile, null for the devices in space
+   */
+  Ptr<FsoAtmosphereModel> GetAtmosphere () const;
+
   /**
    * \brief Set the FsoChannel
    * \param channel the FsoChannel
@@ -189,6 +202,13 @@ public:
   adi::Interval GetInterval () const;
 
   void GetRoundInterval (Time& start, Time& stop) const;
+
+  /**
+   * \brief Get the version of the optical parameters, which is increased
+   * whenever a parameter affecting the channel loss is set
+   * \return the version
+   */
+  uint32_t GetParameterVersion (void) const;
   // /**
   //  * \brief Append the target, for swinging the turntable before link established
   //  * \param[in] time the time that turntable should swing to target
@@ -205,11 +225,16 @@ protected:
   virtual void DoDispose ();
   virtual void NotifyNewAggregate ();
   virtual int64_t DoAssignStream (int64_t stream);
+  /**
+   * \brief Notify that an optical parameter affecting the channel loss has been set
+   */
+  void NotifyParameterChanged (void);
 protected:
   Ptr<Node>       m_node;       //!< The node associated to this FsoDevice
   Ptr<QkdDevice>  m_qkdDevice;  //!< The qkd device associated to this FsoDevice
   Ptr<NetDevice>  m_netDevice;  //!< The net device associated to this FsoDevice
   Ptr<Turntable>  m_turntable;  //!< The turntable associated to this FsoDevice
+  Ptr<FsoAtmosphereModel> m_atmosphere; //!< The atmospheric profile of station, null in space
   Ptr<FsoChannel> m_channel;    //!< The free-space-optical channel associated to this FsoDevice
   Callback<void> m_connectionStarted;    //!< connection started callback
   Callback<void> m_connectionFinished;   //!< connection finished callback
@@ -225,6 +250,7 @@ protected:
   Time m_timeStop;               //!< time stop
   std::vector<std::pair<Time, CoordTurntable>> m_targets;
   EventId m_swingEvent;
+  uint32_t m_parameterVersion;   //!< the version of optical parameters
 private:
 
   /**
@@ -0,0 +1,314 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <cmath>
+#include <algorithm>
+#include "fso-link-trajectory.h"
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * \brief Wrap the angle into [-PI, PI]
+ * \param[in] angle the angle, in radian
+ * \return the wrapped angle
+ */
+double
+WrapAngle (double angle)
+{
+  return std::remainder (angle, 2.0 * M_PI);
+}
+
+/**
+ * \brief Check whether the value is in tolerance
+ * \param[in] value     the interpolated value
+ * \param[in] expected  the expected value
+ * \param[in] tolerance the tolerance
+ * \return true if the difference is in tolerance
+ */
+bool
+IsInTolerance (double value, double expected, double tolerance)
+{
+  return std::fabs (value - expected) <= tolerance;
+}
+
+} // anonymous namespace
+
+double
+FsoLinkTrajectory::CalcDerivative (const Knots& samples, std::size_t lo, double t, std::size_t v)
+{
+  std::size_t n = std::min<std::size_t> (samples.size () - lo, 3);
+  if (n == 1)
+  {
+    return 0.0;
+  }
+  const Knot& k0 = samples[lo];
+  const Knot& k1 = samples[lo + 1];
+  if (n == 2)
+  {
+    return (k1.value[v] - k0.value[v]) / (k1.t - k0.t);
+  }
+  // derivative of the Lagrange polynomial through three samples
+  const Knot& k2 = samples[lo + 2];
+  return k0.value[v] * (2.0 * t - k1.t - k2.t) / ((k0.t - k1.t) * (k0.t - k2.t))
+       + k1.value[v] * (2.0 * t - k0.t - k2.t) / ((k1.t - k0.t) * (k1.t - k2.t))
+       + k2.value[v] * (2.0 * t - k0.t - k1.t) / ((k2.t - k0.t) * (k2.t - k1.t));
+}
+
+FsoLinkTrajectory::FsoLinkTrajectory ()
+: m_start             (adi::DateTime ())
+, m_angleTolerance    (0.0)
+, m_distanceTolerance (0.0)
+{
+}
+
+FsoLinkTrajectory::FsoLinkTrajectory (
+  const adi::LinkDatas& data,
+  double angleTolerance,
+  double distanceTolerance
+)
+: m_start             (data.empty () ? adi::DateTime () : data.front ().time)
+, m_angleTolerance    (angleTolerance)
+, m_distanceTolerance (distanceTolerance)
+{
+  std::size_t n = data.size ();
+  if (n == 0)
+  {
+    return;
+  }
+  // convert the link datas into samples, azimuths are unwrapped so that
+  // they are continuous over the whole window
+  Knots samples (n);
+  for (std::size_t i = 0;i < n;++i)
+  {
+    const adi::LinkData& d = data[i];
+    Knot& k = samples[i];
+    k.ticks = (d.time - m_start).Ticks ();
+    k.t = (d.time - m_start).TotalSeconds ();
+    k.value[0] = d.distance;
+    k.value[1] = d.fromSrc.angle.azimuth;
+    k.value[2] = d.fromSrc.angle.pitch;
+    k.value[3] = d.fromDst.angle.azimuth;
+    k.value[4] = d.fromDst.angle.pitch;
+    k.given[1] = d.fromSrc.rate.azimuth;
+    k.given[2] = d.fromSrc.rate.pitch;
+    k.given[3] = d.fromDst.rate.azimuth;
+    k.given[4] = d.fromDst.rate.pitch;
+    if (i > 0)
+    {
+      const Knot& p = samples[i - 1];
+      k.value[1] = p.value[1] + WrapAngle (k.value[1] - p.value[1]);
+      k.value[3] = p.value[3] + WrapAngle (k.value[3] - p.value[3]);
+    }
+  }
+  // the slopes are taken from the samples rather than the given rates, so
+  // that the polynomials are consistent with the sampled geometry
+  for (std::size_t i = 0;i < n;++i)
+  {
+    std::size_t lo = std::min (i > 0 ? i - 1 : 0, n < 3 ? 0 : n - 3);
+    for (std::size_t v = 0;v < N_VALUES;++v)
+    {
+      samples[i].rate[v] = CalcDerivative (samples, lo, samples[i].t, v);
+    }
+    samples[i].given[0] = samples[i].rate[0];
+  }
+  // greedily extend each segment as far as the Hermite polynomial fits,
+  // growing the span exponentially and then bisecting the last step
+  m_knots.push_back (samples[0]);
+  std::size_t i = 0;
+  while (i + 1 < n)
+  {
+    std::size_t good = i + 1;
+    std::size_t bad = n;
+    std::size_t span = 2;
+    while (i + span < n)
+    {
+      if (!IsFitted (samples, i, i + span))
+      {
+        bad = i + span;
+        break;
+      }
+      good = i + span;
+      span *= 2;
+    }
+    if (bad == n && good != n - 1)
+    {
+      if (IsFitted (samples, i, n - 1))
+      {
+        good = n - 1;
+      }
+      else
+      {
+        bad = n - 1;
+      }
+    }
+    while (bad - good > 1)
+    {
+      std::size_t mid = good + (bad - good) / 2;
+      if (IsFitted (samples, i, mid))
+      {
+        good = mid;
+      }
+      else
+      {
+        bad = mid;
+      }
+    }
+    m_knots.push_back (samples[good]);
+    i = good;
+  }
+}
+
+bool
+FsoLinkTrajectory::IsFitted (const Knots& samples, std::size_t i, std::size_t j) const
+{
+  const Knot& k0 = samples[i];
+  const Knot& k1 = samples[j];
+  for (std::size_t k = i + 1;k < j;++k)
+  {
+    const Knot& s = samples[k];
+    for (std::size_t v = 0;v < N_VALUES;++v)
+    {
+      double rate;
+      double value = Interpolate (k0, k1, s.t, v, rate);
+      double tolerance = v == 0 ? m_distanceTolerance : m_angleTolerance;
+      if (!IsInTolerance (value, s.value[v], tolerance))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+double
+FsoLinkTrajectory::Interpolate (const Knot& k0, const Knot& k1, double t, std::size_t v, double& rate)
+{
+  double h = k1.t - k0.t;
+  double s = (t - k0.t) / h;
+  double s2 = s * s;
+  double s3 = s2 * s;
+  double h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+  double h10 = s3 - 2.0 * s2 + s;
+  double h01 = -2.0 * s3 + 3.0 * s2;
+  double h11 = s3 - s2;
+  double d00 = 6.0 * s2 - 6.0 * s;
+  double d10 = 3.0 * s2 - 4.0 * s + 1.0;
+  double d01 = -6.0 * s2 + 6.0 * s;
+  double d11 = 3.0 * s2 - 2.0 * s;
+  double p0 = k0.value[v];
+  double p1 = k1.value[v];
+  double m0 = k0.rate[v] * h;
+  double m1 = k1.rate[v] * h;
+  rate = (d00 * p0 + d10 * m0 + d01 * p1 + d11 * m1) / h;
+  return h00 * p0 + h10 * m0 + h01 * p1 + h11 * m1;
+}
+
+FsoLinkTrajectory::Sample
+FsoLinkTrajectory::ToSample (const Knot& knot, const double* rate)
+{
+  Sample sample;
+  sample.distance              = knot.value[0];
+  sample.rate                  = rate[0];
+  sample.fromSrc.angle.azimuth = WrapAngle (knot.value[1]);
+  sample.fromSrc.angle.pitch   = knot.value[2];
+  sample.fromDst.angle.azimuth = WrapAngle (knot.value[3]);
+  sample.fromDst.angle.pitch   = knot.value[4];
+  sample.fromSrc.rate.azimuth  = rate[1];
+  sample.fromSrc.rate.pitch    = rate[2];
+  sample.fromDst.rate.azimuth  = rate[3];
+  sample.fromDst.rate.pitch    = rate[4];
+  return sample;
+}
+
+bool
+FsoLinkTrajectory::IsEmpty () const
+{
+  return m_knots.empty ();
+}
+
+std::size_t
+FsoLinkTrajectory::GetNKnots () const
+{
+  return m_knots.size ();
+}
+
+adi::DateTime
+FsoLinkTrajectory::GetKnotTime (std::size_t i) const
+{
+  return m_start.AddTicks (m_knots[i].ticks);
+}
+
+FsoLinkTrajectory::Sample
+FsoLinkTrajectory::GetKnot (std::size_t i) const
+{
+  return ToSample (m_knots[i], m_knots[i].given);
+}
+
+adi::DateTime
+FsoLinkTrajectory::GetStart () const
+{
+  return m_start;
+}
+
+adi::DateTime
+FsoLinkTrajectory::GetStop () const
+{
+  return m_knots.empty () ? m_start : GetKnotTime (m_knots.size () - 1);
+}
+
+FsoLinkTrajectory::Sample
+FsoLinkTrajectory::Evaluate (const adi::DateTime& t) const
+{
+  if (m_knots.empty ())
+  {
+    return Sample ();
+  }
+  double seconds = (t - m_start).TotalSeconds ();
+  if (seconds <= m_knots.front ().t)
+  {
+    return ToSample (m_knots.front (), m_knots.front ().given);
+  }
+  if (seconds >= m_knots.back ().t)
+  {
+    return ToSample (m_knots.back (), m_knots.back ().given);
+  }
+  Knots::const_iterator it = std::upper_bound (
+    m_knots.begin (), m_knots.end (), seconds,
+    [] (double s, const Knot& k) { return s < k.t; }
+    );
+  const Knot& k1 = *it;
+  const Knot& k0 = *(it - 1);
+  if (seconds == k0.t)
+  {
+    return ToSample (k0, k0.given);
+  }
+  Knot knot;
+  knot.ticks = (t - m_start).Ticks ();
+  knot.t = seconds;
+  for (std::size_t v = 0;v < N_VALUES;++v)
+  {
+    knot.value[v] = Interpolate (k0, k1, seconds, v, knot.rate[v]);
+  }
+  return ToSample (knot, knot.rate);
+}
+
+} // namespace ns3
@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#ifndef FSO_LINK_TRAJECTORY_H
+#define FSO_LINK_TRAJECTORY_H
+
+#include <vector>
+#include "adi-type-define.h"
+
+namespace ns3 {
+
+/**
+ * \brief Adaptive-step representation of the link datas of one link window
+ *
+ * The per-second link datas are reduced to a sparse set of knots. Between
+ * two adjacent knots the distance and the four pointing angles are cubic
+ * Hermite polynomials of the knot values and slopes, so the geometry can be
+ * evaluated at arbitrary times. A knot is only kept where dropping it would
+ * make any of the dropped samples deviate more than the given tolerances.
+ */
+class FsoLinkTrajectory
+{
+public:
+  /**
+   * \brief Geometry of the link at one instant
+   */
+  struct Sample
+  {
+    double        distance;   //!< distance between two parties, in km
+    double        rate;       //!< rate of distance, in km/s
+    adi::Pointing fromSrc;    //!< pointing from source to destination
+    adi::Pointing fromDst;    //!< pointing from destination to source
+  };
+
+  /**
+   * \brief Default constructor, the trajectory is empty
+   */
+  FsoLinkTrajectory ();
+
+  /**
+   * \brief Build the trajectory from the link datas
+   * \param[in] data              the link datas, sorted by time
+   * \param[in] angleTolerance    the maximum pointing error, in radian
+   * \param[in] distanceTolerance the maximum distance error, in km
+   */
+  FsoLinkTrajectory (
+    const adi::LinkDatas& data,
+    double angleTolerance,
+    double distanceTolerance
+  );
+
+  /**
+   * \brief Check whether the trajectory is empty
+   * \return true if there is no knot
+   */
+  bool IsEmpty () const;
+
+  /**
+   * \brief Get the number of knots
+   * \return the number of knots
+   */
+  std::size_t GetNKnots () const;
+
+  /**
+   * \brief Get the time of a knot
+   * \param[in] i the index of knot
+   * \return the time of knot
+   */
+  adi::DateTime GetKnotTime (std::size_t i) const;
+
+  /**
+   * \brief Get the geometry at a knot
+   * \param[in] i the index of knot
+   * \return the geometry at knot
+   */
+  Sample GetKnot (std::size_t i) const;
+
+  /**
+   * \brief Get the time of the first knot
+   * \return the start time
+   */
+  adi::DateTime GetStart () const;
+
+  /**
+   * \brief Get the time of the last knot
+   * \return the stop time
+   */
+  adi::DateTime GetStop () const;
+
+  /**
+   * \brief Evaluate the geometry at given time
+   *
+   * At the knots the rates are the ones given by the link datas, elsewhere
+   * they are the derivatives of the polynomials.
+   *
+   * \param[in] t the time, clamped into [start, stop]
+   * \return the interpolated geometry
+   */
+  Sample Evaluate (const adi::DateTime& t) const;
+private:
+  /** The interpolated values: distance, azimuth and pitch of both sides */
+  static const std::size_t N_VALUES = 5;
+  struct Knot
+  {
+    int64_t ticks;              //!< ticks from the start
+    double t;                   //!< seconds from the start
+    double value[N_VALUES];     //!< values, azimuths are unwrapped
+    double rate[N_VALUES];      //!< slopes of values, per second
+    double given[N_VALUES];     //!< rates given by the link datas
+  };
+  typedef std::vector<Knot> Knots;
+
+  /**
+   * \brief Check whether the Hermite segment between two samples reproduces
+   *        all samples in between
+   * \param[in] samples the samples
+   * \param[in] i       the index of first sample
+   * \param[in] j       the index of last sample
+   * \return true if all errors are in tolerance
+   */
+  bool IsFitted (const Knots& samples, std::size_t i, std::size_t j) const;
+
+  /**
+   * \brief Calculate the derivative of one value from three adjacent samples
+   * \param[in] samples the samples
+   * \param[in] lo      the index of first sample
+   * \param[in] t       the seconds from the start
+   * \param[in] v       the index of value
+   * \return the derivative, per second
+   */
+  static double CalcDerivative (const Knots& samples, std::size_t lo, double t, std::size_t v);
+
+  /**
+   * \brief Interpolate one value between two knots
+   * \param[in] k0    the first knot
+   * \param[in] k1    the second knot
+   * \param[in] t     the seconds from the start
+   * \param[in] v     the index of value
+   * \param[out] rate the interpolated rate
+   * \return the interpolated value
+   */
+  static double Interpolate (const Knot& k0, const Knot& k1, double t, std::size_t v, double& rate);
+
+  /**
+   * \brief Convert the knot into sample
+   * \param[in] knot  the knot
+   * \param[in] rate  the rates of values
+   * \return the sample
+   */
+  static Sample ToSample (const Knot& knot, const double* rate);
+
+  adi::DateTime m_start;              //!< time of the first knot
+  double        m_angleTolerance;     //!< maximum pointing error, in radian
+  double        m_distanceTolerance;  //!< maximum distance error, in km
+  Knots         m_knots;              //!< the knots
+};
+
+} // namespace ns3
+
+#endif /* FSO_LINK_TRAJECTORY_H */
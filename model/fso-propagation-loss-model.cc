@@ -18,13 +18,19 @@
  * Author: Wang Junyong (wangjunyong@microsate.com)
  */
 
+#include <cmath>
+#include <vector>
 #include "ns3/log.h"
 #include "ns3/math.h"
 #include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/boolean.h"
+#include "ns3/rng-seed-manager.h"
 #include "ns3/mobility-model.h"
 #include "fso-propagation-loss-model.h"
 #include "fso-channel.h"
 #include "fso-device.h"
+#include "fso-atmosphere-model.h"
 #include "turntable.h"
 
 namespace ns3 {
@@ -40,12 +46,39 @@ FsoPropagationLossModel::GetTypeId ()
   .SetParent<PropagationLossModel> ()
   .SetGroupName ("Fso")
   .AddConstructor<FsoPropagationLossModel> ()
+  .AddAttribute ("Fading", "The fading of scintillation, the loss is deterministic without fading",
+                 EnumValue (FsoPropagationLossModel::NO_FADING),
+                 MakeEnumAccessor (&FsoPropagationLossModel::m_fading),
+                 MakeEnumChecker (FsoPropagationLossModel::NO_FADING, "None",
+                                  FsoPropagationLossModel::LOG_NORMAL, "LogNormal",
+                                  FsoPropagationLossModel::GAMMA_GAMMA, "GammaGamma"))
+  .AddAttribute ("FadingStep", "The time step of fading samples",
+                 TimeValue (MilliSeconds (10)),
+                 MakeTimeAccessor (&FsoPropagationLossModel::m_fadingStep),
+                 MakeTimeChecker (MicroSeconds (1)))
+  .AddAttribute ("PointingJitter", "Whether the pointing jitter of turntable is sampled with the fading, "
+                 "otherwise the mean misalignment loss is kept",
+                 BooleanValue (true),
+                 MakeBooleanAccessor (&FsoPropagationLossModel::m_pointingJitter),
+                 MakeBooleanChecker ())
   ;
   return tid;
 }
 
 FsoPropagationLossModel::FsoPropagationLossModel ()
 : PropagationLossModel ()
+, m_cachedTx (0)
+, m_cachedRx (0)
+, m_txVersion (0)
+, m_rxVersion (0)
+, m_pointingBias (0.0)
+, m_pointingStd (0.0)
+, m_coefficient (0.0)
+, m_misalignment (1.0)
+, m_fading (NO_FADING)
+, m_fadingStep (MilliSeconds (10))
+, m_pointingJitter (true)
+, m_stream (-1)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -53,6 +86,18 @@ FsoPropagationLossModel::FsoPropagationLossModel ()
 FsoPropagationLossModel::FsoPropagationLossModel (Ptr<FsoChannel> channel)
 : PropagationLossModel ()
 , m_channel (channel)
+, m_cachedTx (0)
+, m_cachedRx (0)
+, m_txVersion (0)
+, m_rxVersion (0)
+, m_pointingBias (0.0)
+, m_pointingStd (0.0)
+, m_coefficient (0.0)
+, m_misalignment (1.0)
+, m_fading (NO_FADING)
+, m_fadingStep (MilliSeconds (10))
+, m_pointingJitter (true)
+, m_stream (-1)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -68,6 +113,8 @@ FsoPropagationLossModel::SetChannel (Ptr<FsoChannel> channel)
   NS_LOG_FUNCTION (this << channel);
   NS_ASSERT (channel != 0);
   m_channel = channel;
+  m_cachedTx = 0;
+  m_cachedRx = 0;
 }
 
 void
@@ -81,12 +128,16 @@ void
 FsoPropagationLossModel::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
+  m_cachedTx = 0;
+  m_cachedRx = 0;
   PropagationLossModel::DoDispose ();
 }
 
 int64_t
 FsoPropagationLossModel::DoAssignStreams (int64_t streams)
 {
+  NS_LOG_FUNCTION (this << streams);
+  m_stream = streams;
   return 1;
 }
 
@@ -112,14 +163,11 @@ FsoPropagationLossModel::DoCalcGeometricalLoss (Ptr<FsoTxDevice> tx, Ptr<FsoRxDe
 double
 FsoPropagationLossModel::DoCalcMisalignmentLoss (Ptr<FsoTxDevice> tx, Ptr<FsoRxDevice> rx) const
 {
-  Ptr<Turntable> turntable;
-  turntable = tx->GetObject<Turntable> ();
+  Ptr<Turntable> turntable = tx->GetTurntable ();
   NS_ASSERT (turntable);
   double pointingBias = turntable->GetPointingBias ();
   double pointingStd = turntable->GetPointingStd ();
   double divergence = tx->GetBeamDivergence ();
-  turntable = rx->GetObject<Turntable> ();
-  NS_ASSERT (turntable);
   double pointingBias2 = pointingBias * pointingBias;
   double pointingStd2 = pointingStd * pointingStd;
   double divergence2 = divergence * divergence;
@@ -138,6 +186,22 @@ FsoPropagationLossModel::DoCalcTimeSyncLoss (Ptr<FsoTxDevice> tx, Ptr<FsoRxDevic
 double
 FsoPropagationLossModel::DoCalcAtmosphericLoss (Ptr<FsoTxDevice> tx, Ptr<FsoRxDevice> rx) const
 {
+  Ptr<FsoAtmosphereModel> atmosphere = rx->GetAtmosphere ();
+  if (atmosphere)
+  {
+    // downlink, the elevation is the pitch of receiver
+    double elevation = m_channel->GetRxTarget ().GetPitch ();
+    return atmosphere->GetTransmittance (tx->GetBeamWavelength (), elevation);
+  }
+  atmosphere = tx->GetAtmosphere ();
+  if (atmosphere)
+  {
+    // uplink, the beam wanders through the turbulence near transmitter
+    double wavelength = tx->GetBeamWavelength ();
+    double elevation = m_channel->GetTxTarget ().GetPitch ();
+    return atmosphere->GetTransmittance (wavelength, elevation)
+         * atmosphere->GetBeamWanderLoss (wavelength, elevation, tx->GetBeamDivergence ());
+  }
   return 1.0;
 }
 
@@ -157,15 +221,196 @@ FsoPropagationLossModel::DoCalcRxPower (double distance,
                                         Ptr<MobilityModel> a,
                                         Ptr<MobilityModel> b) const
 {
+  return CalcChannelLoss (distance);
+}
+
+double
+FsoPropagationLossModel::CalcChannelLoss (double distance) const
+{
+  double loss = GetLossCoefficient () / (distance * distance);
+  Ptr<FsoTxDevice> txDevice= m_channel->GetTxDevice ();
+  Ptr<FsoRxDevice> rxDevice= m_channel->GetRxDevice ();
+  if (txDevice->GetAtmosphere () || rxDevice->GetAtmosphere ())
+  {
+    loss *= DoCalcAtmosphericLoss (txDevice, rxDevice);
+  }
+  return loss;
+}
+
+double
+FsoPropagationLossModel::CalcChannelLoss (double distance, const Time& start, const Time& stop) const
+{
+  double loss = CalcChannelLoss (distance);
+  if (m_fading == NO_FADING)
+  {
+    return loss;
+  }
+  NS_ASSERT (stop >= start);
+  int64_t first = start.GetTimeStep () / m_fadingStep.GetTimeStep ();
+  int64_t last = stop.GetTimeStep () / m_fadingStep.GetTimeStep ();
+  double fading = DoCalcFading (first, last - first + 1);
+  if (m_pointingJitter)
+  {
+    // the mean misalignment is replaced by the sampled one
+    fading /= m_misalignment;
+  }
+  return loss * fading;
+}
+
+bool
+FsoPropagationLossModel::IsStochastic (void) const
+{
+  return m_fading != NO_FADING;
+}
+
+double
+FsoPropagationLossModel::DoCalcFading (int64_t first, std::size_t n) const
+{
+  NS_LOG_FUNCTION (this << first << n);
   Ptr<FsoTxDevice> txDevice= m_channel->GetTxDevice ();
   Ptr<FsoRxDevice> rxDevice= m_channel->GetRxDevice ();
-  double rxPowerDb =  1.0
-                    * DoCalcGeometricalLoss (txDevice, rxDevice, distance)
-                    * DoCalcMisalignmentLoss (txDevice, rxDevice)
-                    * DoCalcTimeSyncLoss (txDevice, rxDevice)
-                    * DoCalcAtmosphericLoss (txDevice, rxDevice)
-                    * DoCalcOpticalLoss (txDevice, rxDevice);
-  return rxPowerDb;
+  // the log-irradiance variances of the ground party at its current elevation
+  double large = 0.0;
+  double small = 0.0;
+  Ptr<FsoAtmosphereModel> atmosphere = rxDevice->GetAtmosphere ();
+  double elevation = m_channel->GetRxTarget ().GetPitch ();
+  if (!atmosphere)
+  {
+    atmosphere = txDevice->GetAtmosphere ();
+    elevation = m_channel->GetTxTarget ().GetPitch ();
+  }
+  if (atmosphere)
+  {
+    atmosphere->GetScintillationVariances (txDevice->GetBeamWavelength (), elevation, large, small);
+  }
+  double divergence2 = txDevice->GetBeamDivergence () * txDevice->GetBeamDivergence ();
+  // draw 0 gives three normals per step, the scintillation and the jitters of two axes
+  std::vector<double> u0 (n), u1 (n), u2 (n), u3 (n);
+  double* u[4] = {u0.data (), u1.data (), u2.data (), u3.data ()};
+  Philox4x32::Key key = DoGetKey ();
+  Philox4x32::Counter base = {0, 0, (uint32_t) RngSeedManager::GetRun (), 0};
+  Philox4x32::Uniform (key, base, first, n, u);
+  double sigma2 = large + small;
+  double sigma = std::sqrt (sigma2);
+  double jitter = m_pointingJitter ? m_pointingStd : 0.0;
+  double bias = m_pointingJitter ? m_pointingBias : 0.0;
+  // the pointing error is the bias plus the jitter, whose mean loss is
+  // the misalignment loss, and the scintillation is of unit mean
+  bool gammaGamma = m_fading == GAMMA_GAMMA && large > 0.0 && small > 0.0;
+  double alpha = gammaGamma ? 1.0 / std::expm1 (large) : 0.0;
+  double beta = gammaGamma ? 1.0 / std::expm1 (small) : 0.0;
+  double sum = 0.0;
+  for (std::size_t i = 0;i < n;++i)
+  {
+    double r0 = std::sqrt (-2.0 * std::log (u0[i]));
+    double r1 = std::sqrt (-2.0 * std::log (u2[i]));
+    double ex = bias + jitter * r1 * std::cos (2.0 * M_PI * u3[i]);
+    double ey = jitter * r1 * std::sin (2.0 * M_PI * u3[i]);
+    double h = std::exp (-2.0 * (ex * ex + ey * ey) / divergence2);
+    if (m_fading == LOG_NORMAL)
+    {
+      h *= std::exp (sigma * r0 * std::cos (2.0 * M_PI * u1[i]) - 0.5 * sigma2);
+    }
+    else if (gammaGamma)
+    {
+      // alpha and beta are the reciprocals of the large-scale and small-scale indices
+      h *= DoSampleGamma (alpha, first + i, 1) * DoSampleGamma (beta, first + i, 2);
+    }
+    sum += h;
+  }
+  return sum / n;
+}
+
+Philox4x32::Key
+FsoPropagationLossModel::DoGetKey (void) const
+{
+  if (m_stream < 0)
+  {
+    m_stream = RngSeedManager::GetNextStreamIndex ();
+  }
+  // the seed selects the key and the run selects the counters, as substreams of ns-3
+  Philox4x32::Key key = {(uint32_t) m_stream, (uint32_t) ((uint64_t) m_stream >> 32) ^ RngSeedManager::GetSeed ()};
+  return key;
+}
+
+double
+FsoPropagationLossModel::DoSampleGamma (double shape, int64_t step, uint32_t draw) const
+{
+  Philox4x32::Key key = DoGetKey ();
+  bool boost = shape < 1.0;
+  double d = (boost ? shape + 1.0 : shape) - 1.0 / 3.0;
+  double c = 1.0 / std::sqrt (9.0 * d);
+  for (uint32_t attempt = 0;attempt < 64;++attempt)
+  {
+    Philox4x32::Counter counter = {(uint32_t) step, (uint32_t) ((uint64_t) step >> 32),
+                                   (uint32_t) RngSeedManager::GetRun (), draw + 2 * attempt};
+    Philox4x32::Counter block = Philox4x32::Generate (counter, key);
+    double r = std::sqrt (-2.0 * std::log (Philox4x32::ToUniform (block[0])));
+    double x = r * std::cos (2.0 * M_PI * Philox4x32::ToUniform (block[1]));
+    double v = 1.0 + c * x;
+    if (v <= 0.0)
+    {
+      continue;
+    }
+    v = v * v * v;
+    double w = Philox4x32::ToUniform (block[2]);
+    if (std::log (w) < 0.5 * x * x + d - d * v + d * std::log (v))
+    {
+      double g = d * v;
+      if (boost)
+      {
+        g *= std::pow (Philox4x32::ToUniform (block[3]), 1.0 / shape);
+      }
+      // unit mean
+      return g / shape;
+    }
+  }
+  return 1.0;
+}
+
+double
+FsoPropagationLossModel::GetLossCoefficient (void) const
+{
+  Ptr<FsoTxDevice> txDevice= m_channel->GetTxDevice ();
+  Ptr<FsoRxDevice> rxDevice= m_channel->GetRxDevice ();
+  Ptr<Turntable> turntable = txDevice->GetTurntable ();
+  NS_ASSERT (turntable);
+  double pointingBias = turntable->GetPointingBias ();
+  double pointingStd = turntable->GetPointingStd ();
+  if (m_cachedTx != PeekPointer (txDevice)
+   || m_cachedRx != PeekPointer (rxDevice)
+   || m_txVersion != txDevice->GetParameterVersion ()
+   || m_rxVersion != rxDevice->GetParameterVersion ()
+   || m_pointingBias != pointingBias
+   || m_pointingStd != pointingStd)
+  {
+    // the approximate geometrical loss is inverse square in distance,
+    // so the other losses are folded with it at 1 km, except the
+    // atmospheric loss which depends on the elevation
+    m_misalignment = DoCalcMisalignmentLoss (txDevice, rxDevice);
+    m_coefficient = 1.0
+                  * DoCalcGeometricalLoss (txDevice, rxDevice, 1.0)
+                  * m_misalignment
+                  * DoCalcTimeSyncLoss (txDevice, rxDevice)
+                  * DoCalcOpticalLoss (txDevice, rxDevice);
+    m_cachedTx = PeekPointer (txDevice);
+    m_cachedRx = PeekPointer (rxDevice);
+    m_txVersion = txDevice->GetParameterVersion ();
+    m_rxVersion = rxDevice->GetParameterVersion ();
+    m_pointingBias = pointingBias;
+    m_pointingStd = pointingStd;
+    // build the atmospheric tables of the wavelength at setup
+    if (rxDevice->GetAtmosphere ())
+    {
+      rxDevice->GetAtmosphere ()->Prepare (txDevice->GetBeamWavelength ());
+    }
+    if (txDevice->GetAtmosphere ())
+    {
+      txDevice->GetAtmosphere ()->Prepare (txDevice->GetBeamWavelength ());
+    }
+    NS_LOG_LOGIC ("loss coefficient: " << m_coefficient);
+  }
+  return m_coefficient;
 }
 
 }
\ No newline at end of file
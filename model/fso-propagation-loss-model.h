@@ -22,6 +22,8 @@
 #define FSO_PROPAGATION_LOSS_MODEL_H
 
 #include "ns3/propagation-loss-model.h"
+#include "ns3/nstime.h"
+#include "philox.h"
 
 namespace ns3 {
 
@@ -32,11 +34,49 @@ class FsoRxDevice;
 class FsoPropagationLossModel : public PropagationLossModel
 {
 public:
+  /**
+   * \brief The fading of scintillation in the stochastic mode
+   */
+  enum Fading
+  {
+    NO_FADING,    //!< the deterministic loss, the mean of stochastic loss
+    LOG_NORMAL,   //!< log-normal scintillation, for weak turbulence
+    GAMMA_GAMMA   //!< gamma-gamma scintillation, from weak to strong turbulence
+  };
   static TypeId GetTypeId (void);
   FsoPropagationLossModel ();
   FsoPropagationLossModel (Ptr<FsoChannel> channel);
   virtual ~FsoPropagationLossModel ();
   void SetChannel (Ptr<FsoChannel> channel);
+  /**
+   * \brief Get the distance-independent part of the channel loss, i.e. the loss at 1 km,
+   * which is cached until the devices, their parameters or the pointing errors change
+   * \return the loss coefficient, the channel loss is it divided by the squared distance in km,
+   *         and multiplied by the atmospheric loss for the satellite-to-ground links
+   */
+  double GetLossCoefficient (void) const;
+  /**
+   * \brief Calculate the channel loss at the current pointings of the channel
+   * \param[in] distance the distance between two parties, in km
+   * \return the channel loss
+   */
+  double CalcChannelLoss (double distance) const;
+  /**
+   * \brief Calculate the channel loss averaged over the given period, the fading
+   * of scintillation and pointing jitter is sampled at every fading step in it.
+   * The samples are drawn from Philox4x32 by the step index, so they only depend
+   * on the stream, the seed and the run, not on the order of calls
+   * \param[in] distance the distance between two parties, in km
+   * \param[in] start    the start of period
+   * \param[in] stop     the stop of period
+   * \return the channel loss, the deterministic one if the fading is disabled
+   */
+  double CalcChannelLoss (double distance, const Time& start, const Time& stop) const;
+  /**
+   * \brief Check whether the fading is sampled
+   * \return true if the fading is enabled
+   */
+  bool IsStochastic (void) const;
 protected:
   virtual void DoInitialize ();
   virtual void DoDispose ();
@@ -71,7 +111,8 @@ private:
   double DoCalcTimeSyncLoss (Ptr<FsoTxDevice> tx, Ptr<FsoRxDevice> rx) const;
 
   /**
-   * \brief Calculate the Atmospheric loss
+   * \brief Calculate the Atmospheric loss by the atmospheric profile of the ground party,
+   * at the elevation of its current target pointing, 1.0 if both parties are in space
    * \param [in] tx transmitter device
    * \param [in] rx receiver device
    * \param [out] the Atmospheric loss
@@ -94,7 +135,39 @@ private:
    * \param [in] b        mobility model of receiver, not used
    */
   virtual double DoCalcRxPower (double distance, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  /**
+   * \brief Calculate the mean fading factor over the given steps, which is unit on average
+   * \param[in] first the index of first step
+   * \param[in] n     the number of steps
+   * \return the mean fading factor
+   */
+  double DoCalcFading (int64_t first, std::size_t n) const;
+  /**
+   * \brief Sample a gamma variate of unit mean by Marsaglia-Tsang method
+   * \param[in] shape the shape parameter
+   * \param[in] step  the index of step
+   * \param[in] draw  the index of the first draw of this variate, the attempts take every other draw
+   * \return the gamma variate
+   */
+  double DoSampleGamma (double shape, int64_t step, uint32_t draw) const;
+  /**
+   * \brief Get the Philox key of the stream, assign a stream if not yet
+   * \return the key
+   */
+  Philox4x32::Key DoGetKey (void) const;
   Ptr<FsoChannel> m_channel;
+  mutable const FsoTxDevice* m_cachedTx;  //!< the tx device of cached coefficient
+  mutable const FsoRxDevice* m_cachedRx;  //!< the rx device of cached coefficient
+  mutable uint32_t  m_txVersion;          //!< the parameter version of cached tx device
+  mutable uint32_t  m_rxVersion;          //!< the parameter version of cached rx device
+  mutable double    m_pointingBias;       //!< the pointing bias of cached coefficient
+  mutable double    m_pointingStd;        //!< the pointing standard deviation of cached coefficient
+  mutable double    m_coefficient;        //!< the cached loss coefficient
+  mutable double    m_misalignment;       //!< the mean misalignment loss of cached coefficient
+  Fading            m_fading;             //!< the fading of scintillation
+  Time              m_fadingStep;         //!< the time step of fading samples
+  bool              m_pointingJitter;     //!< whether the pointing jitter is sampled
+  mutable int64_t   m_stream;             //!< the stream of fading samples, negative if not assigned
 };
 
 }
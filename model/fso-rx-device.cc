@@ -140,6 +140,7 @@ void
 FsoRxDevice::SetDetectorEfficiency (double effcy)
 {
   m_rxDetectorEfficiency = effcy;
+  NotifyParameterChanged ();
 }
 
 double
@@ -176,6 +177,7 @@ void
 FsoRxDevice::SetTelescopeDiameter (double dia)
 {
   m_rxTelescopeDiameter = dia;
+  NotifyParameterChanged ();
 }
 
 double
@@ -188,6 +190,7 @@ void
 FsoRxDevice::SetTelescopeEfficiency (double effcy)
 {
   m_rxTelescopeEfficiency = effcy;
+  NotifyParameterChanged ();
 }
 
 double
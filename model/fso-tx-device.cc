@@ -99,6 +99,7 @@ FsoTxDevice::SetBeamWavelength (double wavelength)
   m_txBeamWavelength = wavelength;
   DoCalcBeamMinDivergence ();
   DoCalcLensEfficiency ();
+  NotifyParameterChanged ();
 }
 
 double
@@ -113,6 +114,7 @@ FsoTxDevice::SetBeamWaist (double waist)
   m_txBeamWaist = waist;
   DoCalcBeamMinDivergence ();
   DoCalcLensEfficiency ();
+  NotifyParameterChanged ();
 }
 
 double
@@ -133,6 +135,7 @@ FsoTxDevice::SetBeamDivergence (double div)
   m_txBeamDivergence = div;
   DoCalcBeamMinDivergence ();
   DoCalcLensEfficiency ();
+  NotifyParameterChanged ();
 }
 
 double
@@ -147,6 +150,7 @@ FsoTxDevice::SetLensDiameter (double dia)
   m_txLensDiameter = dia;
   DoCalcBeamMinDivergence ();
   DoCalcLensEfficiency ();
+  NotifyParameterChanged ();
 }
 
 double
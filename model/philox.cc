@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include "philox.h"
+
+namespace ns3 {
+
+namespace {
+
+const uint32_t PHILOX_M0 = 0xD2511F53;
+const uint32_t PHILOX_M1 = 0xCD9E8D57;
+const uint32_t PHILOX_W0 = 0x9E3779B9;
+const uint32_t PHILOX_W1 = 0xBB67AE85;
+
+inline void
+Round (uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3, uint32_t k0, uint32_t k1)
+{
+  uint64_t p0 = (uint64_t) PHILOX_M0 * c0;
+  uint64_t p1 = (uint64_t) PHILOX_M1 * c2;
+  uint32_t t0 = (uint32_t) (p1 >> 32) ^ c1 ^ k0;
+  uint32_t t1 = (uint32_t) p1;
+  uint32_t t2 = (uint32_t) (p0 >> 32) ^ c3 ^ k1;
+  uint32_t t3 = (uint32_t) p0;
+  c0 = t0;
+  c1 = t1;
+  c2 = t2;
+  c3 = t3;
+}
+
+inline void
+Philox (uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3, uint32_t k0, uint32_t k1)
+{
+  for (int r = 0;r < 10;++r)
+  {
+    Round (c0, c1, c2, c3, k0, k1);
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+}
+
+} // namespace
+
+Philox4x32::Counter
+Philox4x32::Generate (Counter counter, Key key)
+{
+  Philox (counter[0], counter[1], counter[2], counter[3], key[0], key[1]);
+  return counter;
+}
+
+void
+Philox4x32::Uniform (Key key, Counter base, uint64_t first, std::size_t n, double* u[4])
+{
+  double* u0 = u[0];
+  double* u1 = u[1];
+  double* u2 = u[2];
+  double* u3 = u[3];
+  for (std::size_t i = 0;i < n;++i)
+  {
+    uint64_t index = first + i;
+    uint32_t c0 = (uint32_t) index;
+    uint32_t c1 = (uint32_t) (index >> 32);
+    uint32_t c2 = base[2];
+    uint32_t c3 = base[3];
+    Philox (c0, c1, c2, c3, key[0], key[1]);
+    u0[i] = ToUniform (c0);
+    u1[i] = ToUniform (c1);
+    u2[i] = ToUniform (c2);
+    u3[i] = ToUniform (c3);
+  }
+}
+
+double
+Philox4x32::ToUniform (uint32_t x)
+{
+  return (x + 0.5) * (1.0 / 4294967296.0);
+}
+
+} // namespace ns3
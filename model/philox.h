@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace ns3 {
+
+/**
+ * \brief Counter-based random number generator Philox4x32-10 (Salmon et al., 2011)
+ *
+ * Each block of four 32-bit random numbers is a bijection of a 128-bit counter
+ * under a 64-bit key, so there is no state to carry: the same counter and key
+ * always give the same numbers, whatever the order of draws. The blocks are
+ * independent of each other, and the batched fill is a flat loop of integer
+ * multiplications which the compiler can vectorize.
+ */
+class Philox4x32
+{
+public:
+  typedef std::array<uint32_t, 4> Counter;  //!< the counter, also the block of random numbers
+  typedef std::array<uint32_t, 2> Key;      //!< the key
+
+  /**
+   * \brief Generate the block of given counter
+   * \param[in] counter the counter
+   * \param[in] key     the key
+   * \return four uniformly distributed 32-bit numbers
+   */
+  static Counter Generate (Counter counter, Key key);
+
+  /**
+   * \brief Generate the uniform numbers in (0, 1) of consecutive counters, the lower
+   * 64 bits of the i-th counter are first + i and the upper ones are those of base
+   * \param[in]  key    the key
+   * \param[in]  base   the counter providing the upper 64 bits
+   * \param[in]  first  the lower 64 bits of the first counter
+   * \param[in]  n      the number of blocks
+   * \param[out] u      the four arrays of n uniform numbers, one per word of blocks
+   */
+  static void Uniform (Key key, Counter base, uint64_t first, std::size_t n, double* u[4]);
+
+  /**
+   * \brief Convert a 32-bit number to a uniform number in (0, 1)
+   * \param[in] x the 32-bit number
+   * \return the uniform number, never 0 or 1
+   */
+  static double ToUniform (uint32_t x);
+};
+
+} // namespace ns3
+
+#endif /* PHILOX_H */
@@ -215,11 +215,18 @@ Q3pRxCache::DoHandleTimeSynchronization (Ptr<Packet> packet)
   //
   NS_ASSERT (packet->GetSize () == pulses * 8);
 
+  // the dark count rate is only drawn in the stochastic mode of channel
+  Ptr<FsoChannel> channel = GetFsoDevice ()->GetChannel ();
+  double darkCount = 300.0;
+  if (channel->IsStochastic ())
+  {
+    darkCount = GetFsoDevice ()->GetObject<FsoRxDevice> ()->GetDarkCountRate ();
+  }
   NotifyNewDetectionEvent (
     start,
     stop,
-    300.0,//GetFsoDevice ()->GetObject<FsoRxDevice> ()->GetDarkCountRate (),
-    GetFsoDevice ()->GetChannel ()->CalcChannelLoss ());
+    darkCount,
+    channel->CalcChannelLoss (start, stop));
   if (m_detectionEvents[Processing] > 250)
   {
     m_eventSig[Negotiating] = m_eventSig[Processing];
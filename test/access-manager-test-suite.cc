@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "ns3/test.h"
+#include "ns3/util.h"
+#include "ns3/bang-bang-controller.h"
+#include "ns3/access-manager.h"
+#include "adi-constant.h"
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \brief Check whether the pointing of a turntable is visible and its rates are in limiter
+ */
+bool
+IsInLimiter (const adi::Pointing& p, uint8_t state, uint8_t mask, const Box& azBound, const Box& ptBound)
+{
+  double tmp1 = (p.rate.azimuth - azBound.yMax) * (p.rate.azimuth - azBound.yMin);
+  double tmp2 = (p.rate.pitch - ptBound.yMax) * (p.rate.pitch - ptBound.yMin);
+  return tmp1 <= 0 && tmp2 <= 0 && (state & mask);
+}
+
+/**
+ * \brief The access period and value found by the forward scan, the reverse scan
+ * and the value loop, which AccessManager::CalcAccessData replaces with one pass
+ */
+bool
+CalcAccessDataByThreeLoops (
+  const adi::LinkDatas& linkDatas,
+  const Box& srcAz, const Box& srcPt,
+  const Box& dstAz, const Box& dstPt,
+  uint32_t& start, uint32_t& stop, double& value)
+{
+  uint32_t n = linkDatas.size ();
+  // the first time that the pointings of source and destination are all in limiter
+  bool findStart = false;
+  start = 0;
+  for (uint32_t k = 0;k < n;++k)
+  {
+    const adi::LinkData& d = linkDatas[k];
+    if (IsInLimiter (d.fromSrc, d.state, SRC2DST, srcAz, srcPt)
+      && IsInLimiter (d.fromDst, d.state, DST2SRC, dstAz, dstPt)
+      && d.distance <= adi::K_MAX_DISTANCE)
+    {
+      findStart = true;
+      start = k > 0 ? k - 1 : 0;
+      break;
+    }
+  }
+  // the last time except the final one
+  bool findStop = false;
+  stop = n - 1;
+  for (uint32_t k = n - 1;k > 0;--k)
+  {
+    const adi::LinkData& d = linkDatas[k - 1];
+    if (IsInLimiter (d.fromSrc, d.state, SRC2DST, srcAz, srcPt)
+      && IsInLimiter (d.fromDst, d.state, DST2SRC, dstAz, dstPt)
+      && d.distance <= adi::K_MAX_DISTANCE)
+    {
+      findStop = true;
+      stop = k;
+      break;
+    }
+  }
+  if (linkDatas[stop].time <= linkDatas[start].time || (linkDatas[stop].time - linkDatas[start].time) < adi::TimeSpan (0, 1, 0))
+  {
+    return false;
+  }
+  if (!findStart || !findStop)
+  {
+    return false;
+  }
+  if (n - stop < 10)
+  {
+    stop = n - 10;
+  }
+  value = 0.0;
+  // assume the turntables always track the targets at first time
+  bool srcTracking = true;
+  bool dstTracking = true;
+  BangBangController::State srcAzInitState, srcPtInitState, dstAzInitState, dstPtInitState;
+  Time srcLostTime, dstLostTime;
+  for (uint32_t k = start;k <= stop;++k)
+  {
+    const adi::LinkData& d = linkDatas[k];
+    const adi::LinkData& former = linkDatas[k > 0 ? k - 1 : 0];
+    Time now = ToTime (d.time);
+    bool srcInLimiter = IsInLimiter (d.fromSrc, d.state, SRC2DST, srcAz, srcPt);
+    bool dstInLimiter = IsInLimiter (d.fromDst, d.state, DST2SRC, dstAz, dstPt);
+    if (srcInLimiter && dstInLimiter)
+    {
+      if (!srcTracking)
+      {
+        Time t1 = BangBangController::SwingTime (srcAzInitState, BangBangController::State (now, d.fromSrc.angle.azimuth, d.fromSrc.rate.azimuth), srcAz);
+        Time t2 = BangBangController::SwingTime (srcPtInitState, BangBangController::State (now, d.fromSrc.angle.pitch, d.fromSrc.rate.pitch), srcPt);
+        srcTracking = now - srcLostTime >= std::max (t1, t2);
+      }
+      if (!dstTracking)
+      {
+        Time t1 = BangBangController::SwingTime (dstAzInitState, BangBangController::State (now, d.fromDst.angle.azimuth, d.fromDst.rate.azimuth), dstAz);
+        Time t2 = BangBangController::SwingTime (dstPtInitState, BangBangController::State (now, d.fromDst.angle.pitch, d.fromDst.rate.pitch), dstPt);
+        dstTracking = now - dstLostTime >= std::max (t1, t2);
+      }
+      if (srcTracking && dstTracking && (d.state & BEYOND_DISTANCE) == 0)
+      {
+        value += 1.0 / (d.distance * d.distance);
+      }
+    }
+    else
+    {
+      if (!srcInLimiter && srcTracking)
+      {
+        srcTracking = false;
+        srcLostTime = now;
+        srcAzInitState = BangBangController::State (ToTime (former.time), former.fromSrc.angle.azimuth, former.fromSrc.rate.azimuth);
+        srcPtInitState = BangBangController::State (ToTime (former.time), former.fromSrc.angle.pitch, former.fromSrc.rate.pitch);
+      }
+      if (!dstInLimiter && dstTracking)
+      {
+        dstTracking = false;
+        dstLostTime = now;
+        dstAzInitState = BangBangController::State (ToTime (former.time), former.fromDst.angle.azimuth, former.fromDst.rate.azimuth);
+        dstPtInitState = BangBangController::State (ToTime (former.time), former.fromDst.angle.pitch, former.fromDst.rate.pitch);
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+/**
+ * \brief Check that the single pass of AccessManager::CalcAccessData finds the same
+ * access periods and values as the three loops it replaces on random link datas
+ */
+class AccessManagerSinglePassTestCase : public TestCase
+{
+public:
+  AccessManagerSinglePassTestCase ();
+  virtual ~AccessManagerSinglePassTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+AccessManagerSinglePassTestCase::AccessManagerSinglePassTestCase ()
+  : TestCase ("AccessManager::CalcAccessData matches the three loops")
+{
+}
+
+AccessManagerSinglePassTestCase::~AccessManagerSinglePassTestCase ()
+{
+}
+
+void
+AccessManagerSinglePassTestCase::DoRun (void)
+{
+  const Box srcAz (-M_PI, M_PI, -0.02, 0.02, -0.01, 0.01);
+  const Box srcPt (-M_PI / 2, M_PI / 2, -0.02, 0.02, -0.01, 0.01);
+  const Box dstAz (-M_PI, M_PI, -0.05, 0.05, -0.02, 0.02);
+  const Box dstPt (0.0, M_PI / 2, -0.05, 0.05, -0.02, 0.02);
+  std::mt19937 rng (1);
+  std::uniform_real_distribution<double> uniform (-1.0, 1.0);
+  std::bernoulli_distribution hidden (0.03);
+  std::bernoulli_distribution beyond (0.05);
+  std::uniform_int_distribution<uint32_t> lengthDist (30, 400);
+  const adi::DateTime epoch (2021, 3, 1, 0, 0, 0);
+  uint32_t nAccesses = 0;
+  for (uint32_t trial = 0;trial < 2000;++trial)
+  {
+    // random walks of the pointings whose rates wander around the limiters
+    adi::LinkInfo info;
+    uint32_t n = lengthDist (rng);
+    double distance = 1000.0 + 500.0 * uniform (rng);
+    adi::Pointing src {{M_PI * uniform (rng), 0.5}, {0.0, 0.0}};
+    adi::Pointing dst {{M_PI * uniform (rng), 0.5}, {0.0, 0.0}};
+    for (uint32_t k = 0;k < n;++k)
+    {
+      src.rate.azimuth += 0.005 * uniform (rng);
+      src.rate.pitch += 0.005 * uniform (rng);
+      dst.rate.azimuth += 0.01 * uniform (rng);
+      dst.rate.pitch += 0.01 * uniform (rng);
+      src.rate.azimuth = std::max (-0.03, std::min (0.03, src.rate.azimuth));
+      src.rate.pitch = std::max (-0.03, std::min (0.03, src.rate.pitch));
+      dst.rate.azimuth = std::max (-0.07, std::min (0.07, dst.rate.azimuth));
+      dst.rate.pitch = std::max (-0.07, std::min (0.07, dst.rate.pitch));
+      src.angle.azimuth += src.rate.azimuth;
+      src.angle.pitch += src.rate.pitch;
+      dst.angle.azimuth += dst.rate.azimuth;
+      dst.angle.pitch += dst.rate.pitch;
+      distance += 10.0 * uniform (rng);
+      uint8_t state = SRC2DST | DST2SRC;
+      if (hidden (rng))
+      {
+        state &= ~SRC2DST;
+      }
+      if (hidden (rng))
+      {
+        state &= ~DST2SRC;
+      }
+      if (beyond (rng))
+      {
+        state |= BEYOND_DISTANCE;
+      }
+      info.linkDatas.push_back (adi::LinkData {state, epoch + adi::TimeSpan (0, 0, k), src, dst, distance});
+    }
+    uint32_t start = 0;
+    uint32_t stop = 0;
+    double value = 0.0;
+    bool expected = CalcAccessDataByThreeLoops (info.linkDatas, srcAz, srcPt, dstAz, dstPt, start, stop, value);
+    AccessManager::AccessData access;
+    bool found = AccessManager::CalcAccessData (
+      info, BangBangLimiter (srcAz), BangBangLimiter (srcPt), BangBangLimiter (dstAz), BangBangLimiter (dstPt), access);
+    NS_TEST_ASSERT_MSG_EQ (found, expected, "trial " << trial);
+    if (!found)
+    {
+      continue;
+    }
+    ++nAccesses;
+    NS_TEST_ASSERT_MSG_EQ (access.fsoStart, start, "trial " << trial);
+    NS_TEST_ASSERT_MSG_EQ (access.fsoStop, stop, "trial " << trial);
+    NS_TEST_ASSERT_MSG_EQ (access.netStart, start, "trial " << trial);
+    NS_TEST_ASSERT_MSG_EQ (access.netStop, stop, "trial " << trial);
+    NS_TEST_ASSERT_MSG_EQ_TOL (access.value, value, 1e-12 * value, "trial " << trial);
+  }
+  // most of the random link datas hold an access
+  NS_TEST_ASSERT_MSG_GT (nAccesses, 1000, "too few accesses are compared");
+}
+
+/**
+ * \brief The test suite of the access manager
+ */
+class AccessManagerTestSuite : public TestSuite
+{
+public:
+  AccessManagerTestSuite ();
+};
+
+AccessManagerTestSuite::AccessManagerTestSuite ()
+  : TestSuite ("access-manager", UNIT)
+{
+  AddTestCase (new AccessManagerSinglePassTestCase, TestCase::QUICK);
+}
+
+static AccessManagerTestSuite g_accessManagerTestSuite;
@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <algorithm>
+#include <random>
+#include "ns3/test.h"
+#include "ns3/access-scheduler.h"
+
+using namespace ns3;
+
+/**
+ * \brief Check that the chain found by IntervalAccessScheduler::CalcChain has the
+ * same value as the best chain found by enumerating every subset of accesses
+ */
+class IntervalAccessSchedulerBruteForceTestCase : public TestCase
+{
+public:
+  IntervalAccessSchedulerBruteForceTestCase ();
+  virtual ~IntervalAccessSchedulerBruteForceTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+IntervalAccessSchedulerBruteForceTestCase::IntervalAccessSchedulerBruteForceTestCase ()
+  : TestCase ("IntervalAccessScheduler::CalcChain matches the brute force")
+{
+}
+
+IntervalAccessSchedulerBruteForceTestCase::~IntervalAccessSchedulerBruteForceTestCase ()
+{
+}
+
+void
+IntervalAccessSchedulerBruteForceTestCase::DoRun (void)
+{
+  std::mt19937 rng (1);
+  std::uniform_int_distribution<int64_t> startDist (0, 3600);
+  std::uniform_int_distribution<int64_t> durationDist (60, 600);
+  std::uniform_real_distribution<double> valueDist (0.0, 1.0);
+  std::bernoulli_distribution reachableDist (0.7);
+  std::bernoulli_distribution chainableDist (0.6);
+  const adi::DateTime epoch (2021, 3, 1, 0, 0, 0);
+  for (uint32_t trial = 0;trial < 500;++trial)
+  {
+    uint32_t n = 1 + trial % 12;
+    // the accesses sorted by stop
+    std::vector<std::pair<int64_t, int64_t>> periods (n);
+    for (uint32_t i = 0;i < n;++i)
+    {
+      int64_t start = startDist (rng);
+      periods[i] = std::make_pair (start + durationDist (rng), start);
+    }
+    std::sort (periods.begin (), periods.end ());
+    std::vector<adi::DateTime> starts, stops;
+    std::vector<double> values;
+    std::vector<bool> reachable;
+    std::vector<std::vector<bool>> chainable (n, std::vector<bool> (n));
+    for (uint32_t i = 0;i < n;++i)
+    {
+      starts.push_back (epoch + adi::TimeSpan (0, 0, (int) periods[i].second));
+      stops.push_back (epoch + adi::TimeSpan (0, 0, (int) periods[i].first));
+      values.push_back (valueDist (rng));
+      reachable.push_back (reachableDist (rng));
+      for (uint32_t j = 0;j < n;++j)
+      {
+        chainable[i][j] = chainableDist (rng);
+      }
+    }
+    // the best chain of all subsets, in the order of stop
+    double best = 0.0;
+    for (uint32_t mask = 1;mask < (1u << n);++mask)
+    {
+      double value = 0.0;
+      uint32_t former = n;
+      bool isValid = true;
+      for (uint32_t j = 0;j < n && isValid;++j)
+      {
+        if (!(mask & (1u << j)))
+        {
+          continue;
+        }
+        if (former == n)
+        {
+          isValid = reachable[j];
+        }
+        else
+        {
+          isValid = stops[former] <= starts[j] && chainable[former][j];
+        }
+        value += values[j];
+        former = j;
+      }
+      if (isValid)
+      {
+        best = std::max (best, value);
+      }
+    }
+    std::vector<uint32_t> chain = IntervalAccessScheduler::CalcChain (starts, stops, values,
+      [&reachable] (uint32_t j) { return reachable[j]; },
+      [&chainable] (uint32_t i, uint32_t j) { return chainable[i][j]; },
+      n);
+    // the chain is feasible and its value is the best
+    double value = 0.0;
+    for (uint32_t k = 0;k < chain.size ();++k)
+    {
+      uint32_t j = chain[k];
+      if (k + 1 < chain.size ())
+      {
+        uint32_t i = chain[k + 1];
+        NS_TEST_ASSERT_MSG_EQ ((stops[i] <= starts[j] && chainable[i][j]), true, "trial " << trial << " chains an infeasible pair");
+      }
+      else
+      {
+        NS_TEST_ASSERT_MSG_EQ (reachable[j], true, "trial " << trial << " starts with an unreachable access");
+      }
+      value += values[j];
+    }
+    NS_TEST_ASSERT_MSG_EQ_TOL (value, best, 1e-9, "trial " << trial << " with " << n << " accesses");
+  }
+}
+
+/**
+ * \brief The test suite of the access schedulers
+ */
+class AccessSchedulerTestSuite : public TestSuite
+{
+public:
+  AccessSchedulerTestSuite ();
+};
+
+AccessSchedulerTestSuite::AccessSchedulerTestSuite ()
+  : TestSuite ("access-scheduler", UNIT)
+{
+  AddTestCase (new IntervalAccessSchedulerBruteForceTestCase, TestCase::QUICK);
+}
+
+static AccessSchedulerTestSuite g_accessSchedulerTestSuite;
@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <algorithm>
+#include <tuple>
+#include "ns3/test.h"
+#include "adi-link-helper.h"
+#include "adi-satellite.h"
+#include "adi-station.h"
+#include "adi-turntable.h"
+#include "adi-constant.h"
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \brief Order the windows by their ends and start time
+ */
+bool
+IsWindowLess (const adi::LinkInfo& a, const adi::LinkInfo& b)
+{
+  return std::make_tuple (a.src, a.dst, a.linkDatas.front ().time)
+       < std::make_tuple (b.src, b.dst, b.linkDatas.front ().time);
+}
+
+} // namespace
+
+/**
+ * \brief Check that LinkHelper::CalcLink, which prunes the far pairs on a coarse
+ * grid per epoch and calculates the rest with the step of links, finds the same
+ * link datas as the full scan of every link at its step
+ */
+class AdiLinkHelperFullScanTestCase : public TestCase
+{
+public:
+  AdiLinkHelperFullScanTestCase ();
+  virtual ~AdiLinkHelperFullScanTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+AdiLinkHelperFullScanTestCase::AdiLinkHelperFullScanTestCase ()
+  : TestCase ("LinkHelper::CalcLink matches the full scan at the step of links")
+{
+}
+
+AdiLinkHelperFullScanTestCase::~AdiLinkHelperFullScanTestCase ()
+{
+}
+
+void
+AdiLinkHelperFullScanTestCase::DoRun (void)
+{
+  // the objects are registered in the global lists of adi, so they are never deleted
+  const adi::PointingBound bound {adi::Bound {-M_PI, M_PI}, adi::Bound {-M_PI / 2, M_PI / 2}};
+  std::vector<adi::Turntable*> sats;
+  std::vector<adi::Turntable*> stas;
+  for (uint32_t i = 0;i < 24;++i)
+  {
+    adi::Satellite* sat = new adi::Satellite ();
+    sat->SetElement (6871.0, 0.001, 97.4, (i / 6) * 45.0, 0.0, (i % 6) * 60.0 + i * 3.0);
+    sats.push_back (sat->Install (adi::Bottom, bound));
+  }
+  for (uint32_t j = 0;j < 8;++j)
+  {
+    adi::Station* sta = new adi::Station ();
+    sta->SetElement (10.0 + 6.0 * j, 20.0 * j, 0.1);
+    stas.push_back (sta->Install (adi::Top, bound));
+  }
+  adi::Links links;
+  adi::LinkHelper helper;
+  // satellite-to-ground links limited by the field of view, pointing bounds, sun and distance,
+  // every fourth one with a step off the minute grid
+  for (adi::Turntable* sat : sats)
+  {
+    for (adi::Turntable* sta : stas)
+    {
+      links.push_back (adi::Link (sat, sta, IN_FOV | SRC2DST | DST2SRC, DST_DAY | BEYOND_DISTANCE));
+      if (links.size () % 4 == 0)
+      {
+        links.back ().SetStep (adi::TimeSpan (0, 0, 7));
+      }
+    }
+  }
+  // it holds a window of 24 seconds between two samples a minute apart at 02:28:01,
+  // which is lost by any screening of the angular states at the coarse step
+  adi::DateTime start (2021, 3, 1, 1, 30, 0);
+  adi::Interval interval (start, start + adi::TimeSpan (0, 2, 0, 0));
+  // inter-satellite links of the neighbour planes limited by the distance,
+  // with another epoch and step than the satellite-to-ground links
+  for (uint32_t i = 0;i < 18;++i)
+  {
+    adi::Link link (sats[i], sats[i + 6], SRC2DST | DST2SRC, BEYOND_DISTANCE);
+    link.SetMaxDistance (4000.0);
+    link.SetEpoch (start);
+    link.SetStep (adi::TimeSpan (0, 0, 5));
+    links.push_back (link);
+  }
+  for (const adi::Link& link : links)
+  {
+    helper.AddLink (link);
+  }
+  helper.SetInterval (interval);
+  adi::LinkInfoList fast = helper.CalcLink ();
+  adi::LinkInfoList full;
+  for (adi::Link link : links)
+  {
+    link.SetIntervalList (adi::Intervals {interval});
+    adi::LinkInfoList infos = link.CalcLinkData ();
+    full.insert (full.end (), infos.begin (), infos.end ());
+  }
+  NS_TEST_ASSERT_MSG_GT (full.size (), 0u, "The scenario has no window");
+  std::sort (fast.begin (), fast.end (), IsWindowLess);
+  std::sort (full.begin (), full.end (), IsWindowLess);
+  NS_TEST_ASSERT_MSG_EQ (fast.size (), full.size (), "The number of windows differs from the full scan");
+  for (uint32_t i = 0;i < full.size ();++i)
+  {
+    const adi::LinkDatas& a = fast[i].linkDatas;
+    const adi::LinkDatas& b = full[i].linkDatas;
+    NS_TEST_ASSERT_MSG_EQ ((fast[i].src == full[i].src && fast[i].dst == full[i].dst), true, "Window " << i << " of another link");
+    NS_TEST_ASSERT_MSG_EQ (a.size (), b.size (), "Window " << i << " starting at " << b.front ().time << " is cut");
+    for (uint32_t k = 0;k < b.size ();++k)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((a[k].time == b[k].time), true, "Sample " << k << " of window " << i);
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t) a[k].state, (uint32_t) b[k].state, "Sample " << k << " of window " << i);
+      NS_TEST_ASSERT_MSG_EQ_TOL (a[k].distance, b[k].distance, 1e-6, "Sample " << k << " of window " << i);
+    }
+  }
+}
+
+/**
+ * \brief The test suite of the link calculation of adi
+ */
+class AdiLinkHelperTestSuite : public TestSuite
+{
+public:
+  AdiLinkHelperTestSuite ();
+};
+
+AdiLinkHelperTestSuite::AdiLinkHelperTestSuite ()
+  : TestSuite ("adi-link-helper", UNIT)
+{
+  AddTestCase (new AdiLinkHelperFullScanTestCase, TestCase::QUICK);
+}
+
+static AdiLinkHelperTestSuite g_adiLinkHelperTestSuite;
@@ -0,0 +1,231 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/bang-bang-controller.h"
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \brief The bang-bang cases of BangBangController::SwingTime
+ */
+enum SwingCase
+{
+  UP_KEEPING,     //!< speed up, keep the maximum rate, then speed down
+  UP,             //!< speed up then down
+  DOWN_KEEPING,   //!< speed down, keep the minimum rate, then speed up
+  DOWN,           //!< speed down then up
+  FLAT,           //!< only speed up or down
+  N_CASES
+};
+
+/**
+ * \brief Find the case of a swing in the same order of the scalar SwingTime
+ */
+SwingCase
+GetSwingCase (double x0, double v0, double xf, double vf, double vm, double am)
+{
+  double c0 = vf - v0;
+  double c1 = xf - vf * vf / (2 * am) - (x0 - v0 * v0 / (2 * am));
+  double c2 = xf + vf * vf / (2 * am) - (x0 + v0 * v0 / (2 * am));
+  if ((c0 >= 0 && c1 > 0) || (c0 < 0 && c2 > 0))
+  {
+    return sqrt (0.5 * (vf * vf + v0 * v0) + am * (xf - x0)) > vm ? UP_KEEPING : UP;
+  }
+  if ((c0 >= 0 && c1 < 0) || (c0 < 0 && c2 < 0))
+  {
+    return -sqrt (0.5 * (vf * vf + v0 * v0) + am * (x0 - xf)) < -vm ? DOWN_KEEPING : DOWN;
+  }
+  return FLAT;
+}
+
+/**
+ * \brief The cases in structure of arrays
+ */
+struct SwingCases
+{
+  std::vector<double> x0;
+  std::vector<double> v0;
+  std::vector<double> xf;
+  std::vector<double> vf;
+  std::vector<double> vm;
+  std::vector<double> am;
+  void Add (double _x0, double _v0, double _xf, double _vf, double _vm, double _am)
+  {
+    x0.push_back (_x0);
+    v0.push_back (_v0);
+    xf.push_back (_xf);
+    vf.push_back (_vf);
+    vm.push_back (_vm);
+    am.push_back (_am);
+  }
+  std::size_t GetN () const
+  {
+    return x0.size ();
+  }
+};
+
+/**
+ * \brief Calculate the swing time by the scalar reference
+ */
+double
+CalcScalarSwingTime (const SwingCases& cases, std::size_t k)
+{
+  Box limiter (0.0, 0.0, -cases.vm[k], cases.vm[k], -cases.am[k], cases.am[k]);
+  BangBangController::State initState (Seconds (0.0), cases.x0[k], cases.v0[k]);
+  BangBangController::State lastState (Seconds (0.0), cases.xf[k], cases.vf[k]);
+  return BangBangController::SwingTime (initState, lastState, limiter).GetSeconds ();
+}
+
+} // namespace
+
+/**
+ * \brief Check that the batch SwingTime agrees with the scalar one in all four
+ * bang-bang cases, for the batch sizes covering the full packs and the padded
+ * tails of both the AVX and the SSE widths
+ */
+class BangBangControllerBatchSwingTimeTestCase : public TestCase
+{
+public:
+  BangBangControllerBatchSwingTimeTestCase ();
+  virtual ~BangBangControllerBatchSwingTimeTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+BangBangControllerBatchSwingTimeTestCase::BangBangControllerBatchSwingTimeTestCase ()
+  : TestCase ("BangBangController::SwingTime of batch matches the scalar one")
+{
+}
+
+BangBangControllerBatchSwingTimeTestCase::~BangBangControllerBatchSwingTimeTestCase ()
+{
+}
+
+void
+BangBangControllerBatchSwingTimeTestCase::DoRun (void)
+{
+  std::mt19937 rng (1);
+  std::uniform_real_distribution<double> uniform (-1.0, 1.0);
+  std::uniform_real_distribution<double> positive (0.5, 2.0);
+  std::vector<uint32_t> counts (N_CASES, 0);
+  for (uint32_t trial = 0;trial < 2000;++trial)
+  {
+    // the sizes up to three packs of AVX leave every tail of both widths
+    std::size_t n = trial % 14;
+    SwingCases cases;
+    for (std::size_t k = 0;k < n;++k)
+    {
+      double vm = 0.05 * positive (rng);
+      double am = 0.01 * positive (rng);
+      // the short swings are not limited by the maximum rate, the long ones are
+      double range = (trial / 14) % 2 ? 0.05 : 2.0;
+      cases.Add (uniform (rng), vm * uniform (rng), uniform (rng) + range * uniform (rng), vm * uniform (rng), vm, am);
+    }
+    // the target is beyond the end of batch, it is never written
+    std::vector<double> t (n + 1, -1.0);
+    BangBangController::SwingTime (
+      cases.x0.data (), cases.v0.data (), cases.xf.data (), cases.vf.data (),
+      cases.vm.data (), cases.am.data (), t.data (), n);
+    for (std::size_t k = 0;k < n;++k)
+    {
+      double ref = CalcScalarSwingTime (cases, k);
+      // the scalar reference is rounded to the time resolution
+      NS_TEST_ASSERT_MSG_EQ_TOL (t[k], ref, 1e-9 + 1e-12 * std::fabs (ref), "trial " << trial << " case " << k);
+      ++counts[GetSwingCase (cases.x0[k], cases.v0[k], cases.xf[k], cases.vf[k], cases.vm[k], cases.am[k])];
+    }
+    NS_TEST_ASSERT_MSG_EQ (t[n], -1.0, "the batch of " << n << " cases writes beyond its end");
+  }
+  NS_TEST_ASSERT_MSG_GT (counts[UP_KEEPING], 1000, "too few swings keep the maximum rate");
+  NS_TEST_ASSERT_MSG_GT (counts[UP], 1000, "too few swings speed up then down");
+  NS_TEST_ASSERT_MSG_GT (counts[DOWN_KEEPING], 1000, "too few swings keep the minimum rate");
+  NS_TEST_ASSERT_MSG_GT (counts[DOWN], 1000, "too few swings speed down then up");
+}
+
+/**
+ * \brief Check the swings that only speed up or down, whose targets are
+ * exactly on the parabolas of the initial states
+ */
+class BangBangControllerFlatSwingTimeTestCase : public TestCase
+{
+public:
+  BangBangControllerFlatSwingTimeTestCase ();
+  virtual ~BangBangControllerFlatSwingTimeTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+BangBangControllerFlatSwingTimeTestCase::BangBangControllerFlatSwingTimeTestCase ()
+  : TestCase ("BangBangController::SwingTime of batch only speeding up or down")
+{
+}
+
+BangBangControllerFlatSwingTimeTestCase::~BangBangControllerFlatSwingTimeTestCase ()
+{
+}
+
+void
+BangBangControllerFlatSwingTimeTestCase::DoRun (void)
+{
+  // the values are exact in binary, so the targets are exactly reached by one acceleration
+  SwingCases cases;
+  for (uint32_t k = 0;k < 7;++k)
+  {
+    // speed up from -0.25 to 0.5 by 0.25 per second in 3 seconds
+    cases.Add (0.125 * k, -0.25, 0.125 * k + 0.375, 0.5, 1.0, 0.25);
+  }
+  for (std::size_t k = 0;k < cases.GetN ();++k)
+  {
+    NS_TEST_ASSERT_MSG_EQ (GetSwingCase (cases.x0[k], cases.v0[k], cases.xf[k], cases.vf[k], cases.vm[k], cases.am[k]), FLAT,
+                           "case " << k << " is not on the parabola");
+  }
+  std::vector<double> t (cases.GetN ());
+  BangBangController::SwingTime (
+    cases.x0.data (), cases.v0.data (), cases.xf.data (), cases.vf.data (),
+    cases.vm.data (), cases.am.data (), t.data (), cases.GetN ());
+  for (std::size_t k = 0;k < cases.GetN ();++k)
+  {
+    NS_TEST_ASSERT_MSG_EQ_TOL (t[k], CalcScalarSwingTime (cases, k), 1e-9, "case " << k);
+    NS_TEST_ASSERT_MSG_EQ_TOL (t[k], 3.0, 1e-9, "case " << k);
+  }
+}
+
+/**
+ * \brief The test suite of the bang-bang controller
+ */
+class BangBangControllerTestSuite : public TestSuite
+{
+public:
+  BangBangControllerTestSuite ();
+};
+
+BangBangControllerTestSuite::BangBangControllerTestSuite ()
+  : TestSuite ("bang-bang-controller", UNIT)
+{
+  AddTestCase (new BangBangControllerBatchSwingTimeTestCase, TestCase::QUICK);
+  AddTestCase (new BangBangControllerFlatSwingTimeTestCase, TestCase::QUICK);
+}
+
+static BangBangControllerTestSuite g_bangBangControllerTestSuite;
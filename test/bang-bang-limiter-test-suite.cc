@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <cmath>
+#include <random>
+#include "ns3/test.h"
+#include "ns3/bang-bang-controller.h"
+#include "ns3/bang-bang-limiter.h"
+
+using namespace ns3;
+
+/**
+ * \brief Check that BangBangLimiter::CanSwing agrees with comparing the swing time
+ * of BangBangController::SwingTime on random states, except for the cases whose
+ * swing time is within the rounding error of the given time
+ */
+class BangBangLimiterCanSwingTestCase : public TestCase
+{
+public:
+  BangBangLimiterCanSwingTestCase ();
+  virtual ~BangBangLimiterCanSwingTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+BangBangLimiterCanSwingTestCase::BangBangLimiterCanSwingTestCase ()
+  : TestCase ("BangBangLimiter::CanSwing matches BangBangController::SwingTime")
+{
+}
+
+BangBangLimiterCanSwingTestCase::~BangBangLimiterCanSwingTestCase ()
+{
+}
+
+void
+BangBangLimiterCanSwingTestCase::DoRun (void)
+{
+  std::mt19937 rng (3);
+  std::uniform_real_distribution<double> uniform (-1.0, 1.0);
+  std::uniform_real_distribution<double> positive (0.5, 2.0);
+  uint32_t nCompared = 0;
+  uint32_t nSwings = 0;
+  for (uint32_t trial = 0;trial < 2000000;++trial)
+  {
+    double vm = 0.2 * positive (rng);
+    double am = 0.05 * positive (rng);
+    Box bound (-3.0, 3.0, -vm, vm, -am, am);
+    BangBangLimiter limiter (bound);
+    // the short swings are not limited by the maximum rate, the long ones are
+    double range = trial % 2 ? 0.1 : 3.0;
+    double x0 = range * uniform (rng);
+    double xf = range * uniform (rng);
+    double v0 = vm * uniform (rng);
+    double vf = vm * uniform (rng);
+    Time swing = BangBangController::SwingTime (
+      BangBangController::State (Seconds (0.0), x0, v0),
+      BangBangController::State (Seconds (0.0), xf, vf),
+      bound);
+    double ref = swing.GetSeconds ();
+    // the given times are around the swing time, half of them are long enough
+    double t = ref * (1.0 + 0.5 * uniform (rng));
+    // the swing time of reference is rounded to the time resolution
+    if (std::fabs (ref - t) <= 1e-9 * (1.0 + std::fabs (ref)))
+    {
+      continue;
+    }
+    bool expected = ref <= t;
+    NS_TEST_ASSERT_MSG_EQ (limiter.CanSwing (x0, v0, xf, vf, t), expected,
+                           "trial " << trial << " swing time " << ref << " given time " << t);
+    ++nCompared;
+    nSwings += expected ? 1 : 0;
+  }
+  NS_TEST_ASSERT_MSG_GT (nCompared, 1900000, "too many cases are on the boundary");
+  NS_TEST_ASSERT_MSG_GT (nSwings, 900000, "too few cases can swing");
+  NS_TEST_ASSERT_MSG_LT (nSwings, 1100000, "too many cases can swing");
+}
+
+/**
+ * \brief The test suite of the bang-bang limiter
+ */
+class BangBangLimiterTestSuite : public TestSuite
+{
+public:
+  BangBangLimiterTestSuite ();
+};
+
+BangBangLimiterTestSuite::BangBangLimiterTestSuite ()
+  : TestSuite ("bang-bang-limiter", UNIT)
+{
+  AddTestCase (new BangBangLimiterCanSwingTestCase, TestCase::QUICK);
+}
+
+static BangBangLimiterTestSuite g_bangBangLimiterTestSuite;
@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <cmath>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/fso-channel.h"
+#include "ns3/fso-tx-device.h"
+#include "ns3/fso-rx-device.h"
+#include "ns3/turntable.h"
+#include "ns3/util.h"
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \brief A record of the link state notified to the turntables
+ */
+struct Record
+{
+  Time          time;
+  FsoLinkState  state;
+  double        distance;
+};
+
+} // namespace
+
+/**
+ * \brief Check that the channel records the same link states at the same knots
+ * with and without CoalesceUpdates, over a pass the turntables can track
+ */
+class FsoChannelCoalesceUpdatesTestCase : public TestCase
+{
+public:
+  FsoChannelCoalesceUpdatesTestCase ();
+  virtual ~FsoChannelCoalesceUpdatesTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Run the pass on a new channel
+   * \param[in] coalesce whether the updates are coalesced
+   * \param[out] nKnots  the number of knots of the link trajectory
+   * \return the records of the channel
+   */
+  std::vector<Record> RunPass (bool coalesce, std::size_t& nKnots);
+  /**
+   * \brief Trace sink of the records of channel
+   * \param[in] state    the link state
+   * \param[in] distance the distance
+   */
+  void DoRecord (FsoLinkState state, double distance);
+  std::vector<Record> m_records;
+};
+
+FsoChannelCoalesceUpdatesTestCase::FsoChannelCoalesceUpdatesTestCase ()
+  : TestCase ("FsoChannel records the same link states with CoalesceUpdates")
+{
+}
+
+FsoChannelCoalesceUpdatesTestCase::~FsoChannelCoalesceUpdatesTestCase ()
+{
+}
+
+void
+FsoChannelCoalesceUpdatesTestCase::DoRecord (FsoLinkState state, double distance)
+{
+  m_records.push_back (Record {Now (), state, distance});
+}
+
+std::vector<Record>
+FsoChannelCoalesceUpdatesTestCase::RunPass (bool coalesce, std::size_t& nKnots)
+{
+  m_records.clear ();
+  Ptr<FsoTxDevice> tx = CreateObject<FsoTxDevice> ();
+  Ptr<FsoRxDevice> rx = CreateObject<FsoRxDevice> ();
+  Ptr<FsoDevice> devices[] = {tx, rx};
+  for (Ptr<FsoDevice> device : devices)
+  {
+    // the same composition as QkdFsoDeviceHelper::Install
+    Ptr<Turntable> turntable = CreateObject<Turntable> ();
+    device->SetTurntable (turntable);
+    device->SetNode (CreateObject<Node> ());
+    device->AggregateObject (turntable);
+    device->AggregateObject (CreateObject<SimpleNetDevice> ());
+  }
+  // a slow pass of ten minutes, the pointings drift at constant rates
+  adi::LinkDatas datas;
+  for (uint32_t i = 0;i < 600;++i)
+  {
+    double t = i;
+    adi::LinkData data;
+    data.state = 0;
+    data.time = ToTime (Seconds (10.0 + t));
+    data.fromSrc.angle.azimuth = 1.0 + 2e-3 * t;
+    data.fromSrc.angle.pitch = 0.8 + 1e-4 * t;
+    data.fromSrc.rate.azimuth = 2e-3;
+    data.fromSrc.rate.pitch = 1e-4;
+    data.fromDst.angle.azimuth = 4.0 - 1e-3 * t;
+    data.fromDst.angle.pitch = 0.6 + 2e-4 * t;
+    data.fromDst.rate.azimuth = -1e-3;
+    data.fromDst.rate.pitch = 2e-4;
+    data.distance = 1000.0 + 0.2 * t;
+    datas.push_back (data);
+  }
+  Ptr<FsoChannel> channel = CreateObject<FsoChannel> ();
+  channel->SetAttribute ("CoalesceUpdates", BooleanValue (coalesce));
+  channel->TraceConnectWithoutContext ("Record", MakeCallback (&FsoChannelCoalesceUpdatesTestCase::DoRecord, this));
+  Simulator::Schedule (Seconds (9.0), &FsoChannel::Attach, channel, tx, rx, datas);
+  Simulator::Stop (Seconds (700.0));
+  Simulator::Run ();
+  nKnots = channel->GetLinkTrajectory ().GetNKnots ();
+  Simulator::Destroy ();
+  return m_records;
+}
+
+void
+FsoChannelCoalesceUpdatesTestCase::DoRun (void)
+{
+  std::size_t nKnots = 0;
+  std::vector<Record> updates = RunPass (false, nKnots);
+  NS_TEST_ASSERT_MSG_EQ (updates.size (), nKnots, "a record per knot is expected");
+  std::vector<Record> coalesced = RunPass (true, nKnots);
+  NS_TEST_ASSERT_MSG_EQ (coalesced.size (), updates.size (), "the kept knots are not recorded");
+  bool linked = false;
+  for (std::size_t k = 0;k < updates.size () && k < coalesced.size ();++k)
+  {
+    NS_TEST_ASSERT_MSG_EQ (coalesced[k].time, updates[k].time, "knot " << k);
+    NS_TEST_ASSERT_MSG_EQ (coalesced[k].state, updates[k].state, "knot " << k);
+    NS_TEST_ASSERT_MSG_EQ_TOL (coalesced[k].distance, updates[k].distance, 1e-9, "knot " << k);
+    linked = linked || updates[k].state == CONNECTING || updates[k].state == CONNECTED;
+  }
+  NS_TEST_ASSERT_MSG_EQ (linked, true, "the turntables never track the pass");
+  NS_TEST_ASSERT_MSG_EQ (updates.back ().state, CONNECTION_DONE, "the connection is not finished");
+}
+
+/**
+ * \brief The test suite of FsoChannel
+ */
+class FsoChannelTestSuite : public TestSuite
+{
+public:
+  FsoChannelTestSuite ();
+};
+
+FsoChannelTestSuite::FsoChannelTestSuite ()
+  : TestSuite ("fso-channel", UNIT)
+{
+  AddTestCase (new FsoChannelCoalesceUpdatesTestCase, TestCase::QUICK);
+}
+
+static FsoChannelTestSuite g_fsoChannelTestSuite;
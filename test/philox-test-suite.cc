@@ -0,0 +1,246 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Innovation Academy for Microsatellites of CAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Wang Junyong (wangjunyong@microsate.com)
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/enum.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/philox.h"
+#include "ns3/fso-channel.h"
+#include "ns3/fso-tx-device.h"
+#include "ns3/fso-rx-device.h"
+#include "ns3/fso-atmosphere-model.h"
+#include "ns3/fso-propagation-loss-model.h"
+#include "ns3/turntable.h"
+#include "ns3/util.h"
+
+using namespace ns3;
+
+/**
+ * \brief Check Philox4x32 against the known-answer vectors of Random123
+ * for philox4x32-10, and the batched uniforms against the single blocks
+ */
+class PhiloxKnownAnswerTestCase : public TestCase
+{
+public:
+  PhiloxKnownAnswerTestCase ();
+  virtual ~PhiloxKnownAnswerTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+PhiloxKnownAnswerTestCase::PhiloxKnownAnswerTestCase ()
+  : TestCase ("Philox4x32 matches the known-answer vectors of philox4x32-10")
+{
+}
+
+PhiloxKnownAnswerTestCase::~PhiloxKnownAnswerTestCase ()
+{
+}
+
+void
+PhiloxKnownAnswerTestCase::DoRun (void)
+{
+  struct Vector
+  {
+    Philox4x32::Counter counter;
+    Philox4x32::Key     key;
+    Philox4x32::Counter expected;
+  };
+  const Vector vectors[] = {
+    {{0x00000000, 0x00000000, 0x00000000, 0x00000000},
+     {0x00000000, 0x00000000},
+     {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}},
+    {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+     {0xffffffff, 0xffffffff},
+     {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}},
+    {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+     {0xa4093822, 0x299f31d0},
+     {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}},
+  };
+  for (const Vector& v : vectors)
+  {
+    Philox4x32::Counter block = Philox4x32::Generate (v.counter, v.key);
+    for (uint32_t w = 0;w < 4;++w)
+    {
+      NS_TEST_ASSERT_MSG_EQ (block[w], v.expected[w], "word " << w << " of counter " << v.counter[0]);
+    }
+  }
+  // the lower 64 bits of counters cross a carry into the second word
+  const std::size_t n = 7;
+  Philox4x32::Key key = {0x01234567, 0x89abcdef};
+  Philox4x32::Counter base = {0, 0, 11, 13};
+  uint64_t first = 0xfffffffcULL;
+  std::vector<double> u0 (n), u1 (n), u2 (n), u3 (n);
+  double* u[4] = {u0.data (), u1.data (), u2.data (), u3.data ()};
+  Philox4x32::Uniform (key, base, first, n, u);
+  for (std::size_t i = 0;i < n;++i)
+  {
+    uint64_t index = first + i;
+    Philox4x32::Counter counter = {(uint32_t) index, (uint32_t) (index >> 32), base[2], base[3]};
+    Philox4x32::Counter block = Philox4x32::Generate (counter, key);
+    for (uint32_t w = 0;w < 4;++w)
+    {
+      double x = u[w][i];
+      NS_TEST_ASSERT_MSG_EQ (x, Philox4x32::ToUniform (block[w]), "word " << w << " of block " << i);
+      NS_TEST_ASSERT_MSG_GT (x, 0.0, "the uniform is not in (0, 1)");
+      NS_TEST_ASSERT_MSG_LT (x, 1.0, "the uniform is not in (0, 1)");
+    }
+  }
+}
+
+/**
+ * \brief Check that the stochastic channel loss of a period only depends on
+ * the stream, the seed and the run, not on the order of calls
+ */
+class FsoPropagationLossCallOrderTestCase : public TestCase
+{
+public:
+  FsoPropagationLossCallOrderTestCase ();
+  virtual ~FsoPropagationLossCallOrderTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Calculate the losses of the periods in the given order on a fresh loss model
+   * \param[in] order the indices of periods
+   * \return the losses indexed by period
+   */
+  std::vector<double> CalcLosses (const std::vector<uint32_t>& order);
+  /**
+   * \brief Calculate the losses of all orders at the current pointings
+   */
+  void DoCalc (void);
+  Ptr<FsoChannel> m_channel;
+  std::vector<std::vector<double>> m_losses;  //!< the losses of each order
+  double m_deterministic;                     //!< the loss without fading
+};
+
+FsoPropagationLossCallOrderTestCase::FsoPropagationLossCallOrderTestCase ()
+  : TestCase ("FsoPropagationLossModel samples the fading regardless of the call order")
+{
+}
+
+FsoPropagationLossCallOrderTestCase::~FsoPropagationLossCallOrderTestCase ()
+{
+}
+
+std::vector<double>
+FsoPropagationLossCallOrderTestCase::CalcLosses (const std::vector<uint32_t>& order)
+{
+  Ptr<FsoPropagationLossModel> loss = CreateObject<FsoPropagationLossModel> (m_channel);
+  loss->SetAttribute ("Fading", EnumValue (FsoPropagationLossModel::GAMMA_GAMMA));
+  loss->AssignStreams (7);
+  std::vector<double> losses (order.size (), 0.0);
+  for (uint32_t k : order)
+  {
+    Time start = Seconds (100.0 + 3.0 * k);
+    losses[k] = loss->CalcChannelLoss (1200.0, start, start + Seconds (1.0));
+  }
+  loss->Dispose ();
+  return losses;
+}
+
+void
+FsoPropagationLossCallOrderTestCase::DoCalc (void)
+{
+  m_losses.push_back (CalcLosses ({0, 1, 2, 3, 4, 5}));
+  m_losses.push_back (CalcLosses ({5, 4, 3, 2, 1, 0}));
+  m_losses.push_back (CalcLosses ({3, 0, 5, 1, 4, 2}));
+  Ptr<FsoPropagationLossModel> loss = CreateObject<FsoPropagationLossModel> (m_channel);
+  m_deterministic = loss->CalcChannelLoss (1200.0, Seconds (100.0), Seconds (101.0));
+  loss->Dispose ();
+}
+
+void
+FsoPropagationLossCallOrderTestCase::DoRun (void)
+{
+  RngSeedManager::SetSeed (3);
+  RngSeedManager::SetRun (5);
+  Ptr<FsoTxDevice> tx = CreateObject<FsoTxDevice> ();
+  Ptr<FsoRxDevice> rx = CreateObject<FsoRxDevice> ();
+  Ptr<FsoDevice> devices[] = {tx, rx};
+  for (Ptr<FsoDevice> device : devices)
+  {
+    // the same composition as QkdFsoDeviceHelper::Install
+    Ptr<Turntable> turntable = CreateObject<Turntable> ();
+    device->SetTurntable (turntable);
+    device->SetNode (CreateObject<Node> ());
+    device->AggregateObject (turntable);
+    device->AggregateObject (CreateObject<SimpleNetDevice> ());
+  }
+  // the atmosphere of the ground party gives the scintillation
+  rx->SetAtmosphere (CreateObject<FsoAtmosphereModel> ());
+  adi::LinkDatas datas;
+  for (uint32_t i = 0;i < 60;++i)
+  {
+    adi::LinkData data;
+    data.state = 0;
+    data.time = ToTime (Seconds (10.0 + i));
+    data.fromSrc.angle.azimuth = 1.0;
+    data.fromSrc.angle.pitch = -0.5;
+    data.fromSrc.rate.azimuth = 0.0;
+    data.fromSrc.rate.pitch = 0.0;
+    data.fromDst.angle.azimuth = 4.0;
+    data.fromDst.angle.pitch = 0.8;
+    data.fromDst.rate.azimuth = 0.0;
+    data.fromDst.rate.pitch = 0.0;
+    data.distance = 1200.0;
+    datas.push_back (data);
+  }
+  m_channel = CreateObject<FsoChannel> ();
+  Simulator::Schedule (Seconds (9.0), &FsoChannel::Attach, m_channel, tx, rx, datas);
+  Simulator::Schedule (Seconds (30.0), &FsoPropagationLossCallOrderTestCase::DoCalc, this);
+  Simulator::Stop (Seconds (80.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_channel = 0;
+  NS_TEST_ASSERT_MSG_EQ (m_losses.size (), 3, "the losses are not calculated");
+  for (uint32_t k = 0;k < m_losses[0].size ();++k)
+  {
+    NS_TEST_ASSERT_MSG_GT (m_losses[0][k], 0.0, "period " << k);
+    NS_TEST_ASSERT_MSG_NE (m_losses[0][k], m_deterministic, "the fading is not sampled in period " << k);
+    for (uint32_t j = 1;j < m_losses.size ();++j)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_losses[j][k], m_losses[0][k], "period " << k << " of order " << j);
+    }
+  }
+  NS_TEST_ASSERT_MSG_NE (m_losses[0][0], m_losses[0][1], "the periods draw the same samples");
+}
+
+/**
+ * \brief The test suite of the counter-based random numbers
+ */
+class PhiloxTestSuite : public TestSuite
+{
+public:
+  PhiloxTestSuite ();
+};
+
+PhiloxTestSuite::PhiloxTestSuite ()
+  : TestSuite ("philox", UNIT)
+{
+  AddTestCase (new PhiloxKnownAnswerTestCase, TestCase::QUICK);
+  AddTestCase (new FsoPropagationLossCallOrderTestCase, TestCase::QUICK);
+}
+
+static PhiloxTestSuite g_philoxTestSuite;